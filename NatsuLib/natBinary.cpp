@@ -1,8 +1,208 @@
 #include "stdafx.h"
 #include "natBinary.h"
+#include <cstring>
+#include <cstdlib>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#	define NATBINARY_X86 1
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#	else
+#		include <cpuid.h>
+#	endif
+#	include <tmmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#	define NATBINARY_TARGET_SSSE3
+#else
+#	define NATBINARY_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
 
 using namespace NatsuLib;
 
+namespace
+{
+	nuShort ByteSwap(nuShort value) noexcept
+	{
+#ifdef _MSC_VER
+		return _byteswap_ushort(value);
+#else
+		return __builtin_bswap16(value);
+#endif
+	}
+
+	nuInt ByteSwap(nuInt value) noexcept
+	{
+#ifdef _MSC_VER
+		return _byteswap_ulong(value);
+#else
+		return __builtin_bswap32(value);
+#endif
+	}
+
+	nuLong ByteSwap(nuLong value) noexcept
+	{
+#ifdef _MSC_VER
+		return _byteswap_uint64(value);
+#else
+		return __builtin_bswap64(value);
+#endif
+	}
+
+	// ݲһ룬memcpyд
+	template <typename T>
+	void ScalarSwapEndianArray(nData data, size_t count) noexcept
+	{
+		for (size_t i = 0; i < count; ++i, data += sizeof(T))
+		{
+			T value;
+			std::memcpy(&value, data, sizeof(T));
+			value = ByteSwap(value);
+			std::memcpy(data, &value, sizeof(T));
+		}
+	}
+
+#ifdef NATBINARY_X86
+	nBool CpuSupportsSsse3() noexcept
+	{
+#ifdef _MSC_VER
+		int cpuInfo[4];
+		__cpuid(cpuInfo, 1);
+		return (cpuInfo[2] & (1 << 9)) != 0;
+#else
+		unsigned eax, ebx, ecx, edx;
+		return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSSE3) != 0;
+#endif
+	}
+
+	const nBool g_CpuSupportsSsse3 = CpuSupportsSsse3();
+
+	// ÿpshufb16ֽڣʣಿֽɱ汾
+	template <typename T>
+	NATBINARY_TARGET_SSSE3 void Ssse3SwapEndianArray(nData data, size_t count) noexcept
+	{
+		constexpr size_t ElementsPerBlock = 16 / sizeof(T);
+		alignas(16) nByte shuffleMask[16];
+		for (size_t i = 0; i < 16; ++i)
+		{
+			shuffleMask[i] = static_cast<nByte>(i - i % sizeof(T) + sizeof(T) - 1 - i % sizeof(T));
+		}
+
+		const auto mask = _mm_load_si128(reinterpret_cast<const __m128i*>(shuffleMask));
+		const auto blockCount = count / ElementsPerBlock;
+		for (size_t i = 0; i < blockCount; ++i, data += 16)
+		{
+			const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(data), _mm_shuffle_epi8(block, mask));
+		}
+
+		ScalarSwapEndianArray<T>(data, count % ElementsPerBlock);
+	}
+#endif
+
+	size_t CountTrailingZeros(nuLong value) noexcept
+	{
+		assert(value);
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return index;
+#elif defined(_MSC_VER)
+		size_t count = 0;
+		while (!(value & 1))
+		{
+			value >>= 1;
+			++count;
+		}
+		return count;
+#else
+		return static_cast<size_t>(__builtin_ctzll(value));
+#endif
+	}
+
+	template <typename T>
+	void SwapEndianArrayImpl(nData data, size_t count) noexcept
+	{
+#ifdef NATBINARY_X86
+		if (g_CpuSupportsSsse3)
+		{
+			Ssse3SwapEndianArray<T>(data, count);
+			return;
+		}
+#endif
+		ScalarSwapEndianArray<T>(data, count);
+	}
+}
+
+void detail_::SwapEndianArray(nData data, size_t elementSize, size_t count) noexcept
+{
+	switch (elementSize)
+	{
+	case 0:
+	case 1:
+		break;
+	case 2:
+		SwapEndianArrayImpl<nuShort>(data, count);
+		break;
+	case 4:
+		SwapEndianArrayImpl<nuInt>(data, count);
+		break;
+	case 8:
+		SwapEndianArrayImpl<nuLong>(data, count);
+		break;
+	default:
+		for (size_t i = 0; i < count; ++i, data += elementSize)
+		{
+			SwapEndian(data, elementSize);
+		}
+		break;
+	}
+}
+
+nBool detail_::DecodeVarint(ncData& cur, ncData end, nuLong& value) noexcept
+{
+	const auto available = static_cast<size_t>(end - cur);
+
+	// ·һ8ֽڣɸֽڵλȷȺ󽫸ֽڵĵ7λƴӣҪֽж
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	if (available >= sizeof(nuLong))
+	{
+		nuLong word;
+		std::memcpy(&word, cur, sizeof word);
+		const auto stopBits = ~word & 0x8080808080808080ull;
+		if (stopBits)
+		{
+			const auto length = CountTrailingZeros(stopBits) / 8 + 1;
+			word &= (~0ull >> (64 - 8 * length)) & 0x7F7F7F7F7F7F7F7Full;
+			word = ((word & 0x7F007F007F007F00ull) >> 1) | (word & 0x007F007F007F007Full);
+			word = ((word & 0x3FFF00003FFF0000ull) >> 2) | (word & 0x00003FFF00003FFFull);
+			word = ((word & 0x0FFFFFFF00000000ull) >> 4) | (word & 0x000000000FFFFFFFull);
+			value = word;
+			cur += length;
+			return true;
+		}
+	}
+#endif
+
+	// ·ʣݲ8ֽڻ볤ȳ8ֽ
+	nuLong result{};
+	const auto maxLength = std::min(available, MaxVarintSize);
+	for (size_t i = 0; i < maxLength; ++i)
+	{
+		const auto byte = cur[i];
+		result |= static_cast<nuLong>(byte & 0x7F) << (7 * i);
+		if (!(byte & 0x80))
+		{
+			value = result;
+			cur += i + 1;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 natBinaryReader::natBinaryReader(natRefPointer<natStream> stream, Environment::Endianness endianness) noexcept
 	: m_Stream{ std::move(stream) }, m_Endianness{ endianness }, m_NeedSwapEndian{ endianness != Environment::GetEndianness() }
 {
@@ -45,6 +245,127 @@ void natBinaryReader::Skip(nLen bytes)
 	}
 }
 
+nString natBinaryReader::ReadString(nLen maxLength)
+{
+	const auto length = readLengthPrefix(maxLength);
+	nString ret;
+	if (length)
+	{
+		ret.Resize(static_cast<size_t>(length));
+		ReadPodArray(reinterpret_cast<nData>(ret.data()), static_cast<size_t>(length));
+	}
+	return ret;
+}
+
+std::vector<nByte> natBinaryReader::ReadBlob(nLen maxLength)
+{
+	const auto length = readLengthPrefix(maxLength);
+	std::vector<nByte> ret(static_cast<size_t>(length));
+	ReadPodArray(ret.data(), ret.size());
+	return ret;
+}
+
+nuLong natBinaryReader::readRawVarint()
+{
+	if (m_Stream->CanSeek())
+	{
+		// ѰַʱһζȡMaxVarintSizeֽڽн룬ٻδʹõĲ
+		nByte buffer[detail_::MaxVarintSize];
+		const auto readBytes = static_cast<size_t>(m_Stream->ReadBytes(buffer, sizeof buffer));
+		ncData cur = buffer;
+		nuLong value;
+		if (!detail_::DecodeVarint(cur, buffer + readBytes, value))
+		{
+			if (readBytes < sizeof buffer)
+			{
+				nat_Throw(natException, "Stream ended while reading a varint."_nv);
+			}
+			nat_Throw(InvalidData, "Varint is too long."_nv);
+		}
+
+		const auto unusedBytes = readBytes - static_cast<size_t>(cur - buffer);
+		if (unusedBytes)
+		{
+			m_Stream->SetPosition(NatSeek::Cur, -static_cast<nLong>(unusedBytes));
+		}
+		return value;
+	}
+
+	// Ѱַʱ޷ˣֻֽڶȡȡ
+	auto byte = ReadPod<nByte>();
+	if (!(byte & 0x80))
+	{
+		return byte;
+	}
+
+	nuLong value = byte & 0x7F;
+	for (size_t i = 1; i < detail_::MaxVarintSize; ++i)
+	{
+		byte = ReadPod<nByte>();
+		value |= static_cast<nuLong>(byte & 0x7F) << (7 * i);
+		if (!(byte & 0x80))
+		{
+			return value;
+		}
+	}
+
+	nat_Throw(InvalidData, "Varint is too long."_nv);
+}
+
+void natBinaryReader::readRawVarintArray(nuLong* values, size_t count)
+{
+	nByte buffer[VarintBufferSize];
+	size_t bufferedBytes = 0;
+	const auto canSeek = m_Stream->CanSeek();
+
+	while (count)
+	{
+		// ѰַʱϺδʹõĲ
+		// ʣcountռcountֽڣȡݿԱ֤ȡһ
+		const auto bytesToRead = canSeek ? sizeof buffer - bufferedBytes : std::min(sizeof buffer - bufferedBytes, count);
+		const auto readBytes = static_cast<size_t>(m_Stream->ReadBytes(buffer + bufferedBytes, bytesToRead));
+		if (!readBytes)
+		{
+			nat_Throw(natException, "Stream ended while {0} varint(s) remain unread."_nv, count);
+		}
+		bufferedBytes += readBytes;
+
+		ncData cur = buffer;
+		const ncData end = buffer + bufferedBytes;
+		while (count && detail_::DecodeVarint(cur, end, *values))
+		{
+			++values;
+			--count;
+		}
+
+		bufferedBytes = static_cast<size_t>(end - cur);
+		if (!count)
+		{
+			if (bufferedBytes)
+			{
+				assert(canSeek);
+				m_Stream->SetPosition(NatSeek::Cur, -static_cast<nLong>(bufferedBytes));
+			}
+			break;
+		}
+		if (bufferedBytes >= detail_::MaxVarintSize)
+		{
+			nat_Throw(InvalidData, "Varint is too long."_nv);
+		}
+		std::memmove(buffer, cur, bufferedBytes);
+	}
+}
+
+nLen natBinaryReader::readLengthPrefix(nLen maxLength)
+{
+	const auto length = readRawVarint();
+	if (length > maxLength || length > std::numeric_limits<size_t>::max())
+	{
+		nat_Throw(InvalidData, "Length prefix ({0}) exceeds the limit ({1})."_nv, length, maxLength);
+	}
+	return length;
+}
+
 natBinaryWriter::natBinaryWriter(natRefPointer<natStream> stream, Environment::Endianness endianness) noexcept
 	: m_Stream{ std::move(stream) }, m_Endianness{ endianness }, m_NeedSwapEndian{ endianness != Environment::GetEndianness() }
 {
@@ -63,3 +384,78 @@ Environment::Endianness natBinaryWriter::GetEndianness() const noexcept
 {
 	return m_Endianness;
 }
+
+void natBinaryWriter::writePodArray(ncData data, size_t elementSize, size_t count)
+{
+	if (!count)
+	{
+		return;
+	}
+
+	const auto totalBytes = static_cast<nLen>(elementSize) * count;
+	if (!m_NeedSwapEndian || elementSize == 1)
+	{
+		nLen writtenBytes;
+		if ((writtenBytes = m_Stream->WriteBytes(data, totalBytes)) < totalBytes)
+		{
+			nat_Throw(natException, "Only partial data ({0} bytes/{1} bytes requested) has been successfully written."_nv, writtenBytes, totalBytes);
+		}
+		return;
+	}
+
+	// Ҫתֽʱֿ鸴Ƶתд룬޸ԭݼһԷĻ
+	const auto elementsPerChunk = std::max(SwapBufferSize / elementSize, size_t{ 1 });
+	std::vector<nByte> buffer(std::min(elementsPerChunk, count) * elementSize);
+	nLen totalWrittenBytes{};
+	while (count)
+	{
+		const auto currentCount = std::min(elementsPerChunk, count);
+		const auto currentBytes = currentCount * elementSize;
+		std::memcpy(buffer.data(), data, currentBytes);
+		detail_::SwapEndianArray(buffer.data(), elementSize, currentCount);
+
+		const auto writtenBytes = m_Stream->WriteBytes(buffer.data(), currentBytes);
+		totalWrittenBytes += writtenBytes;
+		if (writtenBytes < currentBytes)
+		{
+			nat_Throw(natException, "Only partial data ({0} bytes/{1} bytes requested) has been successfully written."_nv, totalWrittenBytes, totalBytes);
+		}
+
+		data += currentBytes;
+		count -= currentCount;
+	}
+}
+
+void natBinaryWriter::WriteString(nStrView const& str)
+{
+	WriteBlob(reinterpret_cast<ncData>(str.data()), str.size());
+}
+
+void natBinaryWriter::WriteBlob(ncData data, nLen length)
+{
+	writeRawVarint(length);
+	writePodArray(data, 1, static_cast<size_t>(length));
+}
+
+void natBinaryWriter::writeRawVarint(nuLong value)
+{
+	nByte buffer[detail_::MaxVarintSize];
+	writePodArray(buffer, 1, detail_::EncodeVarint(value, buffer));
+}
+
+void natBinaryWriter::writeRawVarintArray(const nuLong* values, size_t count)
+{
+	nByte buffer[VarintChunkSize * detail_::MaxVarintSize];
+	while (count)
+	{
+		const auto currentCount = std::min(count, size_t{ VarintChunkSize });
+		size_t encodedBytes = 0;
+		for (size_t i = 0; i < currentCount; ++i)
+		{
+			encodedBytes += detail_::EncodeVarint(values[i], buffer + encodedBytes);
+		}
+		writePodArray(buffer, 1, encodedBytes);
+		values += currentCount;
+		count -= currentCount;
+	}
+}
@@ -7,6 +7,9 @@
 #include "natConfig.h"
 #include "natStream.h"
 #include "natEnvironment.h"
+#include <cstring>
+#include <tuple>
+#include <vector>
 
 namespace NatsuLib
 {
@@ -22,6 +25,100 @@ namespace NatsuLib
 				swap(data[i], data[maxI - i]);
 			}
 		}
+
+		///	@brief	countСΪelementSizeԪطֱתֽ
+		///	@note	ԪشСΪ248ʱֵ֧ƽ̨ʹSIMDָת
+		void SwapEndianArray(nData data, size_t elementSize, size_t count) noexcept;
+
+		constexpr size_t MaxVarintSize = 10;
+
+		constexpr nuLong ZigZagEncode(nLong value) noexcept
+		{
+			return (static_cast<nuLong>(value) << 1) ^ static_cast<nuLong>(value >> 63);
+		}
+
+		constexpr nLong ZigZagDecode(nuLong value) noexcept
+		{
+			return static_cast<nLong>(value >> 1) ^ -static_cast<nLong>(value & 1);
+		}
+
+		///	@brief	LEB128valueдֽ
+		///	@note	outӦMaxVarintSizeֽ
+		inline size_t EncodeVarint(nuLong value, nData out) noexcept
+		{
+			size_t i = 0;
+			while (value >= 0x80)
+			{
+				out[i++] = static_cast<nByte>(value | 0x80);
+				value >>= 7;
+			}
+			out[i++] = static_cast<nByte>(value);
+			return i;
+		}
+
+		///	@brief	[cur, end)һLEB128
+		///	@note	ɹʱcurƶѽ֮ݲʱfalseҲ޸cur
+		nBool DecodeVarint(ncData& cur, ncData end, nuLong& value) noexcept;
+
+		template <typename T, typename = void>
+		struct VarintTraits
+		{
+			using UnderlyingType = T;
+		};
+
+		template <typename T>
+		struct VarintTraits<T, std::enable_if_t<std::is_enum<T>::value>>
+		{
+			using UnderlyingType = std::underlying_type_t<T>;
+		};
+
+		template <typename T>
+		using VarintUnderlyingType = typename VarintTraits<T>::UnderlyingType;
+
+		template <typename T>
+		struct IsVarintType
+			: std::integral_constant<nBool, std::is_integral<VarintUnderlyingType<T>>::value && !std::is_same<VarintUnderlyingType<T>, nBool>::value>
+		{
+		};
+
+		template <typename T>
+		T FromRawVarint(nuLong value, std::true_type)
+		{
+			using Underlying = VarintUnderlyingType<T>;
+			const auto decoded = ZigZagDecode(value);
+			if (decoded < static_cast<nLong>(std::numeric_limits<Underlying>::min()) || decoded > static_cast<nLong>(std::numeric_limits<Underlying>::max()))
+			{
+				nat_Throw(InvalidData, "Varint is out of range of the target type."_nv);
+			}
+			return static_cast<T>(static_cast<Underlying>(decoded));
+		}
+
+		template <typename T>
+		T FromRawVarint(nuLong value, std::false_type)
+		{
+			using Underlying = VarintUnderlyingType<T>;
+			if (value > static_cast<nuLong>(std::numeric_limits<Underlying>::max()))
+			{
+				nat_Throw(InvalidData, "Varint is out of range of the target type."_nv);
+			}
+			return static_cast<T>(static_cast<Underlying>(value));
+		}
+
+		///	@brief	ԭʼı䳤תΪTзͽzigzag
+		template <typename T>
+		T FromRawVarint(nuLong value)
+		{
+			return FromRawVarint<T>(value, std::is_signed<VarintUnderlyingType<T>>{});
+		}
+
+		///	@brief	TתΪԭʼı䳤зͽzigzag
+		template <typename T>
+		constexpr nuLong ToRawVarint(T value) noexcept
+		{
+			return std::is_signed<VarintUnderlyingType<T>>::value ?
+				ZigZagEncode(static_cast<nLong>(static_cast<VarintUnderlyingType<T>>(value))) :
+				static_cast<nuLong>(static_cast<VarintUnderlyingType<T>>(value));
+		}
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
@@ -69,10 +166,96 @@ namespace NatsuLib
 			}
 		}
 
+		///	@brief		ȡΪcountPODT
+		///	@note		һζȡҪתֽݽת
+		///	@warning	ڶԱĽṹ
+		template <typename T>
+		std::enable_if_t<std::is_pod<T>::value> ReadPodArray(T* arr, size_t count)
+		{
+			if (!count)
+			{
+				return;
+			}
+
+			const auto totalBytes = static_cast<nLen>(sizeof(T)) * count;
+			nLen readBytes;
+			if ((readBytes = m_Stream->ReadBytes(reinterpret_cast<nData>(arr), totalBytes)) < totalBytes)
+			{
+				nat_Throw(natException, "Only partial data ({0} bytes/{1} bytes requested) has been successfully read."_nv, readBytes, totalBytes);
+			}
+
+			if (m_NeedSwapEndian)
+			{
+				detail_::SwapEndianArray(reinterpret_cast<nData>(arr), sizeof(T), count);
+			}
+		}
+
+		///	@brief		ȡΪPODT
+		///	@warning	ڶԱĽṹ
+		template <typename T, size_t N>
+		std::enable_if_t<std::is_pod<T>::value> ReadPodArray(T(&arr)[N])
+		{
+			ReadPodArray(arr, N);
+		}
+
+		///	@brief		ȡһLEB128
+		///	@note		зͽzigzag룬TķΧʱ׳InvalidData
+		template <typename T = nuLong>
+		std::enable_if_t<detail_::IsVarintType<T>::value, T> ReadVarint()
+		{
+			return detail_::FromRawVarint<T>(readRawVarint());
+		}
+
+		///	@brief		ȡcountLEB128
+		///	@note		ԿΪλȡڻϽ룬ȡһ
+		template <typename T>
+		std::enable_if_t<detail_::IsVarintType<T>::value> ReadVarintArray(T* arr, size_t count)
+		{
+			nuLong rawValues[VarintChunkSize];
+			while (count)
+			{
+				const auto currentCount = std::min(count, size_t{ VarintChunkSize });
+				readRawVarintArray(rawValues, currentCount);
+				for (size_t i = 0; i < currentCount; ++i)
+				{
+					arr[i] = detail_::FromRawVarint<T>(rawValues[i]);
+				}
+				arr += currentCount;
+				count -= currentCount;
+			}
+		}
+
+		///	@brief		ȡԱ䳤Ϊǰ׺ַ
+		///	@param[in]	maxLength	ֽʱ׳InvalidData
+		nString ReadString(nLen maxLength = std::numeric_limits<nLen>::max());
+
+		///	@brief		ȡԱ䳤Ϊǰ׺Ķ
+		///	@param[in]	maxLength	ֽʱ׳InvalidData
+		std::vector<nByte> ReadBlob(nLen maxLength = std::numeric_limits<nLen>::max());
+
+		///	@brief		սṹȡobj
+		///	@see		natBinarySchema
+		///	@return		еĳֶȡݲʱfalse
+		template <typename Schema, typename Class>
+		nBool ReadSchema(Schema const& schema, Class& obj)
+		{
+			return schema.Read(*this, obj);
+		}
+
 	private:
+		enum : size_t
+		{
+			VarintChunkSize = 256,
+			VarintBufferSize = 4096,
+		};
+
 		natRefPointer<natStream> m_Stream;
 		const Environment::Endianness m_Endianness;
 		const nBool m_NeedSwapEndian;
+
+		nuLong readRawVarint();
+		void readRawVarintArray(nuLong* values, size_t count);
+		nLen readLengthPrefix(nLen maxLength);
 	};
 
 	////////////////////////////////////////////////////////////////////////////////
@@ -114,9 +297,425 @@ namespace NatsuLib
 			}
 		}
 
+		///	@brief		countPOD͵ʵд
+		///	@note		תֽʱһд룬Էֿ鷽ʽתд
+		///	@warning	ڶԱĽṹ
+		template <typename T>
+		std::enable_if_t<std::is_pod<T>::value> WritePodArray(const T* arr, size_t count)
+		{
+			writePodArray(reinterpret_cast<ncData>(arr), sizeof(T), count);
+		}
+
+		///	@brief		POD͵д
+		///	@warning	ڶԱĽṹ
+		template <typename T, size_t N>
+		std::enable_if_t<std::is_pod<T>::value> WritePodArray(const T(&arr)[N])
+		{
+			WritePodArray(arr, N);
+		}
+
+		///	@brief		LEB128дһ
+		///	@note		зͽȽzigzag
+		template <typename T>
+		std::enable_if_t<detail_::IsVarintType<T>::value> WriteVarint(T value)
+		{
+			writeRawVarint(detail_::ToRawVarint(value));
+		}
+
+		///	@brief		LEB128дcount
+		///	@note		뵽ֿд
+		template <typename T>
+		std::enable_if_t<detail_::IsVarintType<T>::value> WriteVarintArray(const T* arr, size_t count)
+		{
+			nuLong rawValues[VarintChunkSize];
+			while (count)
+			{
+				const auto currentCount = std::min(count, size_t{ VarintChunkSize });
+				for (size_t i = 0; i < currentCount; ++i)
+				{
+					rawValues[i] = detail_::ToRawVarint(arr[i]);
+				}
+				writeRawVarintArray(rawValues, currentCount);
+				arr += currentCount;
+				count -= currentCount;
+			}
+		}
+
+		///	@brief		дԱ䳤Ϊǰ׺ַ
+		void WriteString(nStrView const& str);
+
+		///	@brief		дԱ䳤Ϊǰ׺Ķ
+		void WriteBlob(ncData data, nLen length);
+
+		///	@brief		սṹobjд
+		///	@see		natBinarySchema
+		template <typename Schema, typename Class>
+		void WriteSchema(Schema const& schema, Class const& obj)
+		{
+			schema.Write(*this, obj);
+		}
+
 	private:
+		enum : size_t
+		{
+			SwapBufferSize = 4096,
+			VarintChunkSize = 256,
+		};
+
 		natRefPointer<natStream> m_Stream;
 		const Environment::Endianness m_Endianness;
 		const nBool m_NeedSwapEndian;
+
+		void writePodArray(ncData data, size_t elementSize, size_t count);
+		void writeRawVarint(nuLong value);
+		void writeRawVarintArray(const nuLong* values, size_t count);
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	ֶεֽ
+	///	@note	Defaultʾʹöȡ/дֽ
+	////////////////////////////////////////////////////////////////////////////////
+	enum class FieldEndianness
+	{
+		Default,
+		LittleEndian,
+		BigEndian,
 	};
+
+	namespace detail_
+	{
+		struct FieldContext
+		{
+			Environment::Endianness StreamEndianness;
+			Environment::Endianness NativeEndianness;
+
+			nBool NeedSwap(FieldEndianness fieldEndianness) const noexcept
+			{
+				switch (fieldEndianness)
+				{
+				case FieldEndianness::LittleEndian:
+					return NativeEndianness != Environment::Endianness::LittleEndian;
+				case FieldEndianness::BigEndian:
+					return NativeEndianness != Environment::Endianness::BigEndian;
+				case FieldEndianness::Default:
+				default:
+					return StreamEndianness != NativeEndianness;
+				}
+			}
+		};
+
+		template <typename WireType>
+		WireType LoadWireValue(ncData data, nBool needSwap) noexcept
+		{
+			WireType value;
+			std::memcpy(&value, data, sizeof(WireType));
+			if (needSwap)
+			{
+				SwapEndian(reinterpret_cast<nData>(&value), sizeof(WireType));
+			}
+			return value;
+		}
+
+		template <typename WireType>
+		void StoreWireValue(nData data, WireType value, nBool needSwap) noexcept
+		{
+			if (needSwap)
+			{
+				SwapEndian(reinterpret_cast<nData>(&value), sizeof(WireType));
+			}
+			std::memcpy(data, &value, sizeof(WireType));
+		}
+
+		template <typename... Fields>
+		constexpr size_t FixedPrefixCount() noexcept
+		{
+			const nBool isFixedSize[] = { Fields::IsFixedSize..., false };
+			size_t count = 0;
+			while (isFixedSize[count])
+			{
+				++count;
+			}
+			return count;
+		}
+
+		template <typename... Fields>
+		constexpr size_t FixedSizeSum(size_t count) noexcept
+		{
+			const size_t fixedSize[] = { Fields::FixedSize..., 0 };
+			size_t sum = 0;
+			for (size_t i = 0; i < count; ++i)
+			{
+				sum += fixedSize[i];
+			}
+			return sum;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	PODֶ
+	///	@note	WireTypeΪֶеͣдʱMemberstatic_castת
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename Class, typename Member, typename WireType, FieldEndianness Endianness>
+	struct PodFieldDescriptor
+	{
+		static_assert(std::is_pod<WireType>::value, "WireType should be a pod type.");
+
+		static constexpr nBool IsFixedSize = true;
+		static constexpr size_t FixedSize = sizeof(WireType);
+
+		Member Class::* Pointer;
+
+		nBool Validate(ncData /*data*/, detail_::FieldContext const& /*context*/) const noexcept
+		{
+			return true;
+		}
+
+		nBool Decode(ncData data, Class& obj, detail_::FieldContext const& context) const
+		{
+			obj.*Pointer = static_cast<Member>(detail_::LoadWireValue<WireType>(data, context.NeedSwap(Endianness)));
+			return true;
+		}
+
+		void Encode(nData data, Class const& obj, detail_::FieldContext const& context) const
+		{
+			detail_::StoreWireValue(data, static_cast<WireType>(obj.*Pointer), context.NeedSwap(Endianness));
+		}
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	ֶ
+	///	@note	ǩȹ̶ֵȡʱṹȡʧܣдʱдValue
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename T, FieldEndianness Endianness>
+	struct ConstantFieldDescriptor
+	{
+		static_assert(std::is_pod<T>::value, "T should be a pod type.");
+
+		static constexpr nBool IsFixedSize = true;
+		static constexpr size_t FixedSize = sizeof(T);
+
+		T Value;
+
+		nBool Validate(ncData data, detail_::FieldContext const& context) const noexcept
+		{
+			return detail_::LoadWireValue<T>(data, context.NeedSwap(Endianness)) == Value;
+		}
+
+		template <typename Class>
+		nBool Decode(ncData data, Class& /*obj*/, detail_::FieldContext const& context) const noexcept
+		{
+			return Validate(data, context);
+		}
+
+		template <typename Class>
+		void Encode(nData data, Class const& /*obj*/, detail_::FieldContext const& context) const noexcept
+		{
+			detail_::StoreWireValue(data, Value, context.NeedSwap(Endianness));
+		}
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	䳤ֶ
+	///	@note	LEB128룬зͻȽzigzag
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename Class, typename Member>
+	struct VarintFieldDescriptor
+	{
+		static_assert(detail_::IsVarintType<Member>::value, "Member should be an integral or enum type.");
+
+		static constexpr nBool IsFixedSize = false;
+		static constexpr size_t FixedSize = 0;
+
+		Member Class::* Pointer;
+
+		nBool Read(natBinaryReader& reader, Class& obj, detail_::FieldContext const& /*context*/) const
+		{
+			obj.*Pointer = reader.ReadVarint<Member>();
+			return true;
+		}
+
+		void Write(natBinaryWriter& writer, Class const& obj, detail_::FieldContext const& /*context*/) const
+		{
+			writer.WriteVarint(obj.*Pointer);
+		}
+	};
+
+	///	@brief	PODֶ
+	///	@tparam	WireType	ֶеͣΪvoidʱԱһ
+	///	@tparam	Endianness	ֶεֽ
+	template <typename WireType = void, FieldEndianness Endianness = FieldEndianness::Default, typename Class, typename Member>
+	constexpr PodFieldDescriptor<Class, Member, std::conditional_t<std::is_void<WireType>::value, Member, WireType>, Endianness> PodField(Member Class::* pointer) noexcept
+	{
+		return { pointer };
+	}
+
+	///	@brief	ֶ
+	template <FieldEndianness Endianness = FieldEndianness::Default, typename T>
+	constexpr ConstantFieldDescriptor<T, Endianness> ConstantField(T value) noexcept
+	{
+		return { value };
+	}
+
+	///	@brief	䳤ֶ
+	template <typename Class, typename Member>
+	constexpr VarintFieldDescriptor<Class, Member> VarintField(Member Class::* pointer) noexcept
+	{
+		return { pointer };
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	ƽṹ
+	///	@note	ֶconstexprԪṹеĲ
+	///			ͷĶֶνϲΪһζȡ/д룬ֻҪֶתֽ
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename... Fields>
+	class natBinarySchema
+	{
+	public:
+		///	@brief	ͷĶֶ
+		static constexpr size_t FixedPrefixCount = detail_::FixedPrefixCount<Fields...>();
+		///	@brief	ͷĶֶеܴС
+		static constexpr size_t FixedPrefixSize = detail_::FixedSizeSum<Fields...>(FixedPrefixCount);
+
+		constexpr explicit natBinarySchema(Fields... fields)
+			: m_Fields{ fields... }
+		{
+		}
+
+		///	@brief	readerȡobj
+		///	@return	ֶβʱfalseֶλڿͷĶobjᱻ޸
+		template <typename Class>
+		nBool Read(natBinaryReader& reader, Class& obj) const
+		{
+			const detail_::FieldContext context{ reader.GetEndianness(), Environment::GetEndianness() };
+
+			nByte buffer[FixedPrefixSize ? FixedPrefixSize : 1];
+			const nLen prefixSize = FixedPrefixSize;
+			if (prefixSize)
+			{
+				const auto readBytes = reader.GetUnderlyingStream()->ReadBytes(buffer, prefixSize);
+				// ȼ鳣ֶΣԱڶȡݲǴ˽ṹʱfalse׳쳣
+				if (!validatePrefix(buffer, static_cast<size_t>(readBytes), context, std::make_index_sequence<FixedPrefixCount>{}))
+				{
+					return false;
+				}
+				if (readBytes < prefixSize)
+				{
+					nat_Throw(natException, "Only partial data ({0} bytes/{1} bytes requested) has been successfully read."_nv, readBytes, prefixSize);
+				}
+				decodePrefix(buffer, obj, context, std::make_index_sequence<FixedPrefixCount>{});
+			}
+
+			return readRest(reader, obj, context, std::make_index_sequence<sizeof...(Fields)>{});
+		}
+
+		///	@brief	objдwriter
+		template <typename Class>
+		void Write(natBinaryWriter& writer, Class const& obj) const
+		{
+			const detail_::FieldContext context{ writer.GetEndianness(), Environment::GetEndianness() };
+
+			nByte buffer[FixedPrefixSize ? FixedPrefixSize : 1];
+			const nLen prefixSize = FixedPrefixSize;
+			if (prefixSize)
+			{
+				encodePrefix(buffer, obj, context, std::make_index_sequence<FixedPrefixCount>{});
+				nLen writtenBytes;
+				if ((writtenBytes = writer.GetUnderlyingStream()->WriteBytes(buffer, prefixSize)) < prefixSize)
+				{
+					nat_Throw(natException, "Only partial data ({0} bytes/{1} bytes requested) has been successfully written."_nv, writtenBytes, prefixSize);
+				}
+			}
+
+			writeRest(writer, obj, context, std::make_index_sequence<sizeof...(Fields)>{});
+		}
+
+	private:
+		std::tuple<Fields...> m_Fields;
+
+		template <size_t I>
+		using FieldType = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+		template <size_t I>
+		static constexpr size_t offsetOf() noexcept
+		{
+			return detail_::FixedSizeSum<Fields...>(I);
+		}
+
+		template <size_t... I>
+		nBool validatePrefix(ncData data, size_t available, detail_::FieldContext const& context, std::index_sequence<I...>) const
+		{
+			nBool result = true;
+			static_cast<void>(std::initializer_list<int>{ (result = result && (offsetOf<I>() + FieldType<I>::FixedSize > available || std::get<I>(m_Fields).Validate(data + offsetOf<I>(), context)), 0)... });
+			return result;
+		}
+
+		template <typename Class, size_t... I>
+		void decodePrefix(ncData data, Class& obj, detail_::FieldContext const& context, std::index_sequence<I...>) const
+		{
+			static_cast<void>(std::initializer_list<int>{ (std::get<I>(m_Fields).Decode(data + offsetOf<I>(), obj, context), 0)... });
+		}
+
+		template <typename Class, size_t... I>
+		void encodePrefix(nData data, Class const& obj, detail_::FieldContext const& context, std::index_sequence<I...>) const
+		{
+			static_cast<void>(std::initializer_list<int>{ (std::get<I>(m_Fields).Encode(data + offsetOf<I>(), obj, context), 0)... });
+		}
+
+		template <typename Class, size_t... I>
+		nBool readRest(natBinaryReader& reader, Class& obj, detail_::FieldContext const& context, std::index_sequence<I...>) const
+		{
+			nBool result = true;
+			static_cast<void>(std::initializer_list<int>{ (result = result && (I < FixedPrefixCount || readField(std::get<I>(m_Fields), reader, obj, context, std::integral_constant<nBool, FieldType<I>::IsFixedSize>{})), 0)... });
+			return result;
+		}
+
+		template <typename Class, size_t... I>
+		void writeRest(natBinaryWriter& writer, Class const& obj, detail_::FieldContext const& context, std::index_sequence<I...>) const
+		{
+			static_cast<void>(std::initializer_list<int>{ (I < FixedPrefixCount ? void() : writeField(std::get<I>(m_Fields), writer, obj, context, std::integral_constant<nBool, FieldType<I>::IsFixedSize>{}), 0)... });
+		}
+
+		template <typename Field, typename Class>
+		static nBool readField(Field const& field, natBinaryReader& reader, Class& obj, detail_::FieldContext const& context, std::true_type)
+		{
+			nByte buffer[Field::FixedSize];
+			reader.ReadPodArray(buffer);
+			return field.Decode(buffer, obj, context);
+		}
+
+		template <typename Field, typename Class>
+		static nBool readField(Field const& field, natBinaryReader& reader, Class& obj, detail_::FieldContext const& context, std::false_type)
+		{
+			return field.Read(reader, obj, context);
+		}
+
+		template <typename Field, typename Class>
+		static void writeField(Field const& field, natBinaryWriter& writer, Class const& obj, detail_::FieldContext const& context, std::true_type)
+		{
+			nByte buffer[Field::FixedSize];
+			field.Encode(buffer, obj, context);
+			writer.WritePodArray(buffer);
+		}
+
+		template <typename Field, typename Class>
+		static void writeField(Field const& field, natBinaryWriter& writer, Class const& obj, detail_::FieldContext const& context, std::false_type)
+		{
+			field.Write(writer, obj, context);
+		}
+	};
+
+	///	@brief	ֶƽṹ
+	///	@code{.cpp}
+	///	static constexpr auto Schema = MakeBinarySchema(
+	///		ConstantField(Signature),
+	///		PodField(&Header::Version),
+	///		PodField<nuInt>(&Header::Size),
+	///		VarintField(&Header::Count));
+	///	@endcode
+	template <typename... Fields>
+	constexpr natBinarySchema<Fields...> MakeBinarySchema(Fields... fields)
+	{
+		return natBinarySchema<Fields...>{ fields... };
+	}
 }
@@ -0,0 +1,159 @@
+#include "stdafx.h"
+#include "natCodec.h"
+#include "natException.h"
+#include "natCompressionStream.h"
+
+using namespace NatsuLib;
+
+namespace
+{
+	class StoredCodec final
+		: public natRefObjImpl<ICodec>
+	{
+	public:
+		CompressionMethod GetCompressionMethod() const noexcept override
+		{
+			return CompressionMethod::Stored;
+		}
+
+		nStrView GetCodecName() const noexcept override
+		{
+			return "Stored"_nv;
+		}
+
+		natRefPointer<natStream> CreateEncoder(natRefPointer<natStream> stream) override
+		{
+			return stream;
+		}
+
+		void FinishEncoder(natRefPointer<natStream> const&) override
+		{
+		}
+
+		natRefPointer<natStream> CreateDecoder(natRefPointer<natStream> stream) override
+		{
+			return stream;
+		}
+	};
+
+	// ʵʾZipĵͨдСڣͨظzlib״̬Աÿδʱ·
+	class DeflateCodec final
+		: public natRefObjImpl<ICodec>
+	{
+	public:
+		DeflateCodec()
+			: m_EnginePool{ make_ref<natDeflateEnginePool>() }
+		{
+		}
+
+		CompressionMethod GetCompressionMethod() const noexcept override
+		{
+			return CompressionMethod::Deflate;
+		}
+
+		nStrView GetCodecName() const noexcept override
+		{
+			return "Deflate"_nv;
+		}
+
+		natRefPointer<natStream> CreateEncoder(natRefPointer<natStream> stream) override
+		{
+			return make_ref<natDeflateStream>(std::move(stream), natDeflateStream::CompressionLevel::Optimal, m_EnginePool, natRefPointer<natDeflateDictionary>{});
+		}
+
+		void FinishEncoder(natRefPointer<natStream> const& encoder) override
+		{
+			static_cast<natRefPointer<natDeflateStream>>(encoder)->Finish();
+		}
+
+		natRefPointer<natStream> CreateDecoder(natRefPointer<natStream> stream) override
+		{
+			return make_ref<natDeflateStream>(std::move(stream), m_EnginePool, natRefPointer<natDeflateDictionary>{});
+		}
+
+	private:
+		natRefPointer<natDeflateEnginePool> m_EnginePool;
+	};
+
+	class LzCodec final
+		: public natRefObjImpl<ICodec>
+	{
+	public:
+		CompressionMethod GetCompressionMethod() const noexcept override
+		{
+			return CompressionMethod::Lz;
+		}
+
+		nStrView GetCodecName() const noexcept override
+		{
+			return "Lz"_nv;
+		}
+
+		natRefPointer<natStream> CreateEncoder(natRefPointer<natStream> stream) override
+		{
+			return make_ref<natLzStream>(std::move(stream), natDeflateStream::CompressionLevel::Optimal);
+		}
+
+		void FinishEncoder(natRefPointer<natStream> const& encoder) override
+		{
+			static_cast<natRefPointer<natLzStream>>(encoder)->Finish();
+		}
+
+		natRefPointer<natStream> CreateDecoder(natRefPointer<natStream> stream) override
+		{
+			return make_ref<natLzStream>(std::move(stream));
+		}
+	};
+}
+
+ICodec::~ICodec()
+{
+}
+
+natCodecRegistry::natCodecRegistry()
+{
+}
+
+natCodecRegistry::~natCodecRegistry()
+{
+}
+
+natCodecRegistry& natCodecRegistry::GetDefault()
+{
+	static natCodecRegistry s_DefaultRegistry;
+	static const auto s_Initialized = []
+	{
+		s_DefaultRegistry.RegisterCodec(make_ref<StoredCodec>());
+		s_DefaultRegistry.RegisterCodec(make_ref<DeflateCodec>());
+		s_DefaultRegistry.RegisterCodec(make_ref<LzCodec>());
+		return true;
+	}();
+	static_cast<void>(s_Initialized);
+
+	return s_DefaultRegistry;
+}
+
+void natCodecRegistry::RegisterCodec(natRefPointer<ICodec> codec)
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+
+	nBool succeed;
+	tie(std::ignore, succeed) = m_CodecMap.emplace(codec->GetCompressionMethod(), std::move(codec));
+	if (!succeed)
+	{
+		nat_Throw(natErrException, NatErr_Duplicated, "Register codec failed: duplicated compression method."_nv);
+	}
+}
+
+void natCodecRegistry::UnregisterCodec(CompressionMethod method)
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	m_CodecMap.erase(method);
+}
+
+natRefPointer<ICodec> natCodecRegistry::GetCodec(CompressionMethod method) const
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	const auto iter = m_CodecMap.find(method);
+	return iter != m_CodecMap.end() ? iter->second : nullptr;
+}
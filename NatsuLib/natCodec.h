@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////
+///	@file	natCodec.h
+///	@brief	ѹע
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "natConfig.h"
+#include "natRefObj.h"
+#include "natStream.h"
+#include "natMultiThread.h"
+#include <unordered_map>
+
+namespace NatsuLib
+{
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	ѹ
+	///	@note	ֵZipĵеѹֶһ
+	////////////////////////////////////////////////////////////////////////////////
+	enum class CompressionMethod : nuShort
+	{
+		Stored = 0x0,
+		Deflate = 0x8,
+		Deflate64 = 0x9,
+		BZip2 = 0xC,
+		LZMA = 0xE,
+		///	@brief	natLzStreamʹõĸʽ
+		///	@note	Ǳ׼ѹʹô˷Zipĵɱȡ
+		Lz = 0x4C5A,
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	ӿ
+	////////////////////////////////////////////////////////////////////////////////
+	struct ICodec
+		: natRefObj
+	{
+		~ICodec();
+
+		///	@brief	ñӦѹ
+		virtual CompressionMethod GetCompressionMethod() const noexcept = 0;
+		///	@brief	ñ
+		///	@note	õnStrViewCodecЧַ
+		virtual nStrView GetCodecName() const noexcept = 0;
+
+		///	@brief	ѹ
+		///	@param[in]	stream	дѹݵ
+		///	@return	дδѹݵдϺFinishEncoder
+		virtual natRefPointer<natStream> CreateEncoder(natRefPointer<natStream> stream) = 0;
+		///	@brief	ѹʣдײ
+		///	@param[in]	encoder	ɴ˱CreateEncoder
+		virtual void FinishEncoder(natRefPointer<natStream> const& encoder) = 0;
+		///	@brief	ѹ
+		///	@param[in]	stream	ѹݵ
+		///	@return	ȡѹݵ
+		virtual natRefPointer<natStream> CreateDecoder(natRefPointer<natStream> stream) = 0;
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	ע
+	///	@note	ѹұзΪ̰߳ȫ
+	///			ĬעԤעStoredDeflateLzınatZipArchiveͨĬעдڵ
+	////////////////////////////////////////////////////////////////////////////////
+	class natCodecRegistry final
+		: public nonmovable
+	{
+	public:
+		natCodecRegistry();
+		~natCodecRegistry();
+
+		///	@brief	Ĭע
+		static natCodecRegistry& GetDefault();
+
+		///	@brief	ע
+		///	@note	ͬѹı׳쳣
+		void RegisterCodec(natRefPointer<ICodec> codec);
+		void UnregisterCodec(CompressionMethod method);
+
+		///	@brief	ѹұ
+		///	@note	δҵ᷵nullptr
+		natRefPointer<ICodec> GetCodec(CompressionMethod method) const;
+
+	private:
+		struct CompressionMethodHash
+		{
+			size_t operator()(CompressionMethod method) const noexcept
+			{
+				return static_cast<size_t>(method);
+			}
+		};
+
+		mutable natCriticalSection m_Section;
+		std::unordered_map<CompressionMethod, natRefPointer<ICodec>, CompressionMethodHash> m_CodecMap;
+	};
+}
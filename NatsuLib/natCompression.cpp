@@ -1,6 +1,8 @@
 #include "stdafx.h"
 #include "natCompression.h"
 #include "natEncoding.h"
+#include "natCrc32.h"
+#include <list>
 
 using namespace NatsuLib;
 
@@ -8,6 +10,142 @@ using namespace NatsuLib;
 constexpr nuInt natZipArchive::Mask32Bit;
 constexpr nuShort natZipArchive::Mask16Bit;
 
+namespace
+{
+	// лݵֻ֤ͷǰЧ
+	class CachedEntryStream
+		: public natExternMemoryStream
+	{
+	public:
+		explicit CachedEntryStream(std::shared_ptr<const std::vector<nByte>> data)
+			: natExternMemoryStream(data->empty() ? &s_EmptyData : data->data(), data->size(), true), m_Data{ std::move(data) }
+		{
+		}
+
+	private:
+		static const nByte s_EmptyData;
+
+		const std::shared_ptr<const std::vector<nByte>> m_Data;
+	};
+
+	const nByte CachedEntryStream::s_EmptyData{};
+}
+
+class natZipArchive::EntryCache
+	: public nonmovable
+{
+public:
+	EntryCache()
+		: m_Capacity{}, m_CachedBytes{}, m_Hits{}, m_Misses{}, m_Evictions{}
+	{
+	}
+
+	natRefPointer<natStream> Open(ZipEntry& entry)
+	{
+		const auto length = entry.GetLength();
+
+		{
+			natRefScopeGuard<natCriticalSection> guard{ m_Section };
+
+			if (!m_Capacity)
+			{
+				return entry.openForRead();
+			}
+
+			const auto iter = m_Index.find(&entry);
+			if (iter != m_Index.end())
+			{
+				++m_Hits;
+				m_Items.splice(m_Items.begin(), m_Items, iter->second);
+				return make_ref<CachedEntryStream>(iter->second->Data);
+			}
+
+			++m_Misses;
+			if (length > m_Capacity)
+			{
+				return entry.openForRead();
+			}
+		}
+
+		// ʵʾٽѹͬʱδͬһʱظѹڵĶȡ
+		auto data = std::make_shared<std::vector<nByte>>(static_cast<size_t>(length));
+		if (length)
+		{
+			entry.openForRead()->ForceReadBytes(data->data(), data->size());
+		}
+		if (Crc32::Update(0, data->data(), data->size()) != entry.GetCrc32())
+		{
+			nat_Throw(InvalidData, "Entry \"{0}\" is corrupted."_nv, entry.GetName());
+		}
+
+		std::shared_ptr<const std::vector<nByte>> cachedData = std::move(data);
+
+		natRefScopeGuard<natCriticalSection> guard{ m_Section };
+		const auto iter = m_Index.find(&entry);
+		if (iter != m_Index.end())
+		{
+			m_Items.splice(m_Items.begin(), m_Items, iter->second);
+		}
+		else if (cachedData->size() <= m_Capacity)
+		{
+			m_Items.push_front({ &entry, cachedData });
+			m_Index.emplace(&entry, m_Items.begin());
+			m_CachedBytes += cachedData->size();
+			evict();
+		}
+
+		return make_ref<CachedEntryStream>(std::move(cachedData));
+	}
+
+	void SetCapacity(size_t capacity)
+	{
+		natRefScopeGuard<natCriticalSection> guard{ m_Section };
+		m_Capacity = capacity;
+		evict();
+	}
+
+	void Clear()
+	{
+		natRefScopeGuard<natCriticalSection> guard{ m_Section };
+		m_Index.clear();
+		m_Items.clear();
+		m_CachedBytes = 0;
+	}
+
+	EntryCacheStatistics GetStatistics() const
+	{
+		natRefScopeGuard<natCriticalSection> guard{ m_Section };
+		return { m_Hits, m_Misses, m_Evictions, m_Index.size(), m_CachedBytes, m_Capacity };
+	}
+
+private:
+	struct CacheItem
+	{
+		const ZipEntry* Entry;
+		std::shared_ptr<const std::vector<nByte>> Data;
+	};
+
+	mutable natCriticalSection m_Section;
+	// ʹõǰ
+	std::list<CacheItem> m_Items;
+	std::unordered_map<const ZipEntry*, std::list<CacheItem>::iterator> m_Index;
+	size_t m_Capacity, m_CachedBytes;
+	nuLong m_Hits, m_Misses, m_Evictions;
+
+	// ʵʾٽе
+	void evict()
+	{
+		while (m_CachedBytes > m_Capacity)
+		{
+			auto& item = m_Items.back();
+			m_CachedBytes -= item.Data->size();
+			m_Index.erase(item.Entry);
+			m_Items.pop_back();
+			++m_Evictions;
+		}
+	}
+};
+
 natZipArchive::ZipEntry::~ZipEntry()
 {
 }
@@ -45,7 +183,7 @@ natRefPointer<natStream> natZipArchive::ZipEntry::Open()
 	case ZipArchiveMode::Create:
 		return openForCreate();
 	case ZipArchiveMode::Read:
-		return openForRead();
+		return m_Archive->m_EntryCache->Open(*this);
 	case ZipArchiveMode::Update:
 		return openForUpdate();
 	default:
@@ -54,28 +192,76 @@ natRefPointer<natStream> natZipArchive::ZipEntry::Open()
 	}
 }
 
+nStrView natZipArchive::ZipEntry::GetName() const noexcept
+{
+	return m_CentralDirectoryFileHeader.Filename;
+}
+
+nuLong natZipArchive::ZipEntry::GetCompressedLength() const noexcept
+{
+	return m_CentralDirectoryFileHeader.CompressedSize;
+}
+
+nuLong natZipArchive::ZipEntry::GetLength() const noexcept
+{
+	return m_CentralDirectoryFileHeader.UncompressedSize;
+}
+
+nuInt natZipArchive::ZipEntry::GetCrc32() const noexcept
+{
+	return m_CentralDirectoryFileHeader.Crc32;
+}
+
+CompressionMethod natZipArchive::ZipEntry::GetCompressionMethod() const noexcept
+{
+	return static_cast<CompressionMethod>(m_CentralDirectoryFileHeader.CompressionMethod);
+}
+
+void natZipArchive::ZipEntry::SetCompressionMethod(CompressionMethod method)
+{
+	if (!m_Archive)
+	{
+		nat_Throw(natErrException, NatErr_IllegalState, "Archive or this entry has already disposed."_nv);
+	}
+
+	switch (m_Archive->m_Mode)
+	{
+	case ZipArchiveMode::Create:
+		if (m_EverOpenedForWrite)
+		{
+			nat_Throw(natErrException, NatErr_IllegalState, "Already opened for write."_nv);
+		}
+		break;
+	case ZipArchiveMode::Read:
+		nat_Throw(natErrException, NatErr_IllegalState, "Cannot set compression method while mode is ZipArchiveMode::Read."_nv);
+	case ZipArchiveMode::Update:
+	default:
+		break;
+	}
+
+	// ȷϱ
+	getCodec(method);
+
+	if (m_Archive->m_Mode == ZipArchiveMode::Update && (m_UncompressedData || method != GetCompressionMethod()))
+	{
+		// ʵʾԭеѹȡ
+		getUncompressedData();
+		m_CentralDirectoryFileHeader.CompressionMethod = static_cast<nuShort>(method);
+	}
+
+	m_CompressionMethod = method;
+}
+
 natZipArchive::ZipEntry::ZipEntry(natZipArchive* archive, CentralDirectoryFileHeader const& centralDirectoryFileHeader)
-	: m_Archive{ archive }, m_OriginallyInArchive{ true }, m_CentralDirectoryFileHeader(centralDirectoryFileHeader), m_EverOpenedForWrite{ false }, m_CurrentOpeningForWrite{ false }
+	: m_Archive{ archive }, m_OriginallyInArchive{ true }, m_CentralDirectoryFileHeader(centralDirectoryFileHeader), m_EverOpenedForWrite{ false }, m_CurrentOpeningForWrite{ false }, m_DataInArchive{ true }, m_CompressionMethod{ CompressionMethod::Deflate }
 {
 }
 
 natRefPointer<natStream> natZipArchive::ZipEntry::openForRead()
 {
+	const auto codec = getCodec(GetCompressionMethod());
 	const auto offset = getOffsetOfCompressedData();
-	auto compressedStream = make_ref<natSubStream>(m_Archive->m_Stream, offset, offset + m_CentralDirectoryFileHeader.CompressedSize);
-	switch (static_cast<CompressionMethod>(m_CentralDirectoryFileHeader.CompressionMethod))
-	{
-	case CompressionMethod::Deflate:
-		return make_ref<natDeflateStream>(std::move(compressedStream));
-	case CompressionMethod::Deflate64:
-	case CompressionMethod::BZip2:
-	case CompressionMethod::LZMA:
-		nat_Throw(NotImplementedException, "This compress method has not implemented yet (value is {0})."_nv, m_CentralDirectoryFileHeader.CompressionMethod);
-	case CompressionMethod::Stored:
-	default:
-		assert(static_cast<CompressionMethod>(m_CentralDirectoryFileHeader.CompressionMethod) == CompressionMethod::Stored && "Invalid CompressionMethod.");
-		return std::move(compressedStream);
-	}
+	return codec->CreateDecoder(make_ref<natSubStream>(m_Archive->m_Stream, offset, offset + m_CentralDirectoryFileHeader.CompressedSize, m_Archive->m_StreamSection));
 }
 
 natRefPointer<natStream> natZipArchive::ZipEntry::openForCreate()
@@ -85,10 +271,35 @@ natRefPointer<natStream> natZipArchive::ZipEntry::openForCreate()
 		nat_Throw(natErrException, NatErr_IllegalState, "Already opened for write."_nv);
 	}
 
+	// δʹ̳߳ʱڵֱдĵͬʱֻһڱд
+	if (!m_Archive->m_ThreadPool && m_Archive->m_HasEntryOpeningForWrite)
+	{
+		nat_Throw(natErrException, NatErr_IllegalState, "Only 1 stream should be opening at once in create mode without thread pool."_nv);
+	}
+
 	m_EverOpenedForWrite = true;
-	m_CentralDirectoryFileHeader.CompressionMethod = static_cast<nuShort>(CompressionMethod::Deflate);
+	m_CentralDirectoryFileHeader.CompressionMethod = static_cast<nuShort>(m_CompressionMethod);
+
+	if (m_Archive->m_ThreadPool)
+	{
+		// Ȼδѹݣͷźύ̳߳ѹ
+		m_CurrentOpeningForWrite = true;
+		m_UncompressedData = make_ref<natMemoryStream>(0, false, true, true);
+		return make_ref<DisposeCallbackStream>(m_UncompressedData, [this]
+		{
+			if (m_CurrentOpeningForWrite)
+			{
+				m_CurrentOpeningForWrite = false;
+				m_Archive->queueCompression(natRefPointer<ZipEntry>{ this });
+			}
+		});
+	}
 
-	return make_ref<ZipEntryWriteStream>(*this, createCompressor(m_Archive->m_Stream));
+	m_Archive->m_HasEntryOpeningForWrite = true;
+	return make_ref<ZipEntryWriteStream>(*this, [this]
+	{
+		m_Archive->m_HasEntryOpeningForWrite = false;
+	});
 }
 
 natRefPointer<natStream> natZipArchive::ZipEntry::openForUpdate()
@@ -100,8 +311,8 @@ natRefPointer<natStream> natZipArchive::ZipEntry::openForUpdate()
 
 	m_EverOpenedForWrite = true;
 	m_CurrentOpeningForWrite = true;
-	m_CentralDirectoryFileHeader.CompressionMethod = static_cast<nuShort>(CompressionMethod::Deflate);
 
+	// ʵʾgetUncompressedDataȡԭݺŻ޸ѹ
 	return make_ref<DisposeCallbackStream>(getUncompressedData(), [this]
 	{
 		m_CurrentOpeningForWrite = false;
@@ -110,6 +321,7 @@ natRefPointer<natStream> natZipArchive::ZipEntry::openForUpdate()
 
 nLen natZipArchive::ZipEntry::getOffsetOfCompressedData()
 {
+	natRefScopeGuard<natCriticalSection> guard{ *m_Archive->m_StreamSection };
 	if (!m_OffsetOfCompressedData)
 	{
 		const auto localHeaderOffset = m_CentralDirectoryFileHeader.RelativeOffsetOfLocalHeader;
@@ -128,63 +340,96 @@ natRefPointer<natStream> const& natZipArchive::ZipEntry::getUncompressedData()
 {
 	if (!m_UncompressedData)
 	{
-		m_UncompressedData = make_ref<natMemoryStream>(0, true, true, true);
+		const auto uncompressedData = make_ref<natMemoryStream>(0, true, true, true);
 
-		if (m_OriginallyInArchive)
+		if (m_DataInArchive)
 		{
-			const auto decompressor = openForRead();
-			m_UncompressedData->SetSize(decompressor->GetSize());
-			decompressor->CopyTo(m_UncompressedData);
+			// ʵʾѹ޷ôСĿ¼¼ĴСԤռ
+			uncompressedData->Reserve(m_CentralDirectoryFileHeader.UncompressedSize);
+			openForRead()->CopyTo(uncompressedData);
+			uncompressedData->SetPosition(NatSeek::Beg, 0);
 		}
 
-		m_CentralDirectoryFileHeader.CompressionMethod = static_cast<nuShort>(CompressionMethod::Deflate);
+		m_UncompressedData = uncompressedData;
+
+		m_CentralDirectoryFileHeader.CompressionMethod = static_cast<nuShort>(m_CompressionMethod);
 	}
 
 	return m_UncompressedData;
 }
 
-natRefPointer<natStream> natZipArchive::ZipEntry::createCompressor(natRefPointer<natStream> stream)
+natRefPointer<ICodec> natZipArchive::ZipEntry::getCodec(CompressionMethod method)
 {
-	assert(stream && "stream should not be nullptr.");
-	return make_ref<natCrc32Stream>(make_ref<natDeflateStream>(std::move(stream), natDeflateStream::CompressionLevel::Optimal));
+	auto codec = natCodecRegistry::GetDefault().GetCodec(method);
+	if (!codec)
+	{
+		nat_Throw(NotImplementedException, "This compress method has not implemented yet (value is {0})."_nv, static_cast<nuShort>(method));
+	}
+	return codec;
 }
 
-void natZipArchive::ZipEntry::loadExtraFieldAndCompressedData()
+void natZipArchive::ZipEntry::loadLocalHeaderFields()
+{
+	if (!m_OriginallyInArchive || m_LocalHeaderFields)
+	{
+		return;
+	}
+
+	// Zip64ֶνдʱ
+	m_LocalHeaderFields.emplace();
+	readLocalHeaderFields(&m_LocalHeaderFields.value());
+}
+
+nBool natZipArchive::ZipEntry::readLocalHeaderFields(std::deque<ExtraField>* fields)
 {
 	const auto stream = m_Archive->m_Stream;
 	const auto reader = m_Archive->m_Reader;
 	assert(stream && reader && "stream or reader should not be nullptr.");
 
-	// ȡLocalFileHeaderĸֶ
-	if (m_OriginallyInArchive)
-	{
-		stream->SetPosition(NatSeek::Beg, m_CentralDirectoryFileHeader.RelativeOffsetOfLocalHeader + LocalFileHeader::OffsetToFilenameLength);
+	stream->SetPosition(NatSeek::Beg, m_CentralDirectoryFileHeader.RelativeOffsetOfLocalHeader + LocalFileHeader::OffsetToFilenameLength);
 
-		const auto fileNameLength = reader->ReadPod<nuShort>();
-		const auto extraFieldLength = reader->ReadPod<nuShort>();
-		stream->SetPosition(NatSeek::Beg, fileNameLength);
+	const auto fileNameLength = reader->ReadPod<nuShort>();
+	const auto extraFieldLength = reader->ReadPod<nuShort>();
+	stream->SetPosition(NatSeek::Cur, fileNameLength);
 
-		m_LocalHeaderFields.emplace();
-		auto& fields = m_LocalHeaderFields.value();
-		ExtraField field;
+	auto hasZip64ExtraField = false;
+	ExtraField field;
 
-		const auto extraFieldStart = stream->GetPosition();
-		while (field.ReadWithLimit(reader, extraFieldStart + extraFieldLength))
+	const auto extraFieldStart = stream->GetPosition();
+	while (field.ReadWithLimit(reader, extraFieldStart + extraFieldLength))
+	{
+		if (field.Tag == Zip64ExtraField::Tag)
 		{
-			if (field.Tag != Zip64ExtraField::Tag)
-			{
-				fields.emplace_back(field);
-			}
+			hasZip64ExtraField = true;
+		}
+		else if (fields)
+		{
+			fields->emplace_back(field);
 		}
 	}
 
-	// ȡԭѹ
-	if (m_OriginallyInArchive && !m_EverOpenedForWrite)
+	return hasZip64ExtraField;
+}
+
+nLen natZipArchive::ZipEntry::getLengthInArchive()
+{
+	const auto& header = m_CentralDirectoryFileHeader;
+	const auto endOfData = getOffsetOfCompressedData() + header.CompressedSize;
+	auto length = endOfData - header.RelativeOffsetOfLocalHeader;
+
+	if (header.GeneralPurposeBitFlag & static_cast<nuShort>(BitFlag::DataDescriptor))
 	{
-		m_CachedCompressedData.emplace(m_CentralDirectoryFileHeader.CompressedSize);
-		stream->SetPosition(NatSeek::Beg, getOffsetOfCompressedData());
-		stream->ReadBytes(m_CachedCompressedData.value().data(), m_CentralDirectoryFileHeader.CompressedSize);
+		// ǩǿѡģȡͬļͷZip64ֶʱ8ֽڱʾСAPPNOTE 4.3.9.2
+		const auto useZip64 = readLocalHeaderFields(nullptr);
+		m_Archive->m_Stream->SetPosition(NatSeek::Beg, endOfData);
+		if (m_Archive->m_Reader->ReadPod<nuInt>() == LocalFileHeader::DataDescriptorSignature)
+		{
+			length += sizeof(nuInt);
+		}
+		length += sizeof(nuInt) + (useZip64 ? 2 * sizeof(nuLong) : 2 * sizeof(nuInt));
 	}
+
+	return length;
 }
 
 void natZipArchive::ZipEntry::writeLocalFileHeaderAndData()
@@ -194,37 +439,32 @@ void natZipArchive::ZipEntry::writeLocalFileHeaderAndData()
 
 	if (m_UncompressedData)
 	{
-		m_CentralDirectoryFileHeader.UncompressedSize = m_UncompressedData->GetSize();
+		auto& header = m_CentralDirectoryFileHeader;
+		header.UncompressedSize = m_UncompressedData->GetSize();
+		// ģʽǿѰַҪ
+		header.GeneralPurposeBitFlag &= ~static_cast<nuShort>(BitFlag::DataDescriptor);
 
-		const auto entryWriter = make_ref<ZipEntryWriteStream>(*this, createCompressor(stream));
+		const auto entryWriter = make_ref<ZipEntryWriteStream>(*this);
 		m_UncompressedData->SetPosition(NatSeek::Beg, 0);
 		m_UncompressedData->CopyTo(entryWriter);
 		m_UncompressedData.Reset();
+		m_OffsetOfCompressedData.reset();
+		m_DataInArchive = true;
 	}
-	else if (m_CachedCompressedData)
+	else if (m_Archive->m_Mode == ZipArchiveMode::Update ? !m_DataInArchive : !m_EverOpenedForWrite)
 	{
-		const auto& data = m_CachedCompressedData.value();
-		if (!m_CentralDirectoryFileHeader.UncompressedSize)
-		{
-			m_CentralDirectoryFileHeader.CompressionMethod = static_cast<nuShort>(CompressionMethod::Stored);
-		}
+		m_CentralDirectoryFileHeader.RelativeOffsetOfLocalHeader = stream->GetPosition();
 		LocalFileHeader::Write(writer, m_CentralDirectoryFileHeader, m_LocalHeaderFields, m_Archive->m_Encoding);
-		stream->WriteBytes(data.data(), data.size());
-	}
-	else
-	{
-		if (m_Archive->m_Mode == ZipArchiveMode::Update || !m_EverOpenedForWrite)
-		{
-			LocalFileHeader::Write(writer, m_CentralDirectoryFileHeader, m_LocalHeaderFields, m_Archive->m_Encoding);
-			m_EverOpenedForWrite = true;
-		}
+		m_OffsetOfCompressedData.reset();
+		m_EverOpenedForWrite = true;
+		m_DataInArchive = true;
 	}
 }
 
-natZipArchive::ZipEntry::ZipEntryWriteStream::ZipEntryWriteStream(ZipEntry& entry, natRefPointer<natCrc32Stream> crc32Stream, std::function<void()> finishCallback)
-	: m_Entry{ entry }, m_InternalStream{ std::move(crc32Stream) }, m_InitialPosition{}, m_WroteData{}, m_UseZip64{}, m_FinishCallback{ move(finishCallback) }
+natZipArchive::ZipEntry::ZipEntryWriteStream::ZipEntryWriteStream(ZipEntry& entry, std::function<void()> finishCallback)
+	: m_Entry{ entry }, m_Codec{ getCodec(entry.m_CompressionMethod) }, m_Encoder{ m_Codec->CreateEncoder(entry.m_Archive->m_Stream) }, m_InternalStream{ make_ref<natCrc32Stream>(m_Encoder) }, m_InitialPosition{}, m_WroteData{}, m_UseZip64{}, m_FinishCallback{ move(finishCallback) }
 {
-	assert(m_InternalStream && "crc32Stream should not be nullptr.");
+	m_Entry.m_CentralDirectoryFileHeader.CompressionMethod = static_cast<nuShort>(m_Entry.m_CompressionMethod);
 }
 
 natZipArchive::ZipEntry::ZipEntryWriteStream::~ZipEntryWriteStream()
@@ -301,9 +541,19 @@ nLen natZipArchive::ZipEntry::ZipEntryWriteStream::WriteBytes(ncData pData, nLen
 
 	if (!m_WroteData)
 	{
+		if (m_Entry.m_Archive->m_StreamingOutput)
+		{
+			// ޷صļͷϢCRC32Сд֮
+			auto& header = m_Entry.m_CentralDirectoryFileHeader;
+			header.GeneralPurposeBitFlag |= static_cast<nuShort>(BitFlag::DataDescriptor);
+			header.Crc32 = 0;
+			header.CompressedSize = 0;
+			header.UncompressedSize = 0;
+		}
+
 		m_Entry.m_CentralDirectoryFileHeader.RelativeOffsetOfLocalHeader = m_Entry.m_Archive->m_Stream->GetPosition();
 		m_UseZip64 = LocalFileHeader::Write(m_Entry.m_Archive->m_Writer, m_Entry.m_CentralDirectoryFileHeader, m_Entry.m_LocalHeaderFields, m_Entry.m_Archive->m_Encoding);
-		m_InitialPosition = static_cast<natRefPointer<natDeflateStream>>(m_InternalStream->GetUnderlyingStream())->GetUnderlyingStream()->GetPosition();
+		m_InitialPosition = m_Entry.m_Archive->m_Stream->GetPosition();
 		m_WroteData = true;
 	}
 
@@ -317,17 +567,27 @@ void natZipArchive::ZipEntry::ZipEntryWriteStream::Flush()
 
 void natZipArchive::ZipEntry::ZipEntryWriteStream::finish()
 {
+	m_Codec->FinishEncoder(m_Encoder);
+
 	m_Entry.m_CentralDirectoryFileHeader.Crc32 = m_InternalStream->GetCrc32();
 	m_Entry.m_CentralDirectoryFileHeader.UncompressedSize = m_InternalStream->GetPosition();
-	m_Entry.m_CentralDirectoryFileHeader.CompressedSize = static_cast<natRefPointer<natDeflateStream>>(m_InternalStream->GetUnderlyingStream())->GetUnderlyingStream()->GetPosition() - m_InitialPosition;
+	m_Entry.m_CentralDirectoryFileHeader.CompressedSize = m_WroteData ? m_Entry.m_Archive->m_Stream->GetPosition() - m_InitialPosition : 0;
 
 	if (m_WroteData)
 	{
-		// Ѿд LocalFileHeaderCrc32ԼСϢԭдǲģҪ
-		LocalFileHeader::WriteCrcAndSizes(m_Entry.m_Archive->m_Writer, m_Entry.m_CentralDirectoryFileHeader, m_UseZip64);
+		if (m_Entry.m_Archive->m_StreamingOutput)
+		{
+			LocalFileHeader::WriteDataDescriptor(m_Entry.m_Archive->m_Writer, m_Entry.m_CentralDirectoryFileHeader, m_UseZip64);
+		}
+		else
+		{
+			// Ѿд LocalFileHeaderCrc32ԼСϢԭдǲģҪ
+			LocalFileHeader::WriteCrcAndSizes(m_Entry.m_Archive->m_Writer, m_Entry.m_CentralDirectoryFileHeader, m_UseZip64);
+		}
 	}
 	else
 	{
+		m_Entry.m_CentralDirectoryFileHeader.CompressionMethod = static_cast<nuShort>(CompressionMethod::Stored);
 		m_Entry.m_CentralDirectoryFileHeader.RelativeOffsetOfLocalHeader = m_Entry.m_Archive->m_Stream->GetPosition();
 		LocalFileHeader::Write(m_Entry.m_Archive->m_Writer, m_Entry.m_CentralDirectoryFileHeader, m_Entry.m_LocalHeaderFields, m_Entry.m_Archive->m_Encoding);
 	}
@@ -452,12 +712,89 @@ void natZipArchive::ZipEntry::DisposeCallbackStream::Flush()
 }
 
 natZipArchive::ZipEntry::ZipEntry(natZipArchive* archive, nStrView const& entryName)
-	: m_Archive{ archive }, m_OriginallyInArchive{ false }, m_CentralDirectoryFileHeader{}, m_EverOpenedForWrite{ false }, m_CurrentOpeningForWrite{ false }
+	: m_Archive{ archive }, m_OriginallyInArchive{ false }, m_CentralDirectoryFileHeader{}, m_EverOpenedForWrite{ false }, m_CurrentOpeningForWrite{ false }, m_DataInArchive{ false }, m_CompressionMethod{ CompressionMethod::Deflate }
 {
 	m_CentralDirectoryFileHeader.Filename = entryName;
 	m_CentralDirectoryFileHeader.FilenameLength = static_cast<nuShort>(m_CentralDirectoryFileHeader.Filename.size() * sizeof(nString::CharType));
 }
 
+// ¼дֽΪλãʹѰַҲȷڼĿ¼ƫ
+class natZipArchive::PositionTrackingStream final
+	: public natRefObjImpl<natStream>
+{
+public:
+	explicit PositionTrackingStream(natRefPointer<natStream> stream)
+		: m_InternalStream{ std::move(stream) }, m_Position{}
+	{
+	}
+
+	nBool CanWrite() const override
+	{
+		return true;
+	}
+
+	nBool CanRead() const override
+	{
+		return false;
+	}
+
+	nBool CanResize() const override
+	{
+		return false;
+	}
+
+	nBool CanSeek() const override
+	{
+		return false;
+	}
+
+	nBool IsEndOfStream() const override
+	{
+		return false;
+	}
+
+	nLen GetSize() const override
+	{
+		return m_Position;
+	}
+
+	void SetSize(nLen) override
+	{
+		nat_Throw(natErrException, NatErr_NotSupport, "The type of this stream does not support this operation."_nv);
+	}
+
+	nLen GetPosition() const override
+	{
+		return m_Position;
+	}
+
+	void SetPosition(NatSeek, nLong) override
+	{
+		nat_Throw(natErrException, NatErr_NotSupport, "The type of this stream does not support this operation."_nv);
+	}
+
+	nLen ReadBytes(nData, nLen) override
+	{
+		nat_Throw(natErrException, NatErr_NotSupport, "The type of this stream does not support this operation."_nv);
+	}
+
+	nLen WriteBytes(ncData pData, nLen Length) override
+	{
+		const auto writtenBytes = m_InternalStream->WriteBytes(pData, Length);
+		m_Position += writtenBytes;
+		return writtenBytes;
+	}
+
+	void Flush() override
+	{
+		m_InternalStream->Flush();
+	}
+
+private:
+	const natRefPointer<natStream> m_InternalStream;
+	nLen m_Position;
+};
+
 natZipArchive::natZipArchive(natRefPointer<natStream> stream, ZipArchiveMode mode)
 #ifdef _WIN32
 	: natZipArchive(std::move(stream), StringType::Ansi, mode)
@@ -468,14 +805,30 @@ natZipArchive::natZipArchive(natRefPointer<natStream> stream, ZipArchiveMode mod
 }
 
 natZipArchive::natZipArchive(natRefPointer<natStream> stream, StringType encoding, ZipArchiveMode mode)
-	: m_Stream{ std::move(stream) }, m_Reader{ make_ref<natBinaryReader>(m_Stream, Environment::Endianness::LittleEndian) }, m_Encoding{ encoding }, m_Mode{ mode }
+	: natZipArchive(std::move(stream), encoding, mode, false)
 {
+}
+
+natZipArchive::natZipArchive(natRefPointer<natStream> stream, StringType encoding, ZipArchiveMode mode, nBool lazyLoadEntries)
+	: m_Stream{ std::move(stream) }, m_StreamSection{ std::make_shared<natCriticalSection>() }, m_Reader{ make_ref<natBinaryReader>(m_Stream, Environment::Endianness::LittleEndian) }, m_HasUnloadedEntries{ false }, m_HasDirectorySet{ false }, m_Encoding{ encoding }, m_Mode{ mode }, m_HasEntryOpeningForWrite{ false }, m_StreamingOutput{ false }, m_EndOfEntryData{}, m_ThreadPool{},
+	m_ZipEndOfCentralDirectory{}, m_Zip64EndOfCentralDirectoryLocator{}, m_Zip64EndOfCentralDirectory{}
+{
+	if (lazyLoadEntries && mode != ZipArchiveMode::Read)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "lazyLoadEntries can only be used with ZipArchiveMode::Read mode."_nv);
+	}
+
 	switch (mode)
 	{
 	case ZipArchiveMode::Create:
-		if (!m_Stream->CanWrite() || !m_Stream->CanSeek())
+		if (!m_Stream->CanWrite())
+		{
+			nat_Throw(natErrException, NatErr_InvalidArg, "stream should be writable with ZipArchiveMode::Create mode."_nv);
+		}
+		if (!m_Stream->CanSeek())
 		{
-			nat_Throw(natErrException, NatErr_InvalidArg, "stream should be writable and seekable with ZipArchiveMode::Create mode."_nv);
+			m_StreamingOutput = true;
+			m_Stream = make_ref<PositionTrackingStream>(std::move(m_Stream));
 		}
 		m_Writer = make_ref<natBinaryWriter>(m_Stream, Environment::Endianness::LittleEndian);
 		break;
@@ -485,6 +838,7 @@ natZipArchive::natZipArchive(natRefPointer<natStream> stream, StringType encodin
 			nat_Throw(natErrException, NatErr_InvalidArg, "stream should be readable and seekable with ZipArchiveMode::Read mode."_nv);
 		}
 		m_Reader = make_ref<natBinaryReader>(m_Stream, Environment::Endianness::LittleEndian);
+		m_EntryCache = std::make_unique<EntryCache>();
 		break;
 	case ZipArchiveMode::Update:
 		if (!m_Stream->CanRead() || !m_Stream->CanWrite() || !m_Stream->CanResize() || !m_Stream->CanSeek())
@@ -498,7 +852,22 @@ natZipArchive::natZipArchive(natRefPointer<natStream> stream, StringType encodin
 		assert(!"Invalid mode value.");
 	}
 	
-	internalOpen();
+	internalOpen(lazyLoadEntries);
+}
+
+natZipArchive::natZipArchive(natRefPointer<natStream> stream, natThreadPool& threadPool)
+#ifdef _WIN32
+	: natZipArchive(std::move(stream), StringType::Ansi, threadPool)
+#else
+	: natZipArchive(std::move(stream), StringType::Utf8, threadPool)
+#endif
+{
+}
+
+natZipArchive::natZipArchive(natRefPointer<natStream> stream, StringType encoding, natThreadPool& threadPool)
+	: natZipArchive(std::move(stream), encoding, ZipArchiveMode::Create)
+{
+	m_ThreadPool = &threadPool;
 }
 
 natZipArchive::~natZipArchive()
@@ -506,28 +875,260 @@ natZipArchive::~natZipArchive()
 	close();
 }
 
-natRefPointer<natZipArchive::ZipEntry> natZipArchive::CreateEntry(nStrView entryName)
+natRefPointer<natZipArchive::ZipEntry> natZipArchive::CreateEntry(nStrView entryName)
+{
+	auto entry = new ZipEntry(this, entryName);
+	const natRefPointer<ZipEntry> pEntry{ entry };
+	SafeRelease(entry);
+	m_EntriesMap.emplace(pEntry->m_CentralDirectoryFileHeader.Filename, pEntry);
+	return pEntry;
+}
+
+Linq<const natRefPointer<natZipArchive::ZipEntry>> natZipArchive::GetEntries() const
+{
+	{
+		natRefScopeGuard<natCriticalSection> guard{ m_EntriesSection };
+		loadAllEntries();
+	}
+
+	// ʵʾȡģʽڼϺm_EntriesMapٱ޸ģٽö
+	return from(m_EntriesMap).select([](auto&& pair) -> const natRefPointer<ZipEntry>& { return pair.second; });
+}
+
+natRefPointer<natZipArchive::ZipEntry> natZipArchive::GetEntry(nStrView entryName) const
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_EntriesSection };
+	const auto iter = m_EntriesMap.find(entryName);
+	if (iter == m_EntriesMap.cend())
+	{
+		if (m_HasUnloadedEntries)
+		{
+			return findUnloadedEntry(entryName);
+		}
+		return {};
+	}
+	return iter->second;
+}
+
+nBool natZipArchive::HasDirectory(nStrView directory) const
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_EntriesSection };
+	if (m_HasUnloadedEntries || m_HasDirectorySet)
+	{
+		// ʵʾӳټؽڶȡģʽڲٸı䣬˼ϽʼЧ
+		buildDirectorySet();
+		return m_DirectorySet.find(toRawEntryName(directory)) != m_DirectorySet.end();
+	}
+
+	const auto directorySize = directory.GetSize();
+	for (auto&& entryPair : m_EntriesMap)
+	{
+		const auto& name = entryPair.first;
+		if (name.GetSize() > directorySize && name[directorySize] == '/' && std::equal(directory.cbegin(), directory.cend(), name.cbegin()))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+nLen natZipArchive::ExtractAll(natThreadPool& threadPool, std::function<natRefPointer<natStream>(ZipEntry&)> sink)
+{
+	if (m_Mode != ZipArchiveMode::Read)
+	{
+		nat_Throw(natErrException, NatErr_IllegalState, "ExtractAll can only be used with ZipArchiveMode::Read mode."_nv);
+	}
+
+	if (!sink)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "sink should be a valid function."_nv);
+	}
+
+	{
+		natRefScopeGuard<natCriticalSection> guard{ m_EntriesSection };
+		loadAllEntries();
+	}
+
+	struct ExtractJob
+	{
+		ZipEntry* Entry;
+		std::function<natRefPointer<natStream>(ZipEntry&)>* Sink;
+		std::future<natThreadPool::WorkToken> WorkToken;
+
+		nuInt Run()
+		{
+			const auto output = (*Sink)(*Entry);
+			if (!output)
+			{
+				return 0;
+			}
+
+			const auto input = Entry->openForRead();
+			const auto crc32Stream = make_ref<natCrc32Stream>(output);
+			std::vector<nByte> buffer(ExtractBufferSize);
+			nuLong totalBytes{};
+			while (true)
+			{
+				const auto readBytes = input->ReadBytes(buffer.data(), buffer.size());
+				if (!readBytes)
+				{
+					break;
+				}
+				crc32Stream->ForceWriteBytes(buffer.data(), readBytes);
+				totalBytes += readBytes;
+			}
+			output->Flush();
+
+			if (totalBytes != Entry->GetLength() || crc32Stream->GetCrc32() != Entry->GetCrc32())
+			{
+				nat_Throw(InvalidData, "Entry \"{0}\" is corrupted."_nv, Entry->GetName());
+			}
+
+			return 1;
+		}
+	};
+
+	// ʵʾԤȶȡļͷԻݵλã⹤߳ٽнжѰַ
+	std::vector<ExtractJob> jobs;
+	jobs.reserve(m_EntriesMap.size());
+	for (auto&& entry : m_EntriesMap)
+	{
+		entry.second->getOffsetOfCompressedData();
+		jobs.push_back({ entry.second.Get(), &sink, {} });
+	}
+
+	// ʵʾȴύĹ뿪Ϊ߳jobs
+	size_t queuedCount{};
+	std::exception_ptr firstException;
+	try
+	{
+		for (auto&& job : jobs)
+		{
+			job.WorkToken = threadPool.QueueWork([](void* param)
+			{
+				return static_cast<ExtractJob*>(param)->Run();
+			}, &job);
+			++queuedCount;
+		}
+	}
+	catch (...)
+	{
+		firstException = std::current_exception();
+	}
+
+	nLen extractedCount{};
+	for (size_t i = 0; i < queuedCount; ++i)
+	{
+		try
+		{
+			extractedCount += jobs[i].WorkToken.get().GetResult().get();
+		}
+		catch (...)
+		{
+			if (!firstException)
+			{
+				firstException = std::current_exception();
+			}
+		}
+	}
+
+	if (firstException)
+	{
+		std::rethrow_exception(firstException);
+	}
+
+	return extractedCount;
+}
+
+void natZipArchive::Compact()
+{
+	if (m_Mode != ZipArchiveMode::Update)
+	{
+		nat_Throw(natErrException, NatErr_IllegalState, "Compact can only be used with ZipArchiveMode::Update mode."_nv);
+	}
+
+	std::vector<ZipEntry*> entries;
+	entries.reserve(m_EntriesMap.size());
+	for (auto&& entryPair : m_EntriesMap)
+	{
+		if (entryPair.second->m_CurrentOpeningForWrite)
+		{
+			nat_Throw(natErrException, NatErr_IllegalState, "Cannot compact while some entries are opening for write."_nv);
+		}
+		entries.emplace_back(entryPair.second.Get());
+	}
+
+	writeEntries();
+
+	// λǰƣĿλǲԴλã˲Ḳδƶ
+	std::sort(entries.begin(), entries.end(), [](ZipEntry* a, ZipEntry* b)
+	{
+		return a->m_CentralDirectoryFileHeader.RelativeOffsetOfLocalHeader < b->m_CentralDirectoryFileHeader.RelativeOffsetOfLocalHeader;
+	});
+
+	std::vector<nByte> buffer(CompactBufferSize);
+	nLen writePosition{};
+	for (const auto entry : entries)
+	{
+		auto& header = entry->m_CentralDirectoryFileHeader;
+		const auto readPosition = header.RelativeOffsetOfLocalHeader;
+		if (readPosition < writePosition)
+		{
+			nat_Throw(InvalidData, "Entry \"{0}\" overlaps with other entries."_nv, entry->GetName());
+		}
+
+		const auto length = entry->getLengthInArchive();
+		if (readPosition != writePosition)
+		{
+			for (nLen movedBytes{}; movedBytes < length;)
+			{
+				const auto currentBytes = static_cast<size_t>(std::min(length - movedBytes, static_cast<nLen>(buffer.size())));
+				m_Stream->SetPosition(NatSeek::Beg, readPosition + movedBytes);
+				m_Stream->ForceReadBytes(buffer.data(), currentBytes);
+				m_Stream->SetPosition(NatSeek::Beg, writePosition + movedBytes);
+				m_Stream->ForceWriteBytes(buffer.data(), currentBytes);
+				movedBytes += currentBytes;
+			}
+
+			header.RelativeOffsetOfLocalHeader = writePosition;
+			entry->m_OffsetOfCompressedData.reset();
+		}
+
+		writePosition += length;
+	}
+
+	m_EndOfEntryData = writePosition;
+	m_Stream->SetPosition(NatSeek::Beg, m_EndOfEntryData);
+	writeCentralDirectory();
+}
+
+void natZipArchive::SetEntryCacheCapacity(size_t capacity)
 {
-	auto entry = new ZipEntry(this, entryName);
-	const natRefPointer<ZipEntry> pEntry{ entry };
-	SafeRelease(entry);
-	m_EntriesMap.emplace(pEntry->m_CentralDirectoryFileHeader.Filename, pEntry);
-	return pEntry;
+	if (m_Mode != ZipArchiveMode::Read)
+	{
+		nat_Throw(natErrException, NatErr_IllegalState, "Entry cache can only be used with ZipArchiveMode::Read mode."_nv);
+	}
+
+	m_EntryCache->SetCapacity(capacity);
 }
 
-Linq<const natRefPointer<natZipArchive::ZipEntry>> natZipArchive::GetEntries() const
+natZipArchive::EntryCacheStatistics natZipArchive::GetEntryCacheStatistics() const
 {
-	return from(m_EntriesMap).select([](auto&& pair) -> const natRefPointer<ZipEntry>& { return pair.second; });
+	if (!m_EntryCache)
+	{
+		return {};
+	}
+
+	return m_EntryCache->GetStatistics();
 }
 
-natRefPointer<natZipArchive::ZipEntry> natZipArchive::GetEntry(nStrView entryName) const
+void natZipArchive::ClearEntryCache()
 {
-	const auto iter = m_EntriesMap.find(entryName);
-	if (iter == m_EntriesMap.cend())
+	if (m_EntryCache)
 	{
-		return {};
+		m_EntryCache->Clear();
 	}
-	return iter->second;
 }
 
 void natZipArchive::addEntry(natRefPointer<ZipEntry> entry)
@@ -551,16 +1152,44 @@ void natZipArchive::close()
 }
 
 void natZipArchive::writeToFile()
+{
+	if (m_ThreadPool)
+	{
+		// δͷŵеҲһύ֮ͷʱٴύ
+		for (auto&& entryPair : m_EntriesMap)
+		{
+			const auto& entry = entryPair.second;
+			if (entry->m_CurrentOpeningForWrite)
+			{
+				entry->m_CurrentOpeningForWrite = false;
+				queueCompression(entry);
+			}
+		}
+
+		while (!m_PendingCompressions.empty())
+		{
+			writeFrontCompression();
+		}
+	}
+
+	writeEntries();
+	writeCentralDirectory();
+}
+
+void natZipArchive::writeEntries()
 {
 	if (m_Mode == ZipArchiveMode::Update)
 	{
+		// ʵʾ޸ĵ׷֮δ޸ĵڱԭλ滻ɾڵݽCompactʱ
 		for (auto&& entryPair : m_EntriesMap)
 		{
-			entryPair.second->loadExtraFieldAndCompressedData();
+			if (entryPair.second->m_UncompressedData)
+			{
+				entryPair.second->loadLocalHeaderFields();
+			}
 		}
 
-		m_Stream->SetPosition(NatSeek::Beg, 0);
-		m_Stream->SetSize(0);
+		m_Stream->SetPosition(NatSeek::Beg, m_EndOfEntryData);
 	}
 
 	for (auto&& entryPair : m_EntriesMap)
@@ -568,6 +1197,11 @@ void natZipArchive::writeToFile()
 		entryPair.second->writeLocalFileHeaderAndData();
 	}
 
+	m_EndOfEntryData = m_Stream->GetPosition();
+}
+
+void natZipArchive::writeCentralDirectory()
+{
 	const auto startOfCentralDirectory = m_Stream->GetPosition();
 	for (auto&& entryPair : m_EntriesMap)
 	{
@@ -584,6 +1218,111 @@ void natZipArchive::writeToFile()
 	}
 
 	ZipEndOfCentralDirectory::Write(m_Writer, m_EntriesMap.size(), startOfCentralDirectory, sizeOfCentralDirectory, m_ZipEndOfCentralDirectory.ArchiveComment, m_Encoding);
+
+	if (m_Mode == ZipArchiveMode::Update)
+	{
+		// µĿ¼ܱԭеĶ̣ȥʣľ
+		m_Stream->SetSize(m_Stream->GetPosition());
+	}
+}
+
+struct natZipArchive::CompressionJob
+{
+	natRefPointer<ZipEntry> Entry;
+	natRefPointer<natMemoryStream> Input;
+	natRefPointer<natMemoryStream> Output;
+	nuInt Crc32;
+	std::future<natThreadPool::WorkToken> WorkToken;
+
+	nuInt Run()
+	{
+		const auto inputSize = Input->GetSize();
+		if (inputSize)
+		{
+			const auto codec = ZipEntry::getCodec(Entry->m_CompressionMethod);
+			const auto encoder = codec->CreateEncoder(Output);
+			const auto crc32Stream = make_ref<natCrc32Stream>(encoder);
+			crc32Stream->ForceWriteBytes(Input->GetInternalBuffer(), inputSize);
+			codec->FinishEncoder(encoder);
+			Crc32 = crc32Stream->GetCrc32();
+		}
+
+		return 0;
+	}
+};
+
+void natZipArchive::queueCompression(natRefPointer<ZipEntry> entry)
+{
+	assert(m_ThreadPool && "m_ThreadPool should not be nullptr.");
+
+	// ͬʱȴѹԿڴռ
+	const auto maxPendingCompressions = std::max(static_cast<size_t>(m_ThreadPool->GetMaxThreadCount()) * 2, size_t{ 1 });
+	while (m_PendingCompressions.size() >= maxPendingCompressions)
+	{
+		writeFrontCompression();
+	}
+
+	auto job = std::make_unique<CompressionJob>();
+	job->Input = static_cast<natRefPointer<natMemoryStream>>(entry->m_UncompressedData);
+	entry->m_UncompressedData.Reset();
+	job->Output = make_ref<natMemoryStream>(0, true, true, true);
+	job->Crc32 = 0;
+	job->Entry = std::move(entry);
+	job->WorkToken = m_ThreadPool->QueueWork([](void* param)
+	{
+		return static_cast<CompressionJob*>(param)->Run();
+	}, job.get());
+	m_PendingCompressions.emplace_back(std::move(job));
+}
+
+void natZipArchive::writeFrontCompression()
+{
+	assert(!m_PendingCompressions.empty());
+
+	const auto job = std::move(m_PendingCompressions.front());
+	m_PendingCompressions.pop_front();
+
+	try
+	{
+		// ʵʾѹʱ쳣ڴ˴׳
+		job->WorkToken.get().GetResult().get();
+	}
+	catch (...)
+	{
+		discardPendingCompressions();
+		throw;
+	}
+
+	auto& header = job->Entry->m_CentralDirectoryFileHeader;
+	header.Crc32 = job->Crc32;
+	header.UncompressedSize = job->Input->GetSize();
+	header.CompressedSize = job->Output->GetSize();
+	if (!header.UncompressedSize)
+	{
+		header.CompressionMethod = static_cast<nuShort>(CompressionMethod::Stored);
+	}
+	header.RelativeOffsetOfLocalHeader = m_Stream->GetPosition();
+	LocalFileHeader::Write(m_Writer, header, job->Entry->m_LocalHeaderFields, m_Encoding);
+	if (header.CompressedSize)
+	{
+		m_Stream->ForceWriteBytes(job->Output->GetInternalBuffer(), header.CompressedSize);
+	}
+}
+
+void natZipArchive::discardPendingCompressions() noexcept
+{
+	// ߳ʹڵݣҪȴɺͷ
+	for (auto&& job : m_PendingCompressions)
+	{
+		try
+		{
+			job->WorkToken.get().GetResult().wait();
+		}
+		catch (...)
+		{
+		}
+	}
+	m_PendingCompressions.clear();
 }
 
 void natZipArchive::ExtraField::Read(natBinaryReader* reader)
@@ -708,6 +1447,7 @@ void natZipArchive::Zip64ExtraField::Write(natBinaryWriter* writer)
 {
 	constexpr auto tag = Tag;
 
+	Size = static_cast<nuShort>(GetSize() - ExtraField::HeaderSize);
 	writer->WritePod(tag);
 	writer->WritePod(Size);
 	if (UncompressedSize)
@@ -728,32 +1468,40 @@ void natZipArchive::Zip64ExtraField::Write(natBinaryWriter* writer)
 	}
 }
 
+size_t natZipArchive::Zip64ExtraField::GetSize() const noexcept
+{
+	return ExtraField::HeaderSize + (UncompressedSize ? sizeof(nuLong) : 0) + (CompressedSize ? sizeof(nuLong) : 0) + (LocalHeaderOffset ? sizeof(nuLong) : 0) + (StartDiskNumber ? sizeof(nuInt) : 0);
+}
+
 nBool natZipArchive::CentralDirectoryFileHeader::Read(natBinaryReader* reader, nBool saveExtraFieldsAndComments, StringType encoding)
 {
-	if (reader->ReadPod<nuInt>() != Signature)
+	static constexpr auto Schema = MakeBinarySchema(
+		ConstantField(Signature),
+		PodField(&CentralDirectoryFileHeader::VersionMadeBySpecification),
+		PodField(&CentralDirectoryFileHeader::VersionMadeByCompatibility),
+		PodField(&CentralDirectoryFileHeader::VersionNeededToExtract),
+		PodField(&CentralDirectoryFileHeader::GeneralPurposeBitFlag),
+		PodField(&CentralDirectoryFileHeader::CompressionMethod),
+		PodField(&CentralDirectoryFileHeader::LastModified),
+		PodField(&CentralDirectoryFileHeader::Crc32),
+		PodField<nuInt>(&CentralDirectoryFileHeader::CompressedSize),
+		PodField<nuInt>(&CentralDirectoryFileHeader::UncompressedSize),
+		PodField(&CentralDirectoryFileHeader::FilenameLength),
+		PodField(&CentralDirectoryFileHeader::ExtraFieldLength),
+		PodField(&CentralDirectoryFileHeader::FileCommentLength),
+		PodField<nuShort>(&CentralDirectoryFileHeader::DiskNumberStart),
+		PodField(&CentralDirectoryFileHeader::InternalFileAttributes),
+		PodField(&CentralDirectoryFileHeader::ExternalFileAttributes),
+		PodField<nuInt>(&CentralDirectoryFileHeader::RelativeOffsetOfLocalHeader));
+
+	// ֺϲΪһζȡZip64صֶδʱΪضϵֵ
+	if (!reader->ReadSchema(Schema, *this))
 	{
 		return false;
 	}
 
 	const auto stream = reader->GetUnderlyingStream();
 
-	VersionMadeBySpecification = reader->ReadPod<nByte>();
-	VersionMadeByCompatibility = reader->ReadPod<nByte>();
-	VersionNeededToExtract = reader->ReadPod<nuShort>();
-	GeneralPurposeBitFlag = reader->ReadPod<nuShort>();
-	CompressionMethod = reader->ReadPod<nuShort>();
-	LastModified = reader->ReadPod<nuInt>();
-	Crc32 = reader->ReadPod<nuInt>();
-	const auto compressedSizeSmall = reader->ReadPod<nuInt>();
-	const auto uncompressedSizeSmall = reader->ReadPod<nuInt>();
-	FilenameLength = reader->ReadPod<nuShort>();
-	ExtraFieldLength = reader->ReadPod<nuShort>();
-	FileCommentLength = reader->ReadPod<nuShort>();
-	const auto diskNumberStartSmall = reader->ReadPod<nuShort>();
-	InternalFileAttributes = reader->ReadPod<nuShort>();
-	ExternalFileAttributes = reader->ReadPod<nuInt>();
-	const auto relativeOffsetOfLocalHeaderSmall = reader->ReadPod<nuInt>();
-
 	if (FilenameLength > 0)
 	{
 		if (encoding == nString::UsingStringType)
@@ -769,10 +1517,10 @@ nBool natZipArchive::CentralDirectoryFileHeader::Read(natBinaryReader* reader, n
 		}
 	}
 
-	nBool uncompressedSizeInZip64 = uncompressedSizeSmall == Mask32Bit;
-	nBool compressedSizeInZip64 = compressedSizeSmall == Mask32Bit;
-	nBool relativeOffsetInZip64 = relativeOffsetOfLocalHeaderSmall == Mask32Bit;
-	nBool diskNumberStartInZip64 = diskNumberStartSmall == Mask16Bit;
+	nBool uncompressedSizeInZip64 = UncompressedSize == Mask32Bit;
+	nBool compressedSizeInZip64 = CompressedSize == Mask32Bit;
+	nBool relativeOffsetInZip64 = RelativeOffsetOfLocalHeader == Mask32Bit;
+	nBool diskNumberStartInZip64 = DiskNumberStart == Mask16Bit;
 
 	const auto endPosition = stream->GetPosition() + ExtraFieldLength;
 
@@ -828,10 +1576,10 @@ nBool natZipArchive::CentralDirectoryFileHeader::Read(natBinaryReader* reader, n
 		}
 	}
 
-	UncompressedSize = zip64ExtraField.UncompressedSize.value_or(uncompressedSizeSmall);
-	CompressedSize = zip64ExtraField.CompressedSize.value_or(compressedSizeSmall);
-	RelativeOffsetOfLocalHeader = zip64ExtraField.LocalHeaderOffset.value_or(relativeOffsetOfLocalHeaderSmall);
-	DiskNumberStart = zip64ExtraField.StartDiskNumber.value_or(diskNumberStartSmall);
+	UncompressedSize = zip64ExtraField.UncompressedSize.value_or(UncompressedSize);
+	CompressedSize = zip64ExtraField.CompressedSize.value_or(CompressedSize);
+	RelativeOffsetOfLocalHeader = zip64ExtraField.LocalHeaderOffset.value_or(RelativeOffsetOfLocalHeader);
+	DiskNumberStart = zip64ExtraField.StartDiskNumber.value_or(DiskNumberStart);
 
 	return true;
 }
@@ -883,6 +1631,18 @@ void natZipArchive::CentralDirectoryFileHeader::Write(natBinaryWriter* writer, S
 		zip64ExtraField.LocalHeaderOffset = RelativeOffsetOfLocalHeader;
 	}
 
+	// ֶγʵдֶΪ׼Zip64ֶβExtraFields
+	auto extraFieldLength = needZip64 ? zip64ExtraField.GetSize() : 0;
+	for (auto&& item : ExtraFields)
+	{
+		extraFieldLength += item.GetSize();
+	}
+	if (extraFieldLength > std::numeric_limits<nuShort>::max())
+	{
+		nat_Throw(natErrException, NatErr_InternalErr, "Extra fields are too long."_nv);
+	}
+	ExtraFieldLength = static_cast<nuShort>(extraFieldLength);
+
 	writer->WritePod(signature);
 	writer->WritePod(VersionMadeBySpecification);
 	writer->WritePod(VersionMadeByCompatibility);
@@ -984,8 +1744,31 @@ nBool natZipArchive::LocalFileHeader::Write(natBinaryWriter* writer, CentralDire
 		zip64ExtraField.UncompressedSize = fileHeader.UncompressedSize;
 	}
 
+	// ʵʾСдʱв֪Ƿ񳬹32λдZip64ֶΣ
+	// ȡڱļͷZip64ֶʱŻ8ֽڶȡеĴСAPPNOTE 4.3.9.2
+	if (fileHeader.GeneralPurposeBitFlag & static_cast<nuShort>(ZipEntry::BitFlag::DataDescriptor))
+	{
+		needZip64 = true;
+		zip64ExtraField.CompressedSize = fileHeader.CompressedSize;
+		zip64ExtraField.UncompressedSize = fileHeader.UncompressedSize;
+	}
+
+	// ļͷĸֶĿ¼еĲͬҪ㳤
+	auto extraFieldLength = needZip64 ? zip64ExtraField.GetSize() : 0;
+	if (localFileHeaderFields)
+	{
+		for (auto&& item : localFileHeaderFields.value())
+		{
+			extraFieldLength += item.GetSize();
+		}
+	}
+	if (extraFieldLength > std::numeric_limits<nuShort>::max())
+	{
+		nat_Throw(natErrException, NatErr_InternalErr, "Extra fields are too long."_nv);
+	}
+
 	writer->WritePod(signature);
-	writer->WritePod(fileHeader.VersionNeededToExtract);
+	writer->WritePod(needZip64 ? std::max(fileHeader.VersionNeededToExtract, static_cast<nuShort>(ZipVersionNeeded::Zip64)) : fileHeader.VersionNeededToExtract);
 	writer->WritePod(fileHeader.GeneralPurposeBitFlag);
 	writer->WritePod(fileHeader.CompressionMethod);
 	writer->WritePod(fileHeader.LastModified);
@@ -993,7 +1776,7 @@ nBool natZipArchive::LocalFileHeader::Write(natBinaryWriter* writer, CentralDire
 	writer->WritePod(zip64ExtraField.CompressedSize ? Mask32Bit : static_cast<nuInt>(fileHeader.CompressedSize));
 	writer->WritePod(zip64ExtraField.UncompressedSize ? Mask32Bit : static_cast<nuInt>(fileHeader.UncompressedSize));
 	writer->WritePod(fileHeader.FilenameLength);
-	writer->WritePod(fileHeader.ExtraFieldLength);
+	writer->WritePod(static_cast<nuShort>(extraFieldLength));
 	stream->WriteBytes(filenameBytes.data(), filenameBytes.size());
 
 	if (needZip64)
@@ -1038,30 +1821,46 @@ void natZipArchive::LocalFileHeader::WriteCrcAndSizes(natBinaryWriter* writer, C
 	stream->SetPosition(NatSeek::Beg, dataEndPosition);
 }
 
+void natZipArchive::LocalFileHeader::WriteDataDescriptor(natBinaryWriter* writer, CentralDirectoryFileHeader const& header, nBool usedZip64)
+{
+	constexpr auto signature = DataDescriptorSignature;
+
+	writer->WritePod(signature);
+	writer->WritePod(header.Crc32);
+	if (usedZip64)
+	{
+		writer->WritePod(header.CompressedSize);
+		writer->WritePod(header.UncompressedSize);
+	}
+	else
+	{
+		writer->WritePod(static_cast<nuInt>(header.CompressedSize));
+		writer->WritePod(static_cast<nuInt>(header.UncompressedSize));
+	}
+}
+
 void natZipArchive::ZipEndOfCentralDirectory::Read(natBinaryReader* reader, StringType encoding)
 {
+	static constexpr auto Schema = MakeBinarySchema(
+		ConstantField(Signature),
+		PodField(&ZipEndOfCentralDirectory::NumberOfThisDisk),
+		PodField(&ZipEndOfCentralDirectory::NumberOfTheDiskWithTheStartOfTheCentralDirectory),
+		PodField(&ZipEndOfCentralDirectory::NumberOfEntriesInTheCentralDirectoryOnThisDisk),
+		PodField(&ZipEndOfCentralDirectory::NumberOfEntriesInTheCentralDirectory),
+		PodField(&ZipEndOfCentralDirectory::SizeOfTheCentralDirectory),
+		PodField(&ZipEndOfCentralDirectory::OffsetOfStartOfCentralDirectoryWithRespectToTheStartingDiskNumber));
+
 	const auto stream = reader->GetUnderlyingStream();
-#ifdef _DEBUG
-	if (reader->ReadPod<nuInt>() != Signature)
+	if (!reader->ReadSchema(Schema, *this))
 	{
-		assert(!"We are not reading valid eocd block.");
+		nat_Throw(InvalidData, "We are not reading valid eocd block."_nv);
 	}
-#else
-	reader->Skip(sizeof(nuInt));
-#endif
-	NumberOfThisDisk = reader->ReadPod<nuShort>();
-	NumberOfTheDiskWithTheStartOfTheCentralDirectory = reader->ReadPod<nuShort>();
-	NumberOfEntriesInTheCentralDirectoryOnThisDisk = reader->ReadPod<nuShort>();
-	NumberOfEntriesInTheCentralDirectory = reader->ReadPod<nuShort>();
 
 	if (NumberOfEntriesInTheCentralDirectory != NumberOfEntriesInTheCentralDirectoryOnThisDisk)
 	{
 		nat_Throw(InvalidData, "NumberOfEntriesInTheCentralDirectory does not equal to NumberOfEntriesInTheCentralDirectoryOnThisDisk."_nv);
 	}
 
-	SizeOfTheCentralDirectory = reader->ReadPod<nuInt>();
-	OffsetOfStartOfCentralDirectoryWithRespectToTheStartingDiskNumber = reader->ReadPod<nuInt>();
-
 	const auto commentSize = reader->ReadPod<nuShort>();
 
 	if (commentSize > 0)
@@ -1122,17 +1921,16 @@ void natZipArchive::ZipEndOfCentralDirectory::Write(natBinaryWriter* writer, nuL
 
 void natZipArchive::Zip64EndOfCentralDirectoryLocator::Read(natBinaryReader* reader)
 {
-#ifdef _DEBUG
-	if (reader->ReadPod<nuInt>() != Signature)
+	static constexpr auto Schema = MakeBinarySchema(
+		ConstantField(Signature),
+		PodField(&Zip64EndOfCentralDirectoryLocator::NumberOfDiskWithZip64EOCD),
+		PodField(&Zip64EndOfCentralDirectoryLocator::OffsetOfZip64EOCD),
+		PodField(&Zip64EndOfCentralDirectoryLocator::TotalNumberOfDisks));
+
+	if (!reader->ReadSchema(Schema, *this))
 	{
-		assert(!"We are not reading valid eocd locator block.");
+		nat_Throw(InvalidData, "We are not reading valid eocd locator block."_nv);
 	}
-#else
-	reader->Skip(sizeof(nuInt));
-#endif
-	NumberOfDiskWithZip64EOCD = reader->ReadPod<nuInt>();
-	OffsetOfZip64EOCD = reader->ReadPod<nuLong>();
-	TotalNumberOfDisks = reader->ReadPod<nuInt>();
 }
 
 void natZipArchive::Zip64EndOfCentralDirectoryLocator::Write(natBinaryWriter* writer, nuLong zip64EOCDRecordStart)
@@ -1147,20 +1945,22 @@ void natZipArchive::Zip64EndOfCentralDirectoryLocator::Write(natBinaryWriter* wr
 
 void natZipArchive::Zip64EndOfCentralDirectory::Read(natBinaryReader* reader)
 {
-	if (reader->ReadPod<nuInt>() != Signature)
+	static constexpr auto Schema = MakeBinarySchema(
+		ConstantField(Signature),
+		PodField(&Zip64EndOfCentralDirectory::SizeOfThisRecord),
+		PodField(&Zip64EndOfCentralDirectory::VersionMadeBy),
+		PodField(&Zip64EndOfCentralDirectory::VersionNeededToExtract),
+		PodField(&Zip64EndOfCentralDirectory::NumberOfThisDisk),
+		PodField(&Zip64EndOfCentralDirectory::NumberOfDiskWithStartOfCD),
+		PodField(&Zip64EndOfCentralDirectory::NumberOfEntriesOnThisDisk),
+		PodField(&Zip64EndOfCentralDirectory::NumberOfEntriesTotal),
+		PodField(&Zip64EndOfCentralDirectory::SizeOfCentralDirectory),
+		PodField(&Zip64EndOfCentralDirectory::OffsetOfCentralDirectory));
+
+	if (!reader->ReadSchema(Schema, *this))
 	{
 		nat_Throw(InvalidData, "Zip64EndOfCentralDirectory is invalid."_nv);
 	}
-
-	SizeOfThisRecord = reader->ReadPod<nuLong>();
-	VersionMadeBy = reader->ReadPod<nuShort>();
-	VersionNeededToExtract = reader->ReadPod<nuShort>();
-	NumberOfThisDisk = reader->ReadPod<nuInt>();
-	NumberOfDiskWithStartOfCD = reader->ReadPod<nuInt>();
-	NumberOfEntriesOnThisDisk = reader->ReadPod<nuLong>();
-	NumberOfEntriesTotal = reader->ReadPod<nuLong>();
-	SizeOfCentralDirectory = reader->ReadPod<nuLong>();
-	OffsetOfCentralDirectory = reader->ReadPod<nuLong>();
 }
 
 void natZipArchive::Zip64EndOfCentralDirectory::Write(natBinaryWriter* writer, nuLong numberOfEntries, nuLong startOfCentralDirectory, nuLong sizeOfCentralDirectory)
@@ -1180,7 +1980,7 @@ void natZipArchive::Zip64EndOfCentralDirectory::Write(natBinaryWriter* writer, n
 	writer->WritePod(startOfCentralDirectory);
 }
 
-void natZipArchive::internalOpen()
+void natZipArchive::internalOpen(nBool lazyLoadEntries)
 {
 	switch (m_Mode)
 	{
@@ -1188,7 +1988,14 @@ void natZipArchive::internalOpen()
 		break;
 	case ZipArchiveMode::Read:
 		readEndOfCentralDirectory();
-		readCentralDirectory();
+		if (lazyLoadEntries)
+		{
+			buildCentralDirectoryIndex();
+		}
+		else
+		{
+			readCentralDirectory();
+		}
 		break;
 	case ZipArchiveMode::Update:
 	default:
@@ -1200,14 +2007,20 @@ void natZipArchive::internalOpen()
 
 void natZipArchive::readCentralDirectory()
 {
-	m_Stream->SetPosition(NatSeek::Beg, m_Zip64EndOfCentralDirectory.OffsetOfCentralDirectory ? m_Zip64EndOfCentralDirectory.OffsetOfCentralDirectory : m_ZipEndOfCentralDirectory.OffsetOfStartOfCentralDirectoryWithRespectToTheStartingDiskNumber);
+	m_EndOfEntryData = getOffsetOfCentralDirectory();
+	m_Stream->SetPosition(NatSeek::Beg, m_EndOfEntryData);
 
 	nuLong entriesCount = 0;
 
-	CentralDirectoryFileHeader header;
 	const auto saveExtraFieldsAndComments = m_Mode == ZipArchiveMode::Update;
-	while (header.Read(m_Reader, saveExtraFieldsAndComments, m_Encoding))
+	while (true)
 	{
+		CentralDirectoryFileHeader header;
+		if (!header.Read(m_Reader, saveExtraFieldsAndComments, m_Encoding))
+		{
+			break;
+		}
+
 		auto entry = new ZipEntry(this, header);
 		auto pEntry = natRefPointer<ZipEntry>{ entry };
 		SafeRelease(entry);
@@ -1215,10 +2028,220 @@ void natZipArchive::readCentralDirectory()
 		++entriesCount;
 	}
 
-	if (entriesCount != m_ZipEndOfCentralDirectory.NumberOfEntriesInTheCentralDirectory)
+	if (entriesCount != getNumberOfEntries())
+	{
+		nat_Throw(InvalidData, "Number of entries is wrong."_nv);
+	}
+}
+
+nLen natZipArchive::getOffsetOfCentralDirectory() const noexcept
+{
+	return m_Zip64EndOfCentralDirectory.OffsetOfCentralDirectory ? m_Zip64EndOfCentralDirectory.OffsetOfCentralDirectory : m_ZipEndOfCentralDirectory.OffsetOfStartOfCentralDirectoryWithRespectToTheStartingDiskNumber;
+}
+
+nLen natZipArchive::getSizeOfCentralDirectory() const noexcept
+{
+	return m_Zip64EndOfCentralDirectory.OffsetOfCentralDirectory ? m_Zip64EndOfCentralDirectory.SizeOfCentralDirectory : m_ZipEndOfCentralDirectory.SizeOfTheCentralDirectory;
+}
+
+nuLong natZipArchive::getNumberOfEntries() const noexcept
+{
+	return m_Zip64EndOfCentralDirectory.OffsetOfCentralDirectory ? m_Zip64EndOfCentralDirectory.NumberOfEntriesTotal : m_ZipEndOfCentralDirectory.NumberOfEntriesInTheCentralDirectory;
+}
+
+namespace
+{
+	nuShort LoadLittleEndian16(ncData data) noexcept
+	{
+		return static_cast<nuShort>(data[0] | data[1] << 8);
+	}
+
+	nuInt LoadLittleEndian32(ncData data) noexcept
+	{
+		return static_cast<nuInt>(data[0]) | static_cast<nuInt>(data[1]) << 8 | static_cast<nuInt>(data[2]) << 16 | static_cast<nuInt>(data[3]) << 24;
+	}
+
+	// FNV-1a
+	nuLong HashFilename(ncData data, size_t length) noexcept
+	{
+		auto hash = 0xCBF29CE484222325ull;
+		for (size_t i = 0; i < length; ++i)
+		{
+			hash = (hash ^ data[i]) * 0x100000001B3ull;
+		}
+		return hash;
+	}
+}
+
+void natZipArchive::buildCentralDirectoryIndex()
+{
+	// Ŀ¼ļͷֵĴСиֶεƫ
+	constexpr size_t SizeOfFixedPart = 46, OffsetToFilenameLength = 28, OffsetToExtraFieldLength = 30, OffsetToFileCommentLength = 32;
+
+	const auto sizeOfCentralDirectory = getSizeOfCentralDirectory();
+	if (sizeOfCentralDirectory > std::numeric_limits<size_t>::max() || sizeOfCentralDirectory > m_Stream->GetSize())
+	{
+		nat_Throw(InvalidData, "Size of central directory is too big."_nv);
+	}
+
+	m_CentralDirectoryData.resize(static_cast<size_t>(sizeOfCentralDirectory));
+	if (!m_CentralDirectoryData.empty())
+	{
+		m_Stream->SetPosition(NatSeek::Beg, getOffsetOfCentralDirectory());
+		m_Stream->ForceReadBytes(m_CentralDirectoryData.data(), m_CentralDirectoryData.size());
+	}
+
+	// ʵʾԻ¼ĳȣಿڼʱ
+	const auto data = m_CentralDirectoryData.data();
+	const auto size = m_CentralDirectoryData.size();
+	m_CentralDirectoryIndex.reserve(static_cast<size_t>(std::min(getNumberOfEntries(), static_cast<nuLong>(size / SizeOfFixedPart))));
+	size_t offset{};
+	while (size - offset >= SizeOfFixedPart && LoadLittleEndian32(data + offset) == CentralDirectoryFileHeader::Signature)
+	{
+		const auto filenameLength = LoadLittleEndian16(data + offset + OffsetToFilenameLength);
+		const auto recordSize = SizeOfFixedPart + filenameLength + LoadLittleEndian16(data + offset + OffsetToExtraFieldLength) + LoadLittleEndian16(data + offset + OffsetToFileCommentLength);
+		if (size - offset < recordSize)
+		{
+			nat_Throw(InvalidData, "Central directory is truncated."_nv);
+		}
+
+		m_CentralDirectoryIndex.push_back({ HashFilename(data + offset + SizeOfFixedPart, filenameLength), offset });
+		offset += recordSize;
+	}
+
+	if (m_CentralDirectoryIndex.size() != getNumberOfEntries())
 	{
 		nat_Throw(InvalidData, "Number of entries is wrong."_nv);
 	}
+
+	// ɢֵͬʱĿ¼е˳ʹӳټʱĽһ
+	std::sort(m_CentralDirectoryIndex.begin(), m_CentralDirectoryIndex.end(), [](CentralDirectoryIndexItem const& a, CentralDirectoryIndexItem const& b)
+	{
+		return a.NameHash < b.NameHash || (a.NameHash == b.NameHash && a.Offset < b.Offset);
+	});
+
+	m_HasUnloadedEntries = !m_CentralDirectoryIndex.empty();
+}
+
+natRefPointer<natZipArchive::ZipEntry> natZipArchive::loadEntry(nLen offset) const
+{
+	assert(offset < m_CentralDirectoryData.size());
+
+	natBinaryReader reader{ make_ref<natExternMemoryStream>(m_CentralDirectoryData.data() + offset, m_CentralDirectoryData.size() - offset, true),
+		Environment::Endianness::LittleEndian };
+	CentralDirectoryFileHeader header;
+	if (!header.Read(&reader, false, m_Encoding))
+	{
+		nat_Throw(InvalidData, "Central directory is corrupted."_nv);
+	}
+
+	const auto iter = m_EntriesMap.find(header.Filename);
+	if (iter != m_EntriesMap.end())
+	{
+		return iter->second;
+	}
+
+	// ʵʾڳĵָԽд뼰ɾӳټؽڶȡģʽָͨ޸ĵ
+	auto entry = new ZipEntry(const_cast<natZipArchive*>(this), header);
+	auto pEntry = natRefPointer<ZipEntry>{ entry };
+	SafeRelease(entry);
+	m_EntriesMap.emplace(pEntry->m_CentralDirectoryFileHeader.Filename, pEntry);
+	return pEntry;
+}
+
+natRefPointer<natZipArchive::ZipEntry> natZipArchive::findUnloadedEntry(nStrView entryName) const
+{
+	assert(m_HasUnloadedEntries);
+
+	constexpr size_t SizeOfFixedPart = 46, OffsetToFilenameLength = 28;
+
+	// ĵıȽԭʼ
+	const auto rawName = toRawEntryName(entryName);
+	const auto filename = reinterpret_cast<ncData>(rawName.data());
+	const auto filenameLength = rawName.size();
+
+	const auto hash = HashFilename(filename, filenameLength);
+	const auto range = std::equal_range(m_CentralDirectoryIndex.cbegin(), m_CentralDirectoryIndex.cend(), CentralDirectoryIndexItem{ hash, 0 }, [](CentralDirectoryIndexItem const& a, CentralDirectoryIndexItem const& b)
+	{
+		return a.NameHash < b.NameHash;
+	});
+
+	for (auto iter = range.first; iter != range.second; ++iter)
+	{
+		const auto record = m_CentralDirectoryData.data() + iter->Offset;
+		if (LoadLittleEndian16(record + OffsetToFilenameLength) == filenameLength && std::equal(filename, filename + filenameLength, record + SizeOfFixedPart))
+		{
+			return loadEntry(iter->Offset);
+		}
+	}
+
+	return {};
+}
+
+void natZipArchive::loadAllEntries() const
+{
+	if (!m_HasUnloadedEntries)
+	{
+		return;
+	}
+
+	// Ŀ¼е˳أѼصڻᱻ
+	std::vector<nLen> offsets;
+	offsets.reserve(m_CentralDirectoryIndex.size());
+	for (auto&& item : m_CentralDirectoryIndex)
+	{
+		offsets.emplace_back(item.Offset);
+	}
+	std::sort(offsets.begin(), offsets.end());
+
+	m_EntriesMap.reserve(offsets.size());
+	for (const auto offset : offsets)
+	{
+		loadEntry(offset);
+	}
+
+	// ڶѼأҪԭʼݼ
+	m_HasUnloadedEntries = false;
+	std::vector<nByte>{}.swap(m_CentralDirectoryData);
+	std::vector<CentralDirectoryIndexItem>{}.swap(m_CentralDirectoryIndex);
+}
+
+void natZipArchive::buildDirectorySet() const
+{
+	if (m_HasDirectorySet)
+	{
+		return;
+	}
+
+	constexpr size_t SizeOfFixedPart = 46, OffsetToFilenameLength = 28;
+
+	// ʵʾɨĿ¼ԭʼݣÿ'/'֮ǰĲֶһĿ¼
+	for (auto&& item : m_CentralDirectoryIndex)
+	{
+		const auto record = m_CentralDirectoryData.data() + item.Offset;
+		const auto filename = reinterpret_cast<const char*>(record + SizeOfFixedPart);
+		const auto filenameLength = LoadLittleEndian16(record + OffsetToFilenameLength);
+		for (size_t i = 0; i < filenameLength; ++i)
+		{
+			if (filename[i] == '/' && i != 0)
+			{
+				m_DirectorySet.emplace(filename, i);
+			}
+		}
+	}
+
+	m_HasDirectorySet = true;
+}
+
+std::string natZipArchive::toRawEntryName(nStrView entryName) const
+{
+	if (m_Encoding == nString::UsingStringType)
+	{
+		return { reinterpret_cast<const char*>(entryName.data()), entryName.size() * sizeof(nString::CharType) };
+	}
+
+	const auto rawName = RuntimeEncoding<nString::UsingStringType>::Decode(entryName, m_Encoding);
+	return { reinterpret_cast<const char*>(rawName.data()), rawName.size() };
 }
 
 void natZipArchive::readEndOfCentralDirectory()
@@ -11,13 +11,18 @@
 #include "natMisc.h"
 #include "natLinq.h"
 #include "natCompressionStream.h"
+#include "natCodec.h"
+#include <unordered_set>
 
 namespace NatsuLib
 {
 	
 	////////////////////////////////////////////////////////////////////////////////
 	///	@brief	Zipѹĵ
-	///	@note	л棬ṩнл
+	///	@note	Ĭϲл棬ṩнл棬ȡģʽ¿ýѹݻ
+	///			ģʽѰַܵ׽֡׼ʽʽд룬
+	///			ڵCRC32Сд֮Уͨñ־λ3ҪʱʹZip64ʽ
+	///			ȡģʽ¸ڴ򿪵ײٽάȡλãڲͬ߳ͬʱȡ
 	////////////////////////////////////////////////////////////////////////////////
 	class natZipArchive
 		: public natRefObjImpl<natRefObj>
@@ -34,20 +39,78 @@ namespace NatsuLib
 
 		explicit natZipArchive(natRefPointer<natStream> stream, ZipArchiveMode mode = ZipArchiveMode::Read);
 		natZipArchive(natRefPointer<natStream> stream, StringType encoding, ZipArchiveMode mode = ZipArchiveMode::Read);
+		///	@brief	ĵѡӳټ
+		///	@param[in]	lazyLoadEntries	Ƿӳټڣڶȡģʽʹ
+		///	@note	ӳټʱȡһĿ¼ԭʼݲɢֵ
+		///			ڶGetEntryҵöʱŻᱻڰڵĵ
+		///			ڵļĵڲٽͬڶ߳ͬʱ
+		natZipArchive(natRefPointer<natStream> stream, StringType encoding, ZipArchiveMode mode, nBool lazyLoadEntries);
+		///	@brief	Դģʽĵʹ̳߳زѹ
+		///	@note	ڵͷźݻᱻύ̳߳ѹѹɵڰύ˳дĵĿ¼ڹرʱд
+		///			豣֤threadPoolĵǰЧҹرĵǰͷڵ
+		natZipArchive(natRefPointer<natStream> stream, natThreadPool& threadPool);
+		natZipArchive(natRefPointer<natStream> stream, StringType encoding, natThreadPool& threadPool);
 		~natZipArchive();
 
 		///	@brief	ض
 		natRefPointer<ZipEntry> CreateEntry(nStrView entryName);
 		///	@brief	
+		///	@note	ӳټʱδصڲͷӳټص޸ĵڲ״̬
+		///			عڲٽͬGetEntryڶ߳ͬʱ
 		Linq<const natRefPointer<ZipEntry>> GetEntries() const;
 		///	@brief	ض
 		///	@note	δҵ᷵nullptrضԷֵм
+		///			ӳټʱҵڣ޸ĵڲ״̬ڲٽͬڶ߳ͬʱ
 		natRefPointer<ZipEntry> GetEntry(nStrView entryName) const;
+		///	@brief	ǷλĿ¼֮µ
+		///	@param[in]	directory	Ŀ¼ĩβ'/'
+		///	@note	ֻĿ¼ӳټʱĿ¼ԭʼжϣᴴ
+		///			ӳټʱ״εûὨĵĿ¼ļϣ֮ĲҲҪ
+		nBool HasDirectory(nStrView directory) const;
+
+		///	@brief	ʹ̳߳زнѹ
+		///	@param[in]	threadPool	нѹ̳߳
+		///	@param[in]	sink		ÿڵԻдѹݵnullptrʾ
+		///	@note	ڶȡģʽʹãsink̳߳صĹ߳бãб֤̰߳ȫ
+		///			ѹɵݻУCRC32һʧʱй׳׸쳣
+		///	@return	ʵʽѹ
+		nLen ExtractAll(natThreadPool& threadPool, std::function<natRefPointer<natStream>(ZipEntry&)> sink);
+
+		///	@brief	дδдڲձ滻ɾռĿռ
+		///	@note	ڸģʽʹãҲд
+		///			ģʽ޸ĵڽ׷֮󣬾ݽֱô˷
+		///			ڵݽǰƣҪڴʱļ
+		void Compact();
+
+		///	@brief	ѹݻͳϢ
+		struct EntryCacheStatistics
+		{
+			nuLong Hits;			///< @brief	д
+			nuLong Misses;			///< @brief	δдδ
+			nuLong Evictions;		///< @brief	򳬳̭
+			size_t CachedEntries;	///< @brief	ǰ
+			size_t CachedBytes;		///< @brief	ǰݴС
+			size_t Capacity;		///< @brief	
+		};
+
+		///	@brief	ýѹݻ
+		///	@param[in]	capacity	ĽѹݵܴСޣΪ0ʱû
+		///	@note	ڶȡģʽʹãĬϲû
+		///			úʱȲһ棬ʱػڻݵֻnatExternMemoryStream
+		///			δʱѹڲУCRC32뻺棬ʱ̭ʹõڣڲᱻ
+		///			ڶ߳ͬʱʹãѷصݱ̭ȻЧ
+		void SetEntryCacheCapacity(size_t capacity);
+		///	@brief	ýѹݻͳϢ
+		EntryCacheStatistics GetEntryCacheStatistics() const;
+		///	@brief	ͷѻݣͳϢ
+		void ClearEntryCache();
 
 	private:
 		enum
 		{
 			FindingBufferSize = 32,
+			ExtractBufferSize = 64 * 1024,
+			CompactBufferSize = 64 * 1024,
 		};
 
 		enum class ZipVersionNeeded : nuShort
@@ -69,17 +132,57 @@ namespace NatsuLib
 		static constexpr nuShort Mask16Bit = 0xFFFF;
 
 		natRefPointer<natStream> m_Stream;
+		// m_StreamĶдλãɸڵ
+		std::shared_ptr<natCriticalSection> m_StreamSection;
 		natRefPointer<natBinaryReader> m_Reader;
 		natRefPointer<natBinaryWriter> m_Writer;
 
-		std::unordered_map<nStrView, natRefPointer<ZipEntry>> m_EntriesMap;
+		// ʵʾӳټʱconstGetEntryGetEntriesҲ޸m_EntriesMapµΪmutablem_EntriesSection
+		mutable natCriticalSection m_EntriesSection;
+		mutable std::unordered_map<nStrView, natRefPointer<ZipEntry>> m_EntriesMap;
+
+		// ӳټʱʹãڶѼغ󽫱ͷ
+		struct CentralDirectoryIndexItem
+		{
+			nuLong NameHash;
+			nLen Offset;	///< @brief	¼m_CentralDirectoryDataеƫ
+		};
+
+		mutable std::vector<nByte> m_CentralDirectoryData;
+		mutable std::vector<CentralDirectoryIndexItem> m_CentralDirectoryIndex;
+		mutable nBool m_HasUnloadedEntries;
+		// ӳټʱHasDirectoryĵı뱣Ŀ¼ԭʼݣĩβ'/'
+		mutable std::unordered_set<std::string> m_DirectorySet;
+		mutable nBool m_HasDirectorySet;
 
 		const StringType m_Encoding;
 		const ZipArchiveMode m_Mode;
+		nBool m_HasEntryOpeningForWrite;
+		// ģʽѰַʱm_StreamΪ¼дλõİװ
+		nBool m_StreamingOutput;
+		// ģʽݵĽβ׷ݼдĿ¼λ
+		nLen m_EndOfEntryData;
+
+		class PositionTrackingStream;
+
+		// ڶȡģʽЧ
+		class EntryCache;
+		std::unique_ptr<EntryCache> m_EntryCache;
+
+		// ڲдģʽЧ
+		struct CompressionJob;
+		natThreadPool* m_ThreadPool;
+		std::deque<std::unique_ptr<CompressionJob>> m_PendingCompressions;
 
 		void addEntry(natRefPointer<ZipEntry> entry);
 		void close();
 		void writeToFile();
+		void writeEntries();
+		void writeCentralDirectory();
+
+		void queueCompression(natRefPointer<ZipEntry> entry);
+		void writeFrontCompression();
+		void discardPendingCompressions() noexcept;
 
 		// ʵʾZipBlock뱣֤Read෽ɺгԱѳʼ
 
@@ -111,6 +214,9 @@ namespace NatsuLib
 
 			nBool ReadFromExtraField(ExtraField const& extraField, nBool readUncompressedSize, nBool readCompressedSize, nBool readLocalHeaderOffset, nBool readStartDiskNumber);
 			void Write(natBinaryWriter* writer);
+
+			// ͷܴС
+			size_t GetSize() const noexcept;
 		};
 
 		struct CentralDirectoryFileHeader
@@ -152,9 +258,11 @@ namespace NatsuLib
 
 			static nBool TrySkip(natBinaryReader* reader);
 
-			// ʵʾ޸headerеFilenameLengthΪʵдļ
+			// ʵʾ޸headerеFilenameLengthΪʵдļȣ־ʱдZip64ֶΣǷдZip64ֶ
 			static nBool Write(natBinaryWriter* writer, CentralDirectoryFileHeader& header, Optional<std::deque<ExtraField>> const& localFileHeaderFields, StringType encoding);
 			static void WriteCrcAndSizes(natBinaryWriter* writer, CentralDirectoryFileHeader const& header, nBool usedZip64);
+			// ʵʾļͷZip64ֶʱ8ֽڱʾС뱾ļͷһԱֻȡļͷĶȡȷ
+			static void WriteDataDescriptor(natBinaryWriter* writer, CentralDirectoryFileHeader const& header, nBool usedZip64);
 		};
 
 		struct ZipEndOfCentralDirectory
@@ -212,9 +320,21 @@ namespace NatsuLib
 
 		Zip64EndOfCentralDirectory m_Zip64EndOfCentralDirectory;
 
-		void internalOpen();
+		void internalOpen(nBool lazyLoadEntries);
 		void readCentralDirectory();
 		void readEndOfCentralDirectory();
+		nLen getOffsetOfCentralDirectory() const noexcept;
+		nLen getSizeOfCentralDirectory() const noexcept;
+		nuLong getNumberOfEntries() const noexcept;
+
+		void buildCentralDirectoryIndex();
+		// ʵʾ·ڳm_EntriesSectionʱ
+		natRefPointer<ZipEntry> loadEntry(nLen offset) const;
+		natRefPointer<ZipEntry> findUnloadedEntry(nStrView entryName) const;
+		void loadAllEntries() const;
+		void buildDirectorySet() const;
+		// תΪĵıʾԭʼ
+		std::string toRawEntryName(nStrView entryName) const;
 
 		void removeEntry(ZipEntry* entry);
 
@@ -238,16 +358,23 @@ namespace NatsuLib
 			///	@brief	ڲ
 			natRefPointer<natStream> Open();
 
-		private:
-			enum class CompressionMethod : nuShort
-			{
-				Stored = 0x0,
-				Deflate = 0x8,
-				Deflate64 = 0x9,
-				BZip2 = 0xC,
-				LZMA = 0xE
-			};
+			///	@brief	
+			nStrView GetName() const noexcept;
+			///	@brief	ѹĴС
+			nuLong GetCompressedLength() const noexcept;
+			///	@brief	ڽѹĴС
+			nuLong GetLength() const noexcept;
+			///	@brief	ݵCRC32
+			nuInt GetCrc32() const noexcept;
+
+			///	@brief	ݵǰѹ
+			CompressionMethod GetCompressionMethod() const noexcept;
+			///	@brief	дʱʹõѹ
+			///	@note	ĬΪDeflateѹnatCodecRegistryĬעע
+			///			ģʽڴ֮ǰãģʽ¸ıԭڵѹʹݱѹ
+			void SetCompressionMethod(CompressionMethod method);
 
+		private:
 			enum class BitFlag : nuShort
 			{
 				DataDescriptor = 0x8,
@@ -265,8 +392,10 @@ namespace NatsuLib
 
 			// д
 			natRefPointer<natStream> m_UncompressedData;
-			// ڸģʽδдʱԭļݣдģʽ
-			Optional<std::vector<nByte>> m_CachedCompressedData;
+			// ģʽڵĵǰǷλĵУԭеΪtrue޸ĵдΪtrue
+			nBool m_DataInArchive;
+			// дʱʹõѹ
+			CompressionMethod m_CompressionMethod;
 
 			ZipEntry(natZipArchive* archive, nStrView const& entryName);
 			ZipEntry(natZipArchive* archive, CentralDirectoryFileHeader const& centralDirectoryFileHeader);
@@ -279,16 +408,22 @@ namespace NatsuLib
 
 			natRefPointer<natStream> const& getUncompressedData();
 
-			natRefPointer<natStream> createCompressor(natRefPointer<natStream> stream);
+			// ʵʾδҵӦı׳쳣
+			static natRefPointer<ICodec> getCodec(CompressionMethod method);
 
-			void loadExtraFieldAndCompressedData();
+			void loadLocalHeaderFields();
+			// ȡļͷĸֶΣZip64ֶβfieldsرļͷǷZip64ֶ
+			nBool readLocalHeaderFields(std::deque<ExtraField>* fields);
+			// ñļͷݼܳ
+			nLen getLengthInArchive();
 			void writeLocalFileHeaderAndData();
 
 			class ZipEntryWriteStream final
 				: public natRefObjImpl<natStream>
 			{
 			public:
-				ZipEntryWriteStream(ZipEntry& entry, natRefPointer<natCrc32Stream> crc32Stream, std::function<void()> finishCallback = {});
+				///	@brief	ڵѹѹдݲдĵ
+				explicit ZipEntryWriteStream(ZipEntry& entry, std::function<void()> finishCallback = {});
 				~ZipEntryWriteStream();
 
 				nBool CanWrite() const override;
@@ -306,6 +441,8 @@ namespace NatsuLib
 
 			private:
 				ZipEntry& m_Entry;
+				natRefPointer<ICodec> m_Codec;
+				natRefPointer<natStream> m_Encoder;
 				natRefPointer<natCrc32Stream> m_InternalStream;
 				nLen m_InitialPosition;
 				nBool m_WroteData, m_UseZip64;
@@ -1,10 +1,31 @@
 #include "stdafx.h"
 #include "natCompressionStream.h"
+#include "natBinary.h"
+#include "natCrc32.h"
 #include <zlib.h>
 #include <zutil.h>
 
 using namespace NatsuLib;
 
+namespace
+{
+	int GetZlibCompressionLevel(natDeflateStream::CompressionLevel compressionLevel)
+	{
+		switch (compressionLevel)
+		{
+		case natDeflateStream::CompressionLevel::Optimal:
+			return Z_BEST_COMPRESSION;
+		case natDeflateStream::CompressionLevel::Fastest:
+			return Z_BEST_SPEED;
+		case natDeflateStream::CompressionLevel::NoCompression:
+			return Z_NO_COMPRESSION;
+		default:
+			assert(!"Invalid compressionLevel.");
+			nat_Throw(natErrException, NatErr_InvalidArg, "Invalid compressionLevel."_nv);
+		}
+	}
+}
+
 namespace NatsuLib
 {
 	namespace detail_
@@ -19,7 +40,7 @@ namespace NatsuLib
 			};
 
 			DeflateStreamImpl(int level, int method, int windowBits, int memLevel, int strategy)
-				: ZStream{}, Compress{ true }, InputBufferLeft{}, OutputBufferLeft{}
+				: ZStream{}, Compress{ true }, Level{ level }, WindowBits{ windowBits }, InputBufferLeft{}, OutputBufferLeft{}
 			{
 				const auto ret = deflateInit2(&ZStream, level, method, windowBits, memLevel, strategy);
 				if (ret != Z_OK)
@@ -29,7 +50,7 @@ namespace NatsuLib
 			}
 
 			explicit DeflateStreamImpl(int windowBits)
-				: ZStream{}, Compress{ false }, InputBufferLeft{}, OutputBufferLeft{}
+				: ZStream{}, Compress{ false }, Level{}, WindowBits{ windowBits }, InputBufferLeft{}, OutputBufferLeft{}
 			{
 				const auto ret = inflateInit2(&ZStream, windowBits);
 				if (ret != Z_OK)
@@ -50,6 +71,29 @@ namespace NatsuLib
 				}
 			}
 
+			///	@brief	״̬Ա㴦µݣѷڴ
+			///	@param[in]	windowBits	µĴڴСͷãѹʱԸı
+			///	@return	Ƿɹʧʱ״̬ʹ
+			nBool Reset(int windowBits) noexcept
+			{
+				assert((!Compress || windowBits == WindowBits) && "Cannot change windowBits of deflate engine.");
+
+				const auto ret = Compress ? deflateReset(&ZStream) : inflateReset2(&ZStream, windowBits);
+				if (ret != Z_OK)
+				{
+					return false;
+				}
+
+				WindowBits = windowBits;
+				ZStream.next_in = nullptr;
+				ZStream.avail_in = 0;
+				ZStream.next_out = nullptr;
+				ZStream.avail_out = 0;
+				InputBufferLeft = 0;
+				OutputBufferLeft = 0;
+				return true;
+			}
+
 			void SetInput(ncData inputBuffer, size_t bufferLength) noexcept
 			{
 				assert(ZStream.avail_in == 0 && "Some data left in previous input.");
@@ -87,6 +131,16 @@ namespace NatsuLib
 			}
 
 			int DoNext() noexcept
+			{
+				return DoNext(InputBufferLeft ? Z_NO_FLUSH : Z_FINISH);
+			}
+
+			int Flush() noexcept
+			{
+				return DoNext(Z_SYNC_FLUSH);
+			}
+
+			int DoNext(int flush) noexcept
 			{
 				constexpr auto max = std::numeric_limits<uInt>::max();
 				if (ZStream.avail_in == 0)
@@ -100,45 +154,335 @@ namespace NatsuLib
 					OutputBufferLeft -= ZStream.avail_out;
 				}
 
-				const auto flush = InputBufferLeft ? Z_NO_FLUSH : Z_FINISH;
 				return Compress ? deflate(&ZStream, flush) : inflate(&ZStream, flush);
 			}
 
-			int Flush() noexcept
+			nBool HasInput() const noexcept
 			{
-				constexpr auto max = std::numeric_limits<uInt>::max();
-				if (ZStream.avail_in == 0)
+				return ZStream.avail_in != 0 || InputBufferLeft != 0;
+			}
+
+			z_stream ZStream;
+			const nBool Compress;
+			const int Level;
+			int WindowBits;
+			size_t InputBufferLeft, OutputBufferLeft;
+			// ʵʾnatDeflateStreamײݣ״̬һ𱻸
+			std::vector<nByte> Buffer;
+		};
+	}
+}
+
+namespace
+{
+	// ѵֵʱDictionaryDmerSizeֽڵƬΪͳƵĵλDictionarySegmentSizeֽڵƬΪѡȡĵλ
+	constexpr size_t DictionaryDmerSize = 8;
+	constexpr size_t DictionarySegmentSize = 256;
+	constexpr size_t DictionaryHashLog = 20;
+
+	size_t HashDmer(ncData data) noexcept
+	{
+		nuLong value;
+		std::memcpy(&value, data, sizeof value);
+		return static_cast<size_t>((value * 0xCF1BBCDCB7A56463ull) >> (64 - DictionaryHashLog));
+	}
+}
+
+natDeflateDictionary::natDeflateDictionary(ncData data, size_t size)
+	: natDeflateDictionary(std::vector<nByte>(data, data + size))
+{
+}
+
+natDeflateDictionary::natDeflateDictionary(std::vector<nByte> data)
+	: m_Data(std::move(data)), m_Id{}
+{
+	if (m_Data.size() > std::numeric_limits<uInt>::max())
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "Dictionary is too big."_nv);
+	}
+
+	m_Id = static_cast<nuInt>(adler32(adler32(0, nullptr, 0), m_Data.data(), static_cast<uInt>(m_Data.size())));
+}
+
+natDeflateDictionary::~natDeflateDictionary()
+{
+}
+
+ncData natDeflateDictionary::GetData() const noexcept
+{
+	return m_Data.data();
+}
+
+size_t natDeflateDictionary::GetSize() const noexcept
+{
+	return m_Data.size();
+}
+
+nuInt natDeflateDictionary::GetId() const noexcept
+{
+	return m_Id;
+}
+
+natRefPointer<natDeflateDictionary> natDeflateDictionary::Train(ncData samples, std::vector<size_t> const& sampleSizes, size_t maxSize)
+{
+	static_assert(DictionaryDmerSize == sizeof(nuLong), "HashDmer assumes DictionaryDmerSize is 8.");
+
+	if (!samples && !sampleSizes.empty())
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "samples should not be nullptr."_nv);
+	}
+
+	maxSize = std::min(maxSize, static_cast<size_t>(MaxSize));
+	size_t totalSize{};
+	for (const auto size : sampleSizes)
+	{
+		totalSize += size;
+	}
+
+	// ͳƸƬγڶٸУһظֵƬζûа
+	const auto tableSize = size_t{ 1 } << DictionaryHashLog;
+	std::vector<nuInt> frequencies(tableSize), lastSample(tableSize, std::numeric_limits<nuInt>::max());
+	{
+		size_t offset{};
+		for (size_t i = 0; i < sampleSizes.size(); ++i)
+		{
+			const auto sampleEnd = offset + sampleSizes[i];
+			for (auto pos = offset; pos + DictionaryDmerSize <= sampleEnd; ++pos)
+			{
+				const auto hash = HashDmer(samples + pos);
+				if (lastSample[hash] != static_cast<nuInt>(i))
 				{
-					ZStream.avail_in = InputBufferLeft > static_cast<size_t>(max) ? max : static_cast<uInt>(InputBufferLeft);
-					InputBufferLeft -= ZStream.avail_in;
+					lastSample[hash] = static_cast<nuInt>(i);
+					++frequencies[hash];
 				}
-				if (ZStream.avail_out == 0)
+			}
+			offset = sampleEnd;
+		}
+	}
+
+	struct Segment
+	{
+		nuLong Score;
+		size_t Begin;
+	};
+
+	std::vector<Segment> segments;
+	if (totalSize >= DictionarySegmentSize && maxSize >= DictionarySegmentSize)
+	{
+		// ݷΪֵƬθͬĶΣÿѡȡ÷ߵƬ
+		const auto epochCount = std::min(maxSize / DictionarySegmentSize, totalSize / DictionarySegmentSize);
+		const auto epochSize = totalSize / epochCount;
+		constexpr auto dmersPerSegment = DictionarySegmentSize - DictionaryDmerSize + 1;
+
+		// иƬγֵĴʹظƬֻһ
+		std::vector<nuShort> windowCounts(tableSize);
+		segments.reserve(epochCount);
+
+		for (size_t epoch = 0; epoch < epochCount; ++epoch)
+		{
+			const auto epochBegin = epoch * epochSize;
+			const auto epochEnd = std::min(epochBegin + epochSize + DictionarySegmentSize - 1, totalSize);
+
+			nuLong score{}, bestScore{};
+			auto bestBegin = epochBegin;
+			auto windowBegin = epochBegin;
+			for (auto pos = epochBegin; pos + DictionaryDmerSize <= epochEnd; ++pos)
+			{
+				const auto hash = HashDmer(samples + pos);
+				if (windowCounts[hash]++ == 0)
 				{
-					ZStream.avail_out = OutputBufferLeft > static_cast<size_t>(max) ? max : static_cast<uInt>(OutputBufferLeft);
-					OutputBufferLeft -= ZStream.avail_out;
+					score += frequencies[hash];
+				}
+
+				if (pos + 1 - windowBegin > dmersPerSegment)
+				{
+					const auto oldHash = HashDmer(samples + windowBegin);
+					if (--windowCounts[oldHash] == 0)
+					{
+						score -= frequencies[oldHash];
+					}
+					++windowBegin;
 				}
 
-				return Compress ? deflate(&ZStream, Z_SYNC_FLUSH) : inflate(&ZStream, Z_SYNC_FLUSH);
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestBegin = windowBegin;
+				}
 			}
 
-			z_stream ZStream;
-			const nBool Compress;
-			size_t InputBufferLeft, OutputBufferLeft;
-		};
+			for (auto pos = windowBegin; pos + DictionaryDmerSize <= epochEnd && pos < windowBegin + dmersPerSegment; ++pos)
+			{
+				windowCounts[HashDmer(samples + pos)] = 0;
+			}
+
+			if (!bestScore)
+			{
+				continue;
+			}
+
+			// ѡȡƬβټƷ
+			const auto bestEnd = std::min(bestBegin + DictionarySegmentSize, totalSize);
+			for (auto pos = bestBegin; pos + DictionaryDmerSize <= bestEnd; ++pos)
+			{
+				frequencies[HashDmer(samples + pos)] = 0;
+			}
+
+			segments.push_back({ bestScore, bestBegin });
+		}
+	}
+
+	std::stable_sort(segments.begin(), segments.end(), [](Segment const& a, Segment const& b)
+	{
+		return a.Score < b.Score;
+	});
+
+	std::vector<nByte> dictionary;
+	dictionary.reserve(maxSize);
+	for (auto&& segment : segments)
+	{
+		const auto end = std::min(segment.Begin + DictionarySegmentSize, totalSize);
+		dictionary.insert(dictionary.end(), samples + segment.Begin, samples + end);
+	}
+
+	return make_ref<natDeflateDictionary>(std::move(dictionary));
+}
+
+natDeflateEnginePool::natDeflateEnginePool(size_t maxIdleEngines)
+	: m_MaxIdleEngines{ maxIdleEngines }
+{
+}
+
+natDeflateEnginePool::~natDeflateEnginePool()
+{
+}
+
+size_t natDeflateEnginePool::GetIdleEngineCount() const
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	return m_IdleEngines.size();
+}
+
+void natDeflateEnginePool::Clear()
+{
+	decltype(m_IdleEngines) engines;
+
+	{
+		natRefScopeGuard<natCriticalSection> guard{ m_Section };
+		engines.swap(m_IdleEngines);
+	}
+}
+
+std::unique_ptr<detail_::DeflateStreamImpl> natDeflateEnginePool::acquire(nBool compress, int level, int windowBits)
+{
+	std::unique_ptr<detail_::DeflateStreamImpl> engine;
+
+	{
+		natRefScopeGuard<natCriticalSection> guard{ m_Section };
+		// ʵʾӺǰңȸ黹״̬
+		const auto iter = std::find_if(m_IdleEngines.rbegin(), m_IdleEngines.rend(), [=](std::unique_ptr<detail_::DeflateStreamImpl> const& idleEngine)
+		{
+			return idleEngine->Compress == compress && (!compress || (idleEngine->Level == level && idleEngine->WindowBits == windowBits));
+		});
+		if (iter == m_IdleEngines.rend())
+		{
+			return nullptr;
+		}
+
+		engine = std::move(*iter);
+		m_IdleEngines.erase(std::next(iter).base());
+	}
+
+	// ѹ״̬ڹ黹ʱѾùѹ״̬Ҫı䴰
+	if (!compress && engine->WindowBits != windowBits && !engine->Reset(windowBits))
+	{
+		return nullptr;
+	}
+
+	return engine;
+}
+
+void natDeflateEnginePool::release(std::unique_ptr<detail_::DeflateStreamImpl> engine) noexcept
+{
+	if (!engine || !engine->Reset(engine->WindowBits))
+	{
+		return;
+	}
+
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	if (m_IdleEngines.size() >= m_MaxIdleEngines)
+	{
+		return;
+	}
+
+	try
+	{
+		m_IdleEngines.emplace_back(std::move(engine));
+	}
+	catch (...)
+	{
+		// ʵʾ޷ʱֱͷ
 	}
 }
 
 natDeflateStream::natDeflateStream(natRefPointer<natStream> stream, nBool useHeader)
-	: m_InternalStream{ std::move(stream) }, m_Buffer{}, m_Impl{ std::make_unique<detail_::DeflateStreamImpl>(useHeader ? detail_::DeflateStreamImpl::DefaultWindowBitsWithHeader : detail_::DeflateStreamImpl::DefaultWindowBitsWithoutHeader) }, m_WroteData{ false }
+	: natDeflateStream(std::move(stream), natRefPointer<natDeflateDictionary>{}, useHeader)
+{
+}
+
+natDeflateStream::natDeflateStream(natRefPointer<natStream> stream, CompressionLevel compressionLevel, nBool useHeader)
+	: natDeflateStream(std::move(stream), compressionLevel, natRefPointer<natDeflateDictionary>{}, useHeader)
 {
+}
+
+natDeflateStream::natDeflateStream(natRefPointer<natStream> stream, natRefPointer<natDeflateDictionary> dictionary, nBool useHeader)
+	: natDeflateStream(std::move(stream), natRefPointer<natDeflateEnginePool>{}, std::move(dictionary), useHeader)
+{
+}
+
+natDeflateStream::natDeflateStream(natRefPointer<natStream> stream, CompressionLevel compressionLevel, natRefPointer<natDeflateDictionary> dictionary, nBool useHeader)
+	: natDeflateStream(std::move(stream), compressionLevel, natRefPointer<natDeflateEnginePool>{}, std::move(dictionary), useHeader)
+{
+}
+
+natDeflateStream::natDeflateStream(natRefPointer<natStream> stream, natRefPointer<natDeflateEnginePool> pool, natRefPointer<natDeflateDictionary> dictionary, nBool useHeader, size_t bufferSize)
+	: m_InternalStream{ std::move(stream) }, m_Pool{ std::move(pool) }, m_Dictionary{ std::move(dictionary) }, m_WroteData{ false }, m_Finished{ false }
+{
+	if (!m_InternalStream)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be a valid pointer."_nv);
+	}
+
 	if (!m_InternalStream->CanRead())
 	{
 		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be readable."_nv);
 	}
+
+	if (!bufferSize)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "bufferSize should not be zero."_nv);
+	}
+
+	const auto windowBits = useHeader ? detail_::DeflateStreamImpl::DefaultWindowBitsWithHeader : detail_::DeflateStreamImpl::DefaultWindowBitsWithoutHeader;
+	if (m_Pool)
+	{
+		m_Impl = m_Pool->acquire(false, 0, windowBits);
+	}
+	if (!m_Impl)
+	{
+		m_Impl = std::make_unique<detail_::DeflateStreamImpl>(windowBits);
+	}
+	m_Impl->Buffer.resize(bufferSize);
+
+	// ʵʾͷʱȵinflateҪֵʱ
+	if (m_Dictionary && !useHeader)
+	{
+		setDictionary();
+	}
 }
 
-natDeflateStream::natDeflateStream(natRefPointer<natStream> stream, CompressionLevel compressionLevel, nBool useHeader)
-	: m_InternalStream{ std::move(stream) }, m_Buffer{}, m_WroteData{ false }
+natDeflateStream::natDeflateStream(natRefPointer<natStream> stream, CompressionLevel compressionLevel, natRefPointer<natDeflateEnginePool> pool, natRefPointer<natDeflateDictionary> dictionary, nBool useHeader, size_t bufferSize)
+	: m_InternalStream{ std::move(stream) }, m_Pool{ std::move(pool) }, m_Dictionary{ std::move(dictionary) }, m_WroteData{ false }, m_Finished{ false }
 {
 	if (!m_InternalStream)
 	{
@@ -149,32 +493,60 @@ natDeflateStream::natDeflateStream(natRefPointer<natStream> stream, CompressionL
 	{
 		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be writable."_nv);
 	}
-	
-	int compressionLevelNum;
-	switch (compressionLevel)
+
+	if (!bufferSize)
 	{
-	case CompressionLevel::Optimal:
-		compressionLevelNum = Z_BEST_COMPRESSION;
-		break;
-	case CompressionLevel::Fastest:
-		compressionLevelNum = Z_BEST_SPEED;
-		break;
-	case CompressionLevel::NoCompression:
-		compressionLevelNum = Z_NO_COMPRESSION;
-		break;
-	default:
-		assert(!"Invalid compressionLevel.");
+		nat_Throw(natErrException, NatErr_InvalidArg, "bufferSize should not be zero."_nv);
 	}
-
+	
+	const auto compressionLevelNum = GetZlibCompressionLevel(compressionLevel);
 	const auto windowBits = useHeader ? detail_::DeflateStreamImpl::DefaultWindowBitsWithHeader : detail_::DeflateStreamImpl::DefaultWindowBitsWithoutHeader;
 
-	m_Impl = std::make_unique<detail_::DeflateStreamImpl>(compressionLevelNum, Z_DEFLATED, windowBits, DEF_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+	if (m_Pool)
+	{
+		m_Impl = m_Pool->acquire(true, compressionLevelNum, windowBits);
+	}
+	if (!m_Impl)
+	{
+		m_Impl = std::make_unique<detail_::DeflateStreamImpl>(compressionLevelNum, Z_DEFLATED, windowBits, DEF_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+	}
+	m_Impl->Buffer.resize(bufferSize);
 
-	m_Impl->SetOutput(m_Buffer, sizeof m_Buffer);
+	if (m_Dictionary)
+	{
+		setDictionary();
+	}
 }
 
 natDeflateStream::~natDeflateStream()
 {
+	try
+	{
+		Finish();
+	}
+	catch (...)
+	{
+		// ʵʾʱ޷Ҫ֪ʽFinish
+	}
+
+	if (m_Pool)
+	{
+		m_Pool->release(std::move(m_Impl));
+	}
+}
+
+void natDeflateStream::Finish()
+{
+	if (!m_Impl->Compress || m_Finished)
+	{
+		return;
+	}
+
+	m_Finished = true;
+	if (m_WroteData)
+	{
+		deflateAll(Z_FINISH);
+	}
 }
 
 natRefPointer<natStream> natDeflateStream::GetUnderlyingStream() const noexcept
@@ -237,44 +609,50 @@ nLen natDeflateStream::ReadBytes(nData pData, nLen Length)
 	auto pRead = pData;
 	auto dataRemain = Length;
 
-	while (true)
+	while (dataRemain)
 	{
 		// ֮ǰδ
 		m_Impl->SetOutput(pRead, dataRemain);
-		const auto ret = m_Impl->DoNext();	// ʵʾԴ˴ܵĲִ
+		const auto ret = m_Impl->DoNext();	// ʵʾZ_BUF_ERRORʾ޷Ժ
+		if (ret == Z_NEED_DICT && m_Dictionary)
+		{
+			setDictionary();
+			continue;
+		}
+		if (ret == Z_NEED_DICT)
+		{
+			nat_Throw(InvalidData, "Data requires a preset dictionary (id is {0})."_nv, static_cast<nuInt>(m_Impl->ZStream.adler));
+		}
 		if (ret == Z_DATA_ERROR)
 		{
-			nat_Throw(InvalidData, "Invalid data with zlib message ({0})."_nv, U8StringView{ m_Impl->ZStream.msg });
+			nat_Throw(InvalidData, "Invalid data with zlib message ({0})."_nv, U8StringView{ m_Impl->ZStream.msg ? m_Impl->ZStream.msg : "" });
+		}
+		if (ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR)
+		{
+			nat_Throw(natErrException, NatErr_InternalErr, "inflate failed with code {0}."_nv, ret);
 		}
-		const auto currentReadBytes = Length - m_Impl->OutputBufferLeft - m_Impl->ZStream.avail_out;
+		const auto currentReadBytes = dataRemain - m_Impl->OutputBufferLeft - m_Impl->ZStream.avail_out;
 		assert(dataRemain >= currentReadBytes);
 		pRead += currentReadBytes;
 		dataRemain -= currentReadBytes;
 
-		if (dataRemain == 0)
+		if (ret == Z_STREAM_END || dataRemain == 0)
 		{
 			break;
 		}
 
-		if (ret == Z_STREAM_END && m_Impl->ZStream.avail_in == 0 && m_Impl->ZStream.avail_out == 0)
-		{
-			break;
-		}
+		// δʱȻѾȫ
+		assert(m_Impl->ZStream.avail_in == 0 && m_Impl->InputBufferLeft == 0);
 
-		if (m_InternalStream->IsEndOfStream())
-		{
-			break;
-		}
-		const auto readBytes = m_InternalStream->ReadBytes(m_Buffer, sizeof m_Buffer);
+		auto& buffer = m_Impl->Buffer;
+		const auto readBytes = m_InternalStream->ReadBytes(buffer.data(), buffer.size());
 		if (readBytes == 0)
 		{
 			break;
 		}
 		
-		assert(readBytes <= sizeof m_Buffer);
-
-		// ʵʾѾȫ
-		m_Impl->SetInput(m_Buffer, readBytes);
+		assert(readBytes <= buffer.size());
+		m_Impl->SetInput(buffer.data(), static_cast<size_t>(readBytes));
 	}
 
 	return Length - dataRemain;
@@ -287,69 +665,2154 @@ nLen natDeflateStream::WriteBytes(ncData pData, nLen Length)
 		nat_Throw(natErrException, NatErr_IllegalState, "Stream is not writable."_nv);
 	}
 
-	auto writtenBytes = writeAll();
+	if (m_Finished)
+	{
+		nat_Throw(natErrException, NatErr_IllegalState, "Stream has already finished."_nv);
+	}
+
+	if (!Length)
+	{
+		return 0;
+	}
+
 	m_Impl->SetInput(pData, Length);
-	writtenBytes += writeAll();
+	deflateAll(Z_NO_FLUSH);
 	m_WroteData = true;
-	return writtenBytes;
+	return Length;
 }
 
 void natDeflateStream::Flush()
 {
-	if (m_Impl->Compress && m_WroteData)
+	if (m_Impl->Compress && m_WroteData && !m_Finished)
 	{
-		writeAll();
-
-		while (true)
-		{
-			m_Impl->SetOutput(m_Buffer, sizeof m_Buffer);
-			const auto ret = m_Impl->Flush();
-			if (ret == Z_OK)
-			{
-				m_InternalStream->WriteBytes(m_Buffer, sizeof m_Buffer - m_Impl->OutputBufferLeft - m_Impl->ZStream.avail_out);
-			}
-			else
-			{
-				break; // ʵʾԴ
-			}
-		}
+		deflateAll(Z_SYNC_FLUSH);
+		m_InternalStream->Flush();
 	}
 }
 
-nLen natDeflateStream::writeAll()
+void natDeflateStream::deflateAll(int flush)
 {
 	assert(CanWrite());
 
-	nLen totalWrittenBytes{};
-	int ret;
-	while (m_Impl->ZStream.avail_in != 0)
+	auto& buffer = m_Impl->Buffer;
+	while (true)
 	{
-		do
+		m_Impl->SetOutput(buffer.data(), buffer.size());
+		const auto ret = m_Impl->DoNext(flush);
+		if (ret == Z_STREAM_ERROR || ret == Z_MEM_ERROR)
 		{
-			ret = m_Impl->DoNext();
-
-			if (ret == Z_DATA_ERROR)
-			{
-				nat_Throw(InvalidData, "Invalid data with zlib message ({0})."_nv, U8StringView{ m_Impl->ZStream.msg });
-			}
+			nat_Throw(natErrException, NatErr_InternalErr, "deflate failed with code {0}."_nv, ret);
+		}
 
-			const auto availableDataSize = DefaultBufferSize - m_Impl->OutputBufferLeft - m_Impl->ZStream.avail_out;
-			const auto currentWrittenBytes = m_InternalStream->WriteBytes(m_Buffer, availableDataSize);
-			// ʵʾǷҪ飿
+		const auto availableDataSize = buffer.size() - m_Impl->ZStream.avail_out - m_Impl->OutputBufferLeft;
+		if (availableDataSize)
+		{
+			const auto currentWrittenBytes = m_InternalStream->WriteBytes(buffer.data(), availableDataSize);
 			if (currentWrittenBytes < availableDataSize)
 			{
 				nat_Throw(natErrException, NatErr_InternalErr, "Partial data written({0}/{1} requested)."_nv, currentWrittenBytes, availableDataSize);
 			}
-			totalWrittenBytes += currentWrittenBytes;
+		}
 
-			if (ret == Z_BUF_ERROR)
+		// δ˵Ѿ벢Ҫˢ
+		if (ret == Z_STREAM_END || ret == Z_BUF_ERROR || (m_Impl->ZStream.avail_out != 0 && !m_Impl->HasInput()))
+		{
+			break;
+		}
+	}
+}
+
+void natDeflateStream::setDictionary()
+{
+	assert(m_Dictionary);
+
+	const auto data = m_Dictionary->GetData();
+	const auto size = static_cast<uInt>(m_Dictionary->GetSize());
+	const auto ret = m_Impl->Compress ? deflateSetDictionary(&m_Impl->ZStream, data, size) : inflateSetDictionary(&m_Impl->ZStream, data, size);
+	if (ret == Z_DATA_ERROR)
+	{
+		nat_Throw(InvalidData, "Preset dictionary mismatch (required id is {0} but provided id is {1})."_nv, static_cast<nuInt>(m_Impl->ZStream.adler), m_Dictionary->GetId());
+	}
+	if (ret != Z_OK)
+	{
+		nat_Throw(natErrException, NatErr_InternalErr, "Setting dictionary failed with code {0}."_nv, ret);
+	}
+}
+
+struct natParallelDeflateStream::BlockJob
+{
+	enum : size_t
+	{
+		MaxDictionarySize = 32768,
+	};
+
+	std::shared_ptr<const std::vector<nByte>> Input;
+	std::shared_ptr<const std::vector<nByte>> PreviousInput;
+	std::vector<nByte> Output;
+	nuInt Crc32;
+	nuInt Adler32;
+	int CompressionLevel;
+	nBool IsLast;
+	nBool NeedAdler32;
+	std::future<natThreadPool::WorkToken> WorkToken;
+
+	nuInt Run()
+	{
+		z_stream zStream{};
+		auto ret = deflateInit2(&zStream, CompressionLevel, Z_DEFLATED, detail_::DeflateStreamImpl::DefaultWindowBitsWithoutHeader, DEF_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+		if (ret != Z_OK)
+		{
+			nat_Throw(natErrException, NatErr_InternalErr, "deflateInit2 failed with code {0}."_nv, ret);
+		}
+		const auto scope = make_scope([&zStream]
+		{
+			deflateEnd(&zStream);
+		});
+
+		// ǰһĩβΪֵ䣬ʹ֮ظܱ
+		if (PreviousInput && !PreviousInput->empty())
+		{
+			const auto dictionarySize = std::min(PreviousInput->size(), size_t{ MaxDictionarySize });
+			ret = deflateSetDictionary(&zStream, PreviousInput->data() + PreviousInput->size() - dictionarySize, static_cast<uInt>(dictionarySize));
+			if (ret != Z_OK)
+			{
+				nat_Throw(natErrException, NatErr_InternalErr, "deflateSetDictionary failed with code {0}."_nv, ret);
+			}
+		}
+
+		const auto& input = *Input;
+		// ʵʾͬˢ½׷һյĴ洢飬deflateBoundĻϱĿռ
+		Output.resize(deflateBound(&zStream, static_cast<uLong>(input.size())) + 16);
+
+		zStream.next_in = const_cast<z_const Bytef*>(input.data());
+		zStream.avail_in = static_cast<uInt>(input.size());
+		zStream.next_out = Output.data();
+		zStream.avail_out = static_cast<uInt>(Output.size());
+
+		// һͬˢ½Աֽ֤ڱ߽ϽӶֱƴ
+		const auto flush = IsLast ? Z_FINISH : Z_SYNC_FLUSH;
+		while (true)
+		{
+			ret = deflate(&zStream, flush);
+			if (ret == Z_STREAM_ERROR)
+			{
+				nat_Throw(natErrException, NatErr_InternalErr, "deflate failed with code {0}."_nv, ret);
+			}
+			if (zStream.avail_out != 0 && (IsLast ? ret == Z_STREAM_END : zStream.avail_in == 0))
+			{
+				break;
+			}
+
+			const auto usedSize = Output.size() - zStream.avail_out;
+			Output.resize(Output.size() * 2);
+			zStream.next_out = Output.data() + usedSize;
+			zStream.avail_out = static_cast<uInt>(Output.size() - usedSize);
+		}
+		Output.resize(Output.size() - zStream.avail_out);
+
+		Crc32 = NatsuLib::Crc32::Update(0, input.data(), input.size());
+		if (NeedAdler32)
+		{
+			Adler32 = static_cast<nuInt>(adler32_z(1, input.data(), input.size()));
+		}
+
+		return 0;
+	}
+};
+
+natParallelDeflateStream::natParallelDeflateStream(natRefPointer<natStream> stream, natThreadPool& threadPool, natDeflateStream::CompressionLevel compressionLevel, HeaderType headerType, size_t blockSize, size_t maxPendingBlocks)
+	: m_InternalStream{ std::move(stream) }, m_ThreadPool(threadPool), m_CompressionLevel{ GetZlibCompressionLevel(compressionLevel) }, m_HeaderType{ headerType },
+	m_BlockSize{ blockSize }, m_MaxPendingBlocks{ std::max(maxPendingBlocks, size_t{ 1 }) },
+	m_Crc32{}, m_Adler32{ 1 }, m_TotalIn{}, m_TotalOut{}, m_Finished{ false }
+{
+	if (!m_InternalStream)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be a valid pointer."_nv);
+	}
+
+	if (!m_InternalStream->CanWrite())
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be writable."_nv);
+	}
+
+	if (!m_BlockSize || m_BlockSize > std::numeric_limits<uInt>::max() / 2)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "blockSize is out of range."_nv);
+	}
+
+	m_CurrentBlock = std::make_shared<std::vector<nByte>>();
+	m_CurrentBlock->reserve(m_BlockSize);
+
+	writeHeader();
+}
+
+natParallelDeflateStream::~natParallelDeflateStream()
+{
+	if (m_Finished)
+	{
+		return;
+	}
+
+	try
+	{
+		Finish();
+	}
+	catch (...)
+	{
+		// ޷Ҫ֪ʽFinish
+		discardPendingBlocks();
+	}
+}
+
+natRefPointer<natStream> natParallelDeflateStream::GetUnderlyingStream() const noexcept
+{
+	return m_InternalStream;
+}
+
+nuInt natParallelDeflateStream::GetCrc32() const noexcept
+{
+	return m_Crc32;
+}
+
+nLen natParallelDeflateStream::GetCompressedSize() const noexcept
+{
+	return m_TotalOut;
+}
+
+void natParallelDeflateStream::Finish()
+{
+	if (m_Finished)
+	{
+		return;
+	}
+
+	submitBlock(true);
+	while (!m_PendingJobs.empty())
+	{
+		writeFrontBlock();
+	}
+	writeTrailer();
+	m_Finished = true;
+}
+
+nBool natParallelDeflateStream::CanWrite() const
+{
+	return !m_Finished;
+}
+
+nBool natParallelDeflateStream::CanRead() const
+{
+	return false;
+}
+
+nBool natParallelDeflateStream::CanResize() const
+{
+	return false;
+}
+
+nBool natParallelDeflateStream::CanSeek() const
+{
+	return false;
+}
+
+nBool natParallelDeflateStream::IsEndOfStream() const
+{
+	return m_Finished;
+}
+
+nLen natParallelDeflateStream::GetSize() const
+{
+	nat_Throw(natErrException, NatErr_NotSupport, "This type of stream does not support GetSize."_nv);
+}
+
+void natParallelDeflateStream::SetSize(nLen)
+{
+	nat_Throw(natErrException, NatErr_NotSupport, "This type of stream does not support SetSize."_nv);
+}
+
+nLen natParallelDeflateStream::GetPosition() const
+{
+	return m_TotalIn;
+}
+
+void natParallelDeflateStream::SetPosition(NatSeek, nLong)
+{
+	nat_Throw(natErrException, NatErr_NotSupport, "This type of stream does not support SetPosition."_nv);
+}
+
+nLen natParallelDeflateStream::ReadBytes(nData, nLen)
+{
+	nat_Throw(natErrException, NatErr_NotSupport, "This type of stream does not support ReadBytes."_nv);
+}
+
+nLen natParallelDeflateStream::WriteBytes(ncData pData, nLen Length)
+{
+	if (m_Finished)
+	{
+		nat_Throw(natErrException, NatErr_IllegalState, "Stream has already finished."_nv);
+	}
+
+	auto remainedLength = Length;
+	while (remainedLength)
+	{
+		// ʵʾиʱύĿ飬Ա֤һ鲻Ϊ
+		if (m_CurrentBlock->size() == m_BlockSize)
+		{
+			submitBlock(false);
+		}
+
+		const auto currentLength = static_cast<size_t>(std::min(remainedLength, static_cast<nLen>(m_BlockSize - m_CurrentBlock->size())));
+		m_CurrentBlock->insert(m_CurrentBlock->end(), pData, pData + currentLength);
+		pData += currentLength;
+		remainedLength -= currentLength;
+	}
+
+	m_TotalIn += Length;
+	return Length;
+}
+
+void natParallelDeflateStream::Flush()
+{
+	if (m_Finished)
+	{
+		m_InternalStream->Flush();
+		return;
+	}
+
+	if (!m_CurrentBlock->empty())
+	{
+		submitBlock(false);
+	}
+
+	while (!m_PendingJobs.empty())
+	{
+		writeFrontBlock();
+	}
+
+	m_InternalStream->Flush();
+}
+
+void natParallelDeflateStream::submitBlock(nBool isLast)
+{
+	while (m_PendingJobs.size() >= m_MaxPendingBlocks)
+	{
+		writeFrontBlock();
+	}
+
+	auto job = std::make_unique<BlockJob>();
+	job->Input = m_CurrentBlock;
+	job->PreviousInput = std::move(m_PreviousBlock);
+	job->Crc32 = 0;
+	job->Adler32 = 1;
+	job->CompressionLevel = m_CompressionLevel;
+	job->IsLast = isLast;
+	job->NeedAdler32 = m_HeaderType == HeaderType::Zlib;
+
+	m_PreviousBlock = std::move(m_CurrentBlock);
+	m_CurrentBlock = std::make_shared<std::vector<nByte>>();
+	if (!isLast)
+	{
+		m_CurrentBlock->reserve(m_BlockSize);
+	}
+
+	job->WorkToken = m_ThreadPool.QueueWork([](void* param)
+	{
+		return static_cast<BlockJob*>(param)->Run();
+	}, job.get());
+	m_PendingJobs.emplace_back(std::move(job));
+}
+
+void natParallelDeflateStream::writeFrontBlock()
+{
+	assert(!m_PendingJobs.empty());
+
+	const auto job = std::move(m_PendingJobs.front());
+	m_PendingJobs.pop_front();
+
+	try
+	{
+		// ʵʾѹʱ쳣ڴ˴׳
+		job->WorkToken.get().GetResult().get();
+	}
+	catch (...)
+	{
+		discardPendingBlocks();
+		throw;
+	}
+
+	writeRaw(job->Output.data(), job->Output.size());
+
+	const auto inputSize = static_cast<z_off_t>(job->Input->size());
+	m_Crc32 = Crc32::Combine(m_Crc32, job->Crc32, inputSize);
+	if (job->NeedAdler32)
+	{
+		m_Adler32 = static_cast<nuInt>(adler32_combine(m_Adler32, job->Adler32, inputSize));
+	}
+}
+
+void natParallelDeflateStream::discardPendingBlocks() noexcept
+{
+	// ߳ʹÿݣҪȴɺͷ
+	for (auto&& job : m_PendingJobs)
+	{
+		try
+		{
+			job->WorkToken.get().GetResult().wait();
+		}
+		catch (...)
+		{
+		}
+	}
+	m_PendingJobs.clear();
+	m_Finished = true;
+}
+
+void natParallelDeflateStream::writeRaw(ncData data, size_t length)
+{
+	const auto writtenBytes = m_InternalStream->WriteBytes(data, length);
+	if (writtenBytes < length)
+	{
+		nat_Throw(natErrException, NatErr_InternalErr, "Partial data written({0}/{1} requested)."_nv, writtenBytes, length);
+	}
+	m_TotalOut += writtenBytes;
+}
+
+void natParallelDeflateStream::writeHeader()
+{
+	switch (m_HeaderType)
+	{
+	case HeaderType::Zlib:
+	{
+		// CMFdeflate32KڣFLGѹȼʾFCHECKʹͷΪ31ı
+		const nByte cmf = 0x78;
+		const nByte levelFlag = m_CompressionLevel == Z_BEST_COMPRESSION ? 3 : m_CompressionLevel == Z_BEST_SPEED || m_CompressionLevel == Z_NO_COMPRESSION ? 0 : 2;
+		auto flg = static_cast<nByte>(levelFlag << 6);
+		flg += static_cast<nByte>(31 - (cmf * 256 + flg) % 31);
+		const nByte header[] = { cmf, flg };
+		writeRaw(header, sizeof header);
+		break;
+	}
+	case HeaderType::Gzip:
+	{
+		const nByte extraFlags = m_CompressionLevel == Z_BEST_COMPRESSION ? 2 : m_CompressionLevel == Z_BEST_SPEED ? 4 : 0;
+		// ID1 ID2 CM FLG MTIME(4) XFL OS(δ֪)
+		const nByte header[] = { 0x1F, 0x8B, 8, 0, 0, 0, 0, 0, extraFlags, 255 };
+		writeRaw(header, sizeof header);
+		break;
+	}
+	case HeaderType::Raw:
+	default:
+		break;
+	}
+}
+
+void natParallelDeflateStream::writeTrailer()
+{
+	switch (m_HeaderType)
+	{
+	case HeaderType::Zlib:
+	{
+		const nByte trailer[] = {
+			static_cast<nByte>(m_Adler32 >> 24), static_cast<nByte>(m_Adler32 >> 16), static_cast<nByte>(m_Adler32 >> 8), static_cast<nByte>(m_Adler32)
+		};
+		writeRaw(trailer, sizeof trailer);
+		break;
+	}
+	case HeaderType::Gzip:
+	{
+		const auto size = static_cast<nuInt>(m_TotalIn);
+		const nByte trailer[] = {
+			static_cast<nByte>(m_Crc32), static_cast<nByte>(m_Crc32 >> 8), static_cast<nByte>(m_Crc32 >> 16), static_cast<nByte>(m_Crc32 >> 24),
+			static_cast<nByte>(size), static_cast<nByte>(size >> 8), static_cast<nByte>(size >> 16), static_cast<nByte>(size >> 24)
+		};
+		writeRaw(trailer, sizeof trailer);
+		break;
+	}
+	case HeaderType::Raw:
+	default:
+		break;
+	}
+}
+
+namespace
+{
+	// βĸʽС򣩣δѹС(8) ѹݴС(8) С(4) CRC32(4) ʶ(4)
+	constexpr size_t SeekableDeflateFooterSize = 28;
+	constexpr nuInt SeekableDeflateMagic = 0x4944534E;	// "NSDI"
+
+	void StoreLittleEndian(nData out, nuLong value, size_t size) noexcept
+	{
+		for (size_t i = 0; i < size; ++i)
+		{
+			out[i] = static_cast<nByte>(value >> (8 * i));
+		}
+	}
+
+	nuLong LoadLittleEndian(ncData data, size_t size) noexcept
+	{
+		nuLong value{};
+		for (size_t i = 0; i < size; ++i)
+		{
+			value |= static_cast<nuLong>(data[i]) << (8 * i);
+		}
+		return value;
+	}
+}
+
+natSeekableDeflateStream::natSeekableDeflateStream(natRefPointer<natStream> stream)
+	: m_InternalStream{ std::move(stream) }, m_CheckpointInterval{}, m_Buffer{}, m_BaseOffset{}, m_UncompressedSize{}, m_CompressedSize{}, m_Position{}, m_CompressedPosition{}, m_Finished{ false }
+{
+	if (!m_InternalStream)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be a valid pointer."_nv);
+	}
+
+	if (!m_InternalStream->CanRead() || !m_InternalStream->CanSeek())
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be readable and seekable."_nv);
+	}
+
+	m_Impl = std::make_unique<detail_::DeflateStreamImpl>(detail_::DeflateStreamImpl::DefaultWindowBitsWithoutHeader);
+	readIndex();
+	resetToCheckpoint(m_Checkpoints.front());
+}
+
+natSeekableDeflateStream::natSeekableDeflateStream(natRefPointer<natStream> stream, natDeflateStream::CompressionLevel compressionLevel, size_t checkpointInterval)
+	: m_InternalStream{ std::move(stream) }, m_CheckpointInterval{ checkpointInterval }, m_Buffer{}, m_BaseOffset{}, m_UncompressedSize{}, m_CompressedSize{}, m_Position{}, m_CompressedPosition{}, m_Finished{ false }
+{
+	if (!m_InternalStream)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be a valid pointer."_nv);
+	}
+
+	if (!m_InternalStream->CanWrite())
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be writable."_nv);
+	}
+
+	if (!m_CheckpointInterval)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "checkpointInterval should not be zero."_nv);
+	}
+
+	m_Impl = std::make_unique<detail_::DeflateStreamImpl>(GetZlibCompressionLevel(compressionLevel), Z_DEFLATED, detail_::DeflateStreamImpl::DefaultWindowBitsWithoutHeader, DEF_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+	m_Checkpoints.push_back({ 0, 0 });
+}
+
+natSeekableDeflateStream::~natSeekableDeflateStream()
+{
+	try
+	{
+		Finish();
+	}
+	catch (...)
+	{
+		// ʵʾʱ޷Ҫ֪ʽFinish
+	}
+}
+
+natRefPointer<natStream> natSeekableDeflateStream::GetUnderlyingStream() const noexcept
+{
+	return m_InternalStream;
+}
+
+size_t natSeekableDeflateStream::GetCheckpointCount() const noexcept
+{
+	return m_Checkpoints.size();
+}
+
+void natSeekableDeflateStream::Finish()
+{
+	if (!m_Impl->Compress || m_Finished)
+	{
+		return;
+	}
+
+	m_Finished = true;
+	deflateAll(Z_FINISH);
+	writeIndex();
+}
+
+nBool natSeekableDeflateStream::CanWrite() const
+{
+	return m_Impl->Compress && !m_Finished;
+}
+
+nBool natSeekableDeflateStream::CanRead() const
+{
+	return !m_Impl->Compress;
+}
+
+nBool natSeekableDeflateStream::CanResize() const
+{
+	return false;
+}
+
+nBool natSeekableDeflateStream::CanSeek() const
+{
+	return !m_Impl->Compress;
+}
+
+nBool natSeekableDeflateStream::IsEndOfStream() const
+{
+	return m_Impl->Compress ? m_Finished : m_Position >= m_UncompressedSize;
+}
+
+nLen natSeekableDeflateStream::GetSize() const
+{
+	return m_UncompressedSize;
+}
+
+void natSeekableDeflateStream::SetSize(nLen)
+{
+	nat_Throw(natErrException, NatErr_NotSupport, "This type of stream does not support SetSize."_nv);
+}
+
+nLen natSeekableDeflateStream::GetPosition() const
+{
+	return m_Position;
+}
+
+void natSeekableDeflateStream::SetPosition(NatSeek Origin, nLong Offset)
+{
+	if (!CanSeek())
+	{
+		nat_Throw(natErrException, NatErr_NotSupport, "Stream is not seekable."_nv);
+	}
+
+	nLong position{};
+	switch (Origin)
+	{
+	case NatSeek::Beg:
+		position = Offset;
+		break;
+	case NatSeek::Cur:
+		position = static_cast<nLong>(m_Position) + Offset;
+		break;
+	case NatSeek::End:
+		position = static_cast<nLong>(m_UncompressedSize) + Offset;
+		break;
+	default:
+		assert(!"Invalid Origin.");
+	}
+
+	if (position < 0 || static_cast<nLen>(position) > m_UncompressedSize)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "Out of range."_nv);
+	}
+
+	const auto target = static_cast<nLen>(position);
+	const auto checkpoint = std::prev(std::upper_bound(m_Checkpoints.cbegin(), m_Checkpoints.cend(), target, [](nLen value, Checkpoint const& cp)
+	{
+		return value < cp.UncompressedOffset;
+	}));
+
+	// Ŀλڵǰλ֮뵱ǰλ֮ûмʱֱѹӼ㿪ʼѹ
+	if (target < m_Position || checkpoint->UncompressedOffset > m_Position)
+	{
+		resetToCheckpoint(*checkpoint);
+	}
+
+	nByte discardBuffer[BufferSize];
+	while (m_Position < target)
+	{
+		inflateBytes(discardBuffer, std::min(target - m_Position, nLen{ BufferSize }));
+	}
+}
+
+nLen natSeekableDeflateStream::ReadBytes(nData pData, nLen Length)
+{
+	if (!CanRead())
+	{
+		nat_Throw(natErrException, NatErr_IllegalState, "Stream is not readable."_nv);
+	}
+
+	return inflateBytes(pData, Length);
+}
+
+nLen natSeekableDeflateStream::WriteBytes(ncData pData, nLen Length)
+{
+	if (!m_Impl->Compress)
+	{
+		nat_Throw(natErrException, NatErr_IllegalState, "Stream is not writable."_nv);
+	}
+
+	if (m_Finished)
+	{
+		nat_Throw(natErrException, NatErr_IllegalState, "Stream has already finished."_nv);
+	}
+
+	auto remainedLength = Length;
+	while (remainedLength)
+	{
+		// ʵʾиʱü㣬Ա֤һ֮
+		if (m_Position - m_Checkpoints.back().UncompressedOffset == m_CheckpointInterval)
+		{
+			deflateAll(Z_FULL_FLUSH);
+			m_Checkpoints.push_back({ m_Position, m_CompressedSize });
+		}
+
+		const auto currentLength = std::min(remainedLength, static_cast<nLen>(m_CheckpointInterval - (m_Position - m_Checkpoints.back().UncompressedOffset)));
+		m_Impl->SetInput(pData, static_cast<size_t>(currentLength));
+		deflateAll(Z_NO_FLUSH);
+
+		pData += currentLength;
+		remainedLength -= currentLength;
+		m_Position += currentLength;
+	}
+
+	m_UncompressedSize = m_Position;
+	return Length;
+}
+
+void natSeekableDeflateStream::Flush()
+{
+	if (m_Impl->Compress && !m_Finished)
+	{
+		deflateAll(Z_SYNC_FLUSH);
+		m_InternalStream->Flush();
+	}
+}
+
+void natSeekableDeflateStream::readIndex()
+{
+	const auto totalSize = m_InternalStream->GetSize();
+	if (totalSize < SeekableDeflateFooterSize)
+	{
+		nat_Throw(InvalidData, "Stream is too small to contain an index."_nv);
+	}
+
+	nByte footer[SeekableDeflateFooterSize];
+	m_InternalStream->SetPosition(NatSeek::Beg, static_cast<nLong>(totalSize - SeekableDeflateFooterSize));
+	m_InternalStream->ForceReadBytes(footer, sizeof footer);
+
+	if (LoadLittleEndian(footer + 24, 4) != SeekableDeflateMagic)
+	{
+		nat_Throw(InvalidData, "Index footer not found."_nv);
+	}
+
+	m_UncompressedSize = LoadLittleEndian(footer, 8);
+	m_CompressedSize = LoadLittleEndian(footer + 8, 8);
+	const auto indexSize = static_cast<size_t>(LoadLittleEndian(footer + 16, 4));
+	const auto indexCrc32 = static_cast<nuInt>(LoadLittleEndian(footer + 20, 4));
+
+	const auto dataSize = totalSize - SeekableDeflateFooterSize;
+	if (indexSize > dataSize || m_CompressedSize > dataSize - indexSize)
+	{
+		nat_Throw(InvalidData, "Size recorded in index footer is out of range."_nv);
+	}
+	m_BaseOffset = dataSize - indexSize - m_CompressedSize;
+
+	std::vector<nByte> index(indexSize);
+	if (indexSize)
+	{
+		m_InternalStream->SetPosition(NatSeek::Beg, static_cast<nLong>(m_BaseOffset + m_CompressedSize));
+		m_InternalStream->ForceReadBytes(index.data(), index.size());
+	}
+	if (Crc32::Update(0, index.data(), index.size()) != indexCrc32)
+	{
+		nat_Throw(InvalidData, "Index is corrupted."_nv);
+	}
+
+	// δųͷǰһδѹѹƫ֮
+	m_Checkpoints.assign(1, { 0, 0 });
+	auto cur = static_cast<ncData>(index.data());
+	const auto end = cur + index.size();
+	while (cur != end)
+	{
+		nuLong uncompressedDelta, compressedDelta;
+		if (!detail_::DecodeVarint(cur, end, uncompressedDelta) || !detail_::DecodeVarint(cur, end, compressedDelta) || !uncompressedDelta)
+		{
+			nat_Throw(InvalidData, "Index is corrupted."_nv);
+		}
+
+		const auto& last = m_Checkpoints.back();
+		if (uncompressedDelta >= m_UncompressedSize - last.UncompressedOffset || compressedDelta > m_CompressedSize - last.CompressedOffset)
+		{
+			nat_Throw(InvalidData, "Checkpoint is out of range."_nv);
+		}
+		m_Checkpoints.push_back({ last.UncompressedOffset + uncompressedDelta, last.CompressedOffset + compressedDelta });
+	}
+}
+
+void natSeekableDeflateStream::writeIndex()
+{
+	std::vector<nByte> index;
+	index.reserve((m_Checkpoints.size() - 1) * 2 * detail_::MaxVarintSize);
+	for (size_t i = 1; i < m_Checkpoints.size(); ++i)
+	{
+		nByte buffer[detail_::MaxVarintSize * 2];
+		auto length = detail_::EncodeVarint(m_Checkpoints[i].UncompressedOffset - m_Checkpoints[i - 1].UncompressedOffset, buffer);
+		length += detail_::EncodeVarint(m_Checkpoints[i].CompressedOffset - m_Checkpoints[i - 1].CompressedOffset, buffer + length);
+		index.insert(index.end(), buffer, buffer + length);
+	}
+
+	if (index.size() > std::numeric_limits<nuInt>::max())
+	{
+		nat_Throw(natErrException, NatErr_OutOfRange, "Index is too big."_nv);
+	}
+
+	nByte footer[SeekableDeflateFooterSize];
+	StoreLittleEndian(footer, m_UncompressedSize, 8);
+	StoreLittleEndian(footer + 8, m_CompressedSize, 8);
+	StoreLittleEndian(footer + 16, index.size(), 4);
+	StoreLittleEndian(footer + 20, Crc32::Update(0, index.data(), index.size()), 4);
+	StoreLittleEndian(footer + 24, SeekableDeflateMagic, 4);
+
+	writeRaw(index.data(), index.size());
+	writeRaw(footer, sizeof footer);
+}
+
+void natSeekableDeflateStream::deflateAll(int flush)
+{
+	while (true)
+	{
+		m_Impl->SetOutput(m_Buffer, sizeof m_Buffer);
+		const auto ret = m_Impl->DoNext(flush);
+		if (ret == Z_STREAM_ERROR || ret == Z_MEM_ERROR)
+		{
+			nat_Throw(natErrException, NatErr_InternalErr, "deflate failed with code {0}."_nv, ret);
+		}
+
+		const auto availableDataSize = sizeof m_Buffer - m_Impl->ZStream.avail_out;
+		writeRaw(m_Buffer, availableDataSize);
+		m_CompressedSize += availableDataSize;
+
+		// δ˵Ѿ벢Ҫˢ
+		if (ret == Z_STREAM_END || ret == Z_BUF_ERROR || (m_Impl->ZStream.avail_out != 0 && !m_Impl->HasInput()))
+		{
+			break;
+		}
+	}
+}
+
+void natSeekableDeflateStream::writeRaw(ncData data, size_t length)
+{
+	if (!length)
+	{
+		return;
+	}
+
+	const auto writtenBytes = m_InternalStream->WriteBytes(data, length);
+	if (writtenBytes < length)
+	{
+		nat_Throw(natErrException, NatErr_InternalErr, "Partial data written({0}/{1} requested)."_nv, writtenBytes, length);
+	}
+}
+
+void natSeekableDeflateStream::resetToCheckpoint(Checkpoint const& checkpoint)
+{
+	const auto ret = inflateReset(&m_Impl->ZStream);
+	if (ret != Z_OK)
+	{
+		nat_Throw(natErrException, NatErr_InternalErr, "inflateReset failed with code {0}."_nv, ret);
+	}
+
+	m_Impl->ZStream.avail_in = 0;
+	m_Impl->InputBufferLeft = 0;
+	m_InternalStream->SetPosition(NatSeek::Beg, static_cast<nLong>(m_BaseOffset + checkpoint.CompressedOffset));
+	m_Position = checkpoint.UncompressedOffset;
+	m_CompressedPosition = checkpoint.CompressedOffset;
+}
+
+nLen natSeekableDeflateStream::inflateBytes(nData pData, nLen Length)
+{
+	Length = std::min(Length, m_UncompressedSize - m_Position);
+
+	auto pRead = pData;
+	auto dataRemain = Length;
+	while (dataRemain)
+	{
+		m_Impl->SetOutput(pRead, static_cast<size_t>(dataRemain));
+		const auto ret = m_Impl->DoNext(Z_NO_FLUSH);	// ʵʾZ_BUF_ERRORʾ޷Ժ
+		if (ret == Z_DATA_ERROR || ret == Z_NEED_DICT)
+		{
+			nat_Throw(InvalidData, "Invalid data with zlib message ({0})."_nv, U8StringView{ m_Impl->ZStream.msg ? m_Impl->ZStream.msg : "" });
+		}
+		if (ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR)
+		{
+			nat_Throw(natErrException, NatErr_InternalErr, "inflate failed with code {0}."_nv, ret);
+		}
+		const auto currentReadBytes = dataRemain - m_Impl->OutputBufferLeft - m_Impl->ZStream.avail_out;
+		assert(dataRemain >= currentReadBytes);
+		pRead += currentReadBytes;
+		dataRemain -= currentReadBytes;
+
+		if (!dataRemain)
+		{
+			break;
+		}
+
+		// δʱȻѾȫʱ޸ѹ˵
+		assert(m_Impl->ZStream.avail_in == 0 && m_Impl->InputBufferLeft == 0);
+		const auto compressedRemain = m_CompressedSize - m_CompressedPosition;
+		if (ret == Z_STREAM_END || !compressedRemain)
+		{
+			nat_Throw(InvalidData, "Compressed data ends before the size recorded in index."_nv);
+		}
+
+		const auto readBytes = m_InternalStream->ReadBytes(m_Buffer, std::min(compressedRemain, nLen{ sizeof m_Buffer }));
+		if (!readBytes)
+		{
+			nat_Throw(InvalidData, "Unexpected end of stream."_nv);
+		}
+
+		m_CompressedPosition += readBytes;
+		m_Impl->SetInput(m_Buffer, static_cast<size_t>(readBytes));
+	}
+
+	m_Position += Length;
+	return Length;
+}
+
+namespace
+{
+	// Gzipͷı־λ
+	constexpr nByte GzipFlagHeaderCrc = 0x02;
+	constexpr nByte GzipFlagExtra = 0x04;
+	constexpr nByte GzipFlagName = 0x08;
+	constexpr nByte GzipFlagComment = 0x10;
+	constexpr nByte GzipFlagReserved = 0xE0;
+
+	// BCֶεͷС̶ͷ(10) XLEN(2) ֶ(6)
+	constexpr size_t BgzfHeaderSize = 18;
+	constexpr size_t GzipTrailerSize = 8;
+	constexpr size_t MaxBgzfBlockSize = 65536;
+	// deflateѹԼΪ1032:1ھܾԴISIZE
+	constexpr nuLong MaxDeflateRatio = 1032;
+}
+
+struct natGzipStream::MemberJob
+{
+	// Աͷ֮ȫݣѹݼβ
+	std::vector<nByte> Input;
+	std::vector<nByte> Output;
+	std::future<natThreadPool::WorkToken> WorkToken;
+
+	nuInt Run()
+	{
+		if (Input.size() < GzipTrailerSize)
+		{
+			nat_Throw(InvalidData, "Gzip member is too small."_nv);
+		}
+
+		const auto compressedSize = Input.size() - GzipTrailerSize;
+		const auto expectedCrc32 = static_cast<nuInt>(LoadLittleEndian(Input.data() + compressedSize, 4));
+		const auto expectedSize = static_cast<nuInt>(LoadLittleEndian(Input.data() + compressedSize + 4, 4));
+		if (expectedSize > compressedSize * MaxDeflateRatio + 64)
+		{
+			nat_Throw(InvalidData, "Gzip member has an invalid size ({0})."_nv, expectedSize);
+		}
+
+		z_stream zStream{};
+		const auto ret = inflateInit2(&zStream, detail_::DeflateStreamImpl::DefaultWindowBitsWithoutHeader);
+		if (ret != Z_OK)
+		{
+			nat_Throw(natErrException, NatErr_InternalErr, "inflateInit2 failed with code {0}."_nv, ret);
+		}
+		const auto scope = make_scope([&zStream]
+		{
+			inflateEnd(&zStream);
+		});
+
+		// ʵʾzlibܿյָ룬ճԱʱʹһЧĻ
+		nByte dummy;
+		Output.resize(expectedSize);
+		zStream.next_in = Input.data();
+		zStream.avail_in = static_cast<uInt>(compressedSize);
+		zStream.next_out = Output.empty() ? &dummy : Output.data();
+		zStream.avail_out = static_cast<uInt>(Output.size());
+
+		const auto result = inflate(&zStream, Z_FINISH);
+		if (result == Z_DATA_ERROR)
+		{
+			nat_Throw(InvalidData, "Invalid data with zlib message ({0})."_nv, U8StringView{ zStream.msg ? zStream.msg : "" });
+		}
+		if (result != Z_STREAM_END || zStream.avail_out != 0)
+		{
+			nat_Throw(InvalidData, "Gzip member size mismatch (expected {0})."_nv, expectedSize);
+		}
+		if (zStream.avail_in != 0)
+		{
+			nat_Throw(InvalidData, "Unexpected data after compressed data of gzip member."_nv);
+		}
+
+		const auto crc32 = Crc32::Update(0, Output.data(), Output.size());
+		if (crc32 != expectedCrc32)
+		{
+			nat_Throw(InvalidData, "Gzip member CRC32 mismatch (expected {0} but got {1})."_nv, expectedCrc32, crc32);
+		}
+
+		return 0;
+	}
+};
+
+natGzipStream::natGzipStream(natRefPointer<natStream> stream)
+	: m_InternalStream{ std::move(stream) }, m_ThreadPool{}, m_MaxPendingMembers{}, m_MemberSize{},
+	m_Buffer(DefaultBufferSize), m_BufferPosition{}, m_BufferSize{}, m_MemberPosition{}, m_Crc32{}, m_MemberUncompressedSize{},
+	m_NextMemberBlockSize{}, m_NextMemberHeaderSize{}, m_Position{}, m_MemberCount{}, m_HasNextMember{ false }, m_Inflating{ false }, m_EndOfMembers{ false }, m_Finished{ false }
+{
+	if (!m_InternalStream)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be a valid pointer."_nv);
+	}
+
+	if (!m_InternalStream->CanRead())
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be readable."_nv);
+	}
+
+	m_Impl = std::make_unique<detail_::DeflateStreamImpl>(detail_::DeflateStreamImpl::DefaultWindowBitsWithoutHeader);
+}
+
+natGzipStream::natGzipStream(natRefPointer<natStream> stream, natThreadPool& threadPool, size_t maxPendingMembers)
+	: natGzipStream(std::move(stream))
+{
+	m_ThreadPool = &threadPool;
+	m_MaxPendingMembers = std::max(maxPendingMembers, size_t{ 1 });
+}
+
+natGzipStream::natGzipStream(natRefPointer<natStream> stream, natDeflateStream::CompressionLevel compressionLevel, size_t memberSize)
+	: m_InternalStream{ std::move(stream) }, m_ThreadPool{}, m_MaxPendingMembers{}, m_MemberSize{ memberSize },
+	m_BufferPosition{}, m_BufferSize{}, m_MemberPosition{}, m_Crc32{}, m_MemberUncompressedSize{},
+	m_NextMemberBlockSize{}, m_NextMemberHeaderSize{}, m_Position{}, m_MemberCount{}, m_HasNextMember{ false }, m_Inflating{ false }, m_EndOfMembers{ false }, m_Finished{ false }
+{
+	if (!m_InternalStream)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be a valid pointer."_nv);
+	}
+
+	if (!m_InternalStream->CanWrite())
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be writable."_nv);
+	}
+
+	if (m_MemberSize > std::numeric_limits<uInt>::max() / 2)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "memberSize is out of range."_nv);
+	}
+
+	m_Impl = std::make_unique<detail_::DeflateStreamImpl>(GetZlibCompressionLevel(compressionLevel), Z_DEFLATED, detail_::DeflateStreamImpl::DefaultWindowBitsWithoutHeader, DEF_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+
+	if (m_MemberSize)
+	{
+		m_Member.reserve(m_MemberSize);
+	}
+	else
+	{
+		m_Buffer.resize(DefaultBufferSize);
+		writeHeader(0);
+	}
+}
+
+natGzipStream::~natGzipStream()
+{
+	if (m_Impl->Compress)
+	{
+		try
+		{
+			Finish();
+		}
+		catch (...)
+		{
+			// ʵʾʱ޷Ҫ֪ʽFinish
+		}
+	}
+	else
+	{
+		discardPendingMembers();
+	}
+}
+
+natRefPointer<natStream> natGzipStream::GetUnderlyingStream() const noexcept
+{
+	return m_InternalStream;
+}
+
+size_t natGzipStream::GetMemberCount() const noexcept
+{
+	return m_MemberCount;
+}
+
+void natGzipStream::Finish()
+{
+	if (!m_Impl->Compress || m_Finished)
+	{
+		return;
+	}
+
+	m_Finished = true;
+	if (m_MemberSize)
+	{
+		if (!m_Member.empty())
+		{
+			writeMember();
+		}
+
+		// BGZFͬһճԱļĽβ
+		writeMember();
+	}
+	else
+	{
+		deflateAll(Z_FINISH);
+		writeTrailer(m_Crc32, m_MemberUncompressedSize);
+	}
+}
+
+nBool natGzipStream::CanWrite() const
+{
+	return m_Impl->Compress && !m_Finished;
+}
+
+nBool natGzipStream::CanRead() const
+{
+	return !m_Impl->Compress;
+}
+
+nBool natGzipStream::CanResize() const
+{
+	return false;
+}
+
+nBool natGzipStream::CanSeek() const
+{
+	return false;
+}
+
+nBool natGzipStream::IsEndOfStream() const
+{
+	if (m_Impl->Compress)
+	{
+		return m_Finished;
+	}
+
+	return m_EndOfMembers && !m_HasNextMember && !m_Inflating && m_PendingJobs.empty() && m_MemberPosition == m_Member.size();
+}
+
+nLen natGzipStream::GetSize() const
+{
+	nat_Throw(natErrException, NatErr_NotSupport, "This type of stream does not support GetSize."_nv);
+}
+
+void natGzipStream::SetSize(nLen)
+{
+	nat_Throw(natErrException, NatErr_NotSupport, "This type of stream does not support SetSize."_nv);
+}
+
+nLen natGzipStream::GetPosition() const
+{
+	return m_Position;
+}
+
+void natGzipStream::SetPosition(NatSeek, nLong)
+{
+	nat_Throw(natErrException, NatErr_NotSupport, "This type of stream does not support SetPosition."_nv);
+}
+
+nLen natGzipStream::ReadBytes(nData pData, nLen Length)
+{
+	if (!CanRead())
+	{
+		nat_Throw(natErrException, NatErr_IllegalState, "Stream is not readable."_nv);
+	}
+
+	auto pRead = pData;
+	auto dataRemain = Length;
+
+	while (dataRemain)
+	{
+		// ѲнѹϵĳԱ
+		if (m_MemberPosition < m_Member.size())
+		{
+			const auto copySize = static_cast<size_t>(std::min(dataRemain, static_cast<nLen>(m_Member.size() - m_MemberPosition)));
+			std::memcpy(pRead, m_Member.data() + m_MemberPosition, copySize);
+			m_MemberPosition += copySize;
+			pRead += copySize;
+			dataRemain -= copySize;
+			continue;
+		}
+
+		if (m_Inflating)
+		{
+			if (m_BufferPosition == m_BufferSize && !fillBuffer())
+			{
+				nat_Throw(InvalidData, "Unexpected end of gzip data."_nv);
+			}
+
+			auto& zStream = m_Impl->ZStream;
+			const auto outputSize = static_cast<uInt>(std::min(dataRemain, static_cast<nLen>(std::numeric_limits<uInt>::max())));
+			zStream.next_in = m_Buffer.data() + m_BufferPosition;
+			zStream.avail_in = static_cast<uInt>(m_BufferSize - m_BufferPosition);
+			zStream.next_out = pRead;
+			zStream.avail_out = outputSize;
+
+			const auto ret = inflate(&zStream, Z_NO_FLUSH);
+			if (ret == Z_DATA_ERROR || ret == Z_NEED_DICT)
+			{
+				nat_Throw(InvalidData, "Invalid data with zlib message ({0})."_nv, U8StringView{ zStream.msg ? zStream.msg : "" });
+			}
+			if (ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR)
+			{
+				nat_Throw(natErrException, NatErr_InternalErr, "inflate failed with code {0}."_nv, ret);
+			}
+
+			m_BufferPosition = m_BufferSize - zStream.avail_in;
+			const auto currentReadBytes = outputSize - zStream.avail_out;
+			m_Crc32 = Crc32::Update(m_Crc32, pRead, currentReadBytes);
+			m_MemberUncompressedSize += static_cast<nuInt>(currentReadBytes);
+			pRead += currentReadBytes;
+			dataRemain -= currentReadBytes;
+
+			if (ret == Z_STREAM_END)
+			{
+				m_Inflating = false;
+				readTrailer();
+			}
+			continue;
+		}
+
+		scheduleMembers();
+		if (!m_PendingJobs.empty())
+		{
+			takeFrontMember();
+			continue;
+		}
+
+		if (!m_HasNextMember)
+		{
+			break;
+		}
+
+		// ޷֪СĳԱֻܰ˳ѹ
+		if (!m_Impl->Reset(detail_::DeflateStreamImpl::DefaultWindowBitsWithoutHeader))
+		{
+			nat_Throw(natErrException, NatErr_InternalErr, "inflateReset failed."_nv);
+		}
+		m_HasNextMember = false;
+		m_Inflating = true;
+		m_Crc32 = 0;
+		m_MemberUncompressedSize = 0;
+	}
+
+	const auto readBytes = Length - dataRemain;
+	m_Position += readBytes;
+	return readBytes;
+}
+
+nLen natGzipStream::WriteBytes(ncData pData, nLen Length)
+{
+	if (!CanWrite())
+	{
+		nat_Throw(natErrException, NatErr_IllegalState, "Stream is not writable."_nv);
+	}
+
+	if (!Length)
+	{
+		return 0;
+	}
+
+	if (m_MemberSize)
+	{
+		auto remainedLength = Length;
+		while (remainedLength)
+		{
+			// ʵʾиʱдĳԱԱ֤Finish֮ǰ
+			if (m_Member.size() == m_MemberSize)
+			{
+				writeMember();
+			}
+
+			const auto currentLength = static_cast<size_t>(std::min(remainedLength, static_cast<nLen>(m_MemberSize - m_Member.size())));
+			m_Member.insert(m_Member.end(), pData, pData + currentLength);
+			pData += currentLength;
+			remainedLength -= currentLength;
+		}
+	}
+	else
+	{
+		m_Crc32 = Crc32::Update(m_Crc32, pData, static_cast<size_t>(Length));
+		m_MemberUncompressedSize += static_cast<nuInt>(Length);
+		m_Impl->SetInput(pData, static_cast<size_t>(Length));
+		deflateAll(Z_NO_FLUSH);
+	}
+
+	m_Position += Length;
+	return Length;
+}
+
+void natGzipStream::Flush()
+{
+	if (m_Impl->Compress && !m_Finished)
+	{
+		if (!m_MemberSize)
+		{
+			deflateAll(Z_SYNC_FLUSH);
+		}
+		else if (!m_Member.empty())
+		{
+			writeMember();
+		}
+	}
+
+	m_InternalStream->Flush();
+}
+
+size_t natGzipStream::fillBuffer()
+{
+	if (m_BufferPosition == m_BufferSize)
+	{
+		m_BufferPosition = 0;
+		m_BufferSize = static_cast<size_t>(m_InternalStream->ReadBytes(m_Buffer.data(), m_Buffer.size()));
+	}
+
+	return m_BufferSize - m_BufferPosition;
+}
+
+void natGzipStream::readRaw(nData data, size_t length)
+{
+	while (length)
+	{
+		const auto available = fillBuffer();
+		if (!available)
+		{
+			nat_Throw(InvalidData, "Unexpected end of gzip data."_nv);
+		}
+
+		const auto copySize = std::min(available, length);
+		std::memcpy(data, m_Buffer.data() + m_BufferPosition, copySize);
+		m_BufferPosition += copySize;
+		data += copySize;
+		length -= copySize;
+	}
+}
+
+nBool natGzipStream::readHeader()
+{
+	assert(!m_HasNextMember && !m_EndOfMembers);
+
+	// ʵʾһԱ֮ķgzipΪļĽβgzipߵΪһ
+	const auto isFirstMember = m_MemberCount == 0;
+	nByte header[10];
+	if (!fillBuffer() || m_Buffer[m_BufferPosition] != 0x1F)
+	{
+		if (isFirstMember)
+		{
+			nat_Throw(InvalidData, "Invalid gzip header."_nv);
+		}
+		m_EndOfMembers = true;
+		return false;
+	}
+
+	readRaw(header, sizeof header);
+	if (header[1] != 0x8B)
+	{
+		if (isFirstMember)
+		{
+			nat_Throw(InvalidData, "Invalid gzip header."_nv);
+		}
+		m_EndOfMembers = true;
+		return false;
+	}
+
+	if (header[2] != Z_DEFLATED)
+	{
+		nat_Throw(InvalidData, "Unsupported gzip compression method {0}."_nv, header[2]);
+	}
+
+	const auto flags = header[3];
+	if (flags & GzipFlagReserved)
+	{
+		nat_Throw(InvalidData, "Reserved gzip flags are set."_nv);
+	}
+
+	size_t headerSize = sizeof header, blockSize = 0;
+	if (flags & GzipFlagExtra)
+	{
+		nByte extraLengthData[2];
+		readRaw(extraLengthData, sizeof extraLengthData);
+		const auto extraLength = static_cast<size_t>(LoadLittleEndian(extraLengthData, 2));
+		std::vector<nByte> extra(extraLength);
+		readRaw(extra.data(), extra.size());
+		headerSize += sizeof extraLengthData + extraLength;
+
+		// ֶθʽSI1 SI2 LEN(2) (LEN)
+		size_t offset = 0;
+		while (offset + 4 <= extraLength)
+		{
+			const auto subfieldLength = static_cast<size_t>(LoadLittleEndian(extra.data() + offset + 2, 2));
+			if (extra[offset] == 'B' && extra[offset + 1] == 'C' && subfieldLength == 2 && offset + 6 <= extraLength)
+			{
+				blockSize = static_cast<size_t>(LoadLittleEndian(extra.data() + offset + 4, 2)) + 1;
+			}
+			offset += 4 + subfieldLength;
+		}
+	}
+
+	const auto skipString = [this, &headerSize]
+	{
+		nByte ch;
+		do
+		{
+			readRaw(&ch, 1);
+			++headerSize;
+		} while (ch);
+	};
+
+	if (flags & GzipFlagName)
+	{
+		skipString();
+	}
+
+	if (flags & GzipFlagComment)
+	{
+		skipString();
+	}
+
+	if (flags & GzipFlagHeaderCrc)
+	{
+		nByte headerCrc[2];
+		readRaw(headerCrc, sizeof headerCrc);
+		headerSize += sizeof headerCrc;
+	}
+
+	if (blockSize && blockSize < headerSize + GzipTrailerSize)
+	{
+		nat_Throw(InvalidData, "Invalid BGZF block size {0}."_nv, blockSize);
+	}
+
+	m_NextMemberBlockSize = blockSize;
+	m_NextMemberHeaderSize = headerSize;
+	m_HasNextMember = true;
+	++m_MemberCount;
+	return true;
+}
+
+void natGzipStream::readTrailer()
+{
+	nByte trailer[GzipTrailerSize];
+	readRaw(trailer, sizeof trailer);
+
+	const auto expectedCrc32 = static_cast<nuInt>(LoadLittleEndian(trailer, 4));
+	const auto expectedSize = static_cast<nuInt>(LoadLittleEndian(trailer + 4, 4));
+	if (expectedCrc32 != m_Crc32)
+	{
+		nat_Throw(InvalidData, "Gzip member CRC32 mismatch (expected {0} but got {1})."_nv, expectedCrc32, m_Crc32);
+	}
+	if (expectedSize != m_MemberUncompressedSize)
+	{
+		nat_Throw(InvalidData, "Gzip member size mismatch (expected {0})."_nv, expectedSize);
+	}
+}
+
+void natGzipStream::scheduleMembers()
+{
+	while (!m_EndOfMembers)
+	{
+		if (!m_HasNextMember && !readHeader())
+		{
+			break;
+		}
+
+		if (!m_ThreadPool || !m_NextMemberBlockSize || m_PendingJobs.size() >= m_MaxPendingMembers)
+		{
+			break;
+		}
+
+		auto job = std::make_unique<MemberJob>();
+		job->Input.resize(m_NextMemberBlockSize - m_NextMemberHeaderSize);
+		readRaw(job->Input.data(), job->Input.size());
+		m_HasNextMember = false;
+
+		job->WorkToken = m_ThreadPool->QueueWork([](void* param)
+		{
+			return static_cast<MemberJob*>(param)->Run();
+		}, job.get());
+		m_PendingJobs.emplace_back(std::move(job));
+	}
+}
+
+void natGzipStream::takeFrontMember()
+{
+	assert(!m_PendingJobs.empty());
+
+	const auto job = std::move(m_PendingJobs.front());
+	m_PendingJobs.pop_front();
+
+	try
+	{
+		// ʵʾѹʱ쳣ڴ˴׳
+		job->WorkToken.get().GetResult().get();
+	}
+	catch (...)
+	{
+		discardPendingMembers();
+		throw;
+	}
+
+	m_Member = std::move(job->Output);
+	m_MemberPosition = 0;
+}
+
+void natGzipStream::discardPendingMembers() noexcept
+{
+	// ߳ʹóԱݣҪȴɺͷ
+	for (auto&& job : m_PendingJobs)
+	{
+		try
+		{
+			job->WorkToken.get().GetResult().wait();
+		}
+		catch (...)
+		{
+		}
+	}
+	m_PendingJobs.clear();
+	m_HasNextMember = false;
+	m_EndOfMembers = true;
+}
+
+void natGzipStream::writeRaw(ncData data, size_t length)
+{
+	const auto writtenBytes = m_InternalStream->WriteBytes(data, length);
+	if (writtenBytes < length)
+	{
+		nat_Throw(natErrException, NatErr_InternalErr, "Partial data written({0}/{1} requested)."_nv, writtenBytes, length);
+	}
+}
+
+void natGzipStream::writeHeader(size_t blockSize)
+{
+	const auto level = m_Impl->Level;
+	const nByte extraFlags = level == Z_BEST_COMPRESSION ? 2 : level == Z_BEST_SPEED ? 4 : 0;
+
+	if (blockSize)
+	{
+		assert(blockSize <= MaxBgzfBlockSize);
+		// ID1 ID2 CM FLG MTIME(4) XFL OS(δ֪) XLEN(2) SI1 SI2 SLEN(2) BSIZE(2)
+		const auto bsize = static_cast<nuShort>(blockSize - 1);
+		const nByte header[] = { 0x1F, 0x8B, 8, GzipFlagExtra, 0, 0, 0, 0, extraFlags, 255, 6, 0, 'B', 'C', 2, 0, static_cast<nByte>(bsize), static_cast<nByte>(bsize >> 8) };
+		static_assert(sizeof header == BgzfHeaderSize, "Size of BGZF header is wrong.");
+		writeRaw(header, sizeof header);
+	}
+	else
+	{
+		// ID1 ID2 CM FLG MTIME(4) XFL OS(δ֪)
+		const nByte header[] = { 0x1F, 0x8B, 8, 0, 0, 0, 0, 0, extraFlags, 255 };
+		writeRaw(header, sizeof header);
+	}
+
+	++m_MemberCount;
+}
+
+void natGzipStream::writeTrailer(nuInt crc32, nuInt size)
+{
+	nByte trailer[GzipTrailerSize];
+	StoreLittleEndian(trailer, crc32, 4);
+	StoreLittleEndian(trailer + 4, size, 4);
+	writeRaw(trailer, sizeof trailer);
+}
+
+void natGzipStream::deflateAll(int flush)
+{
+	while (true)
+	{
+		m_Impl->SetOutput(m_Buffer.data(), m_Buffer.size());
+		const auto ret = m_Impl->DoNext(flush);
+		if (ret == Z_STREAM_ERROR || ret == Z_MEM_ERROR)
+		{
+			nat_Throw(natErrException, NatErr_InternalErr, "deflate failed with code {0}."_nv, ret);
+		}
+
+		const auto availableDataSize = m_Buffer.size() - m_Impl->ZStream.avail_out;
+		if (availableDataSize)
+		{
+			writeRaw(m_Buffer.data(), availableDataSize);
+		}
+
+		// δ˵Ѿ벢Ҫˢ
+		if (ret == Z_STREAM_END || ret == Z_BUF_ERROR || (m_Impl->ZStream.avail_out != 0 && !m_Impl->HasInput()))
+		{
+			break;
+		}
+	}
+}
+
+void natGzipStream::writeMember()
+{
+	if (!m_Impl->Reset(m_Impl->WindowBits))
+	{
+		nat_Throw(natErrException, NatErr_InternalErr, "deflateReset failed."_nv);
+	}
+
+	auto& zStream = m_Impl->ZStream;
+	const auto bound = static_cast<size_t>(deflateBound(&zStream, static_cast<uLong>(m_Member.size())));
+	if (m_Buffer.size() < bound)
+	{
+		m_Buffer.resize(bound);
+	}
+
+	zStream.next_in = m_Member.data();
+	zStream.avail_in = static_cast<uInt>(m_Member.size());
+	zStream.next_out = m_Buffer.data();
+	zStream.avail_out = static_cast<uInt>(m_Buffer.size());
+	const auto ret = deflate(&zStream, Z_FINISH);
+	if (ret != Z_STREAM_END)
+	{
+		nat_Throw(natErrException, NatErr_InternalErr, "deflate failed with code {0}."_nv, ret);
+	}
+
+	const auto compressedSize = m_Buffer.size() - zStream.avail_out;
+	const auto blockSize = BgzfHeaderSize + compressedSize + GzipTrailerSize;
+	// ʵʾBCֶܱʾĴСʱдͨͷȡʱ˳ѹ
+	writeHeader(blockSize <= MaxBgzfBlockSize ? blockSize : 0);
+	writeRaw(m_Buffer.data(), compressedSize);
+	writeTrailer(Crc32::Update(0, m_Member.data(), m_Member.size()), static_cast<nuInt>(m_Member.size()));
+	m_Member.clear();
+}
+
+namespace
+{
+	// ʽLZ4ͬÿɱֽڡȡ2ֽڵƫƼƥ䳤ɣһн
+	constexpr size_t LzMinMatch = 4;
+	// Ϊ5ֽڣƥ䲻ܿʼ12ֽ֮
+	constexpr size_t LzLastLiterals = 5;
+	constexpr size_t LzMatchFindLimit = 12;
+	constexpr size_t LzMaxOffset = 65535;
+	constexpr size_t LzHashLog = 12;
+	// δҵƥʱ
+	constexpr nuInt LzSkipTrigger = 6;
+	constexpr nuInt LzStoredBlockFlag = 0x80000000;
+
+	constexpr size_t LzCompressBound(size_t size) noexcept
+	{
+		return size + size / 255 + 16;
+	}
+
+	nuInt LzLoad32(ncData data) noexcept
+	{
+		nuInt value;
+		std::memcpy(&value, data, sizeof value);
+		return value;
+	}
+
+	nuLong LzLoad64(ncData data) noexcept
+	{
+		nuLong value;
+		std::memcpy(&value, data, sizeof value);
+		return value;
+	}
+
+	nuInt LzHash(ncData data) noexcept
+	{
+		return (LzLoad32(data) * 2654435761u) >> (32 - LzHashLog);
+	}
+
+	size_t LzCountMatch(ncData data, ncData match, ncData limit) noexcept
+	{
+		const auto start = data;
+		while (limit - data >= 8 && LzLoad64(data) == LzLoad64(match))
+		{
+			data += 8;
+			match += 8;
+		}
+		while (data < limit && *data == *match)
+		{
+			++data;
+			++match;
+		}
+		return static_cast<size_t>(data - start);
+	}
+
+	nData LzWriteLength(nData out, size_t length) noexcept
+	{
+		while (length >= 255)
+		{
+			*out++ = 255;
+			length -= 255;
+		}
+		*out++ = static_cast<nByte>(length);
+		return out;
+	}
+
+	nData LzWriteLiterals(nData out, ncData literals, size_t literalLength, nByte matchToken) noexcept
+	{
+		if (literalLength >= 15)
+		{
+			*out++ = static_cast<nByte>(0xF0 | matchToken);
+			out = LzWriteLength(out, literalLength - 15);
+		}
+		else
+		{
+			*out++ = static_cast<nByte>(literalLength << 4 | matchToken);
+		}
+		std::memcpy(out, literals, literalLength);
+		return out + literalLength;
+	}
+
+	///	@brief	ѹһ
+	///	@param[out]	dst	ΪLzCompressBound(srcSize)ֽ
+	///	@return	ѹĴС
+	size_t LzCompressBlock(ncData src, size_t srcSize, nData dst, nuInt acceleration, nuInt* hashTable) noexcept
+	{
+		assert(srcSize <= natLzStream::BlockSize && acceleration > 0);
+
+		auto out = dst;
+		size_t anchor{};
+
+		if (srcSize >= LzMatchFindLimit + 1)
+		{
+			std::fill_n(hashTable, size_t{ 1 } << LzHashLog, 0u);
+
+			const auto matchFindLimit = srcSize - LzMatchFindLimit;
+			const auto matchLimit = srcSize - LzLastLiterals;
+			size_t pos = 1;
+			hashTable[LzHash(src)] = 0;
+
+			while (pos < matchFindLimit)
 			{
-				m_Impl->SetOutput(m_Buffer, sizeof m_Buffer);
+				// ƥ
+				auto searchCount = acceleration << LzSkipTrigger;
+				size_t match{};
+				nBool found = false;
+				while (pos < matchFindLimit)
+				{
+					const auto hash = LzHash(src + pos);
+					match = hashTable[hash];
+					hashTable[hash] = static_cast<nuInt>(pos);
+					if (match < pos && pos - match <= LzMaxOffset && LzLoad32(src + match) == LzLoad32(src + pos))
+					{
+						found = true;
+						break;
+					}
+
+					pos += searchCount++ >> LzSkipTrigger;
+				}
+
+				if (!found)
+				{
+					break;
+				}
+
+				// ǰչƥ
+				while (pos > anchor && match > 0 && src[pos - 1] == src[match - 1])
+				{
+					--pos;
+					--match;
+				}
+
+				const auto matchLength = LzMinMatch + LzCountMatch(src + pos + LzMinMatch, src + match + LzMinMatch, src + matchLimit);
+				const auto matchToken = static_cast<nByte>(std::min(matchLength - LzMinMatch, size_t{ 15 }));
+
+				out = LzWriteLiterals(out, src + anchor, pos - anchor, matchToken);
+				const auto offset = pos - match;
+				*out++ = static_cast<nByte>(offset);
+				*out++ = static_cast<nByte>(offset >> 8);
+				if (matchToken == 15)
+				{
+					out = LzWriteLength(out, matchLength - LzMinMatch - 15);
+				}
+
+				pos += matchLength;
+				anchor = pos;
+
+				if (pos < matchFindLimit)
+				{
+					hashTable[LzHash(src + pos - 2)] = static_cast<nuInt>(pos - 2);
+				}
 			}
-		} while (ret != Z_OK && ret != Z_STREAM_END);
+		}
+
+		out = LzWriteLiterals(out, src + anchor, srcSize - anchor, 0);
+		return static_cast<size_t>(out - dst);
 	}
-	
-	return totalWrittenBytes;
+
+	///	@brief	ѹһ
+	///	@return	ѹĴСЧʱؿ
+	Optional<size_t> LzDecompressBlock(ncData src, size_t srcSize, nData dst, size_t dstCapacity) noexcept
+	{
+		auto in = src;
+		const auto inEnd = src + srcSize;
+		auto out = dst;
+		const auto outEnd = dst + dstCapacity;
+
+		const auto readLength = [&](size_t& length)
+		{
+			nByte value;
+			do
+			{
+				if (in == inEnd)
+				{
+					return false;
+				}
+				value = *in++;
+				length += value;
+			} while (value == 255);
+			return true;
+		};
+
+		while (in < inEnd)
+		{
+			const auto token = *in++;
+
+			size_t literalLength = token >> 4;
+			// ʵʾռ㹻ʱԹ̶ĳȸƣิƵĲֻᱻ֮
+			if (literalLength < 15 && inEnd - in >= 16 && outEnd - out >= 16)
+			{
+				std::memcpy(out, in, 16);
+			}
+			else
+			{
+				if (literalLength == 15 && !readLength(literalLength))
+				{
+					return {};
+				}
+				if (static_cast<size_t>(inEnd - in) < literalLength || static_cast<size_t>(outEnd - out) < literalLength)
+				{
+					return {};
+				}
+				std::memcpy(out, in, literalLength);
+			}
+			in += literalLength;
+			out += literalLength;
+
+			if (in == inEnd)
+			{
+				break;
+			}
+
+			if (inEnd - in < 2)
+			{
+				return {};
+			}
+			const auto offset = static_cast<size_t>(in[0] | in[1] << 8);
+			in += 2;
+			if (!offset || offset > static_cast<size_t>(out - dst))
+			{
+				return {};
+			}
+
+			size_t matchLength = token & 0xF;
+			if (matchLength == 15 && !readLength(matchLength))
+			{
+				return {};
+			}
+			matchLength += LzMinMatch;
+			if (static_cast<size_t>(outEnd - out) < matchLength)
+			{
+				return {};
+			}
+
+			const auto match = out - offset;
+			if (matchLength <= 16 && offset >= 8 && outEnd - out >= 16)
+			{
+				// ÿθƵ8ֽڲĿص
+				std::memcpy(out, match, 8);
+				std::memcpy(out + 8, match + 8, 8);
+				out += matchLength;
+			}
+			else
+			{
+				// صʱ[match, out)ĳoffsetıÿθƺ󳤶ȼӱ
+				while (matchLength)
+				{
+					const auto copyLength = std::min(matchLength, static_cast<size_t>(out - match));
+					std::memcpy(out, match, copyLength);
+					out += copyLength;
+					matchLength -= copyLength;
+				}
+			}
+		}
+
+		return static_cast<size_t>(out - dst);
+	}
+
+	nuInt GetLzAcceleration(natDeflateStream::CompressionLevel compressionLevel)
+	{
+		switch (compressionLevel)
+		{
+		case natDeflateStream::CompressionLevel::Optimal:
+			return 1;
+		case natDeflateStream::CompressionLevel::Fastest:
+			return 4;
+		case natDeflateStream::CompressionLevel::NoCompression:
+			return 0;
+		default:
+			assert(!"Invalid compressionLevel.");
+			nat_Throw(natErrException, NatErr_InvalidArg, "Invalid compressionLevel."_nv);
+		}
+	}
+}
+
+natLzStream::natLzStream(natRefPointer<natStream> stream)
+	: m_InternalStream{ std::move(stream) }, m_Compress{ false }, m_Acceleration{}, m_Buffer(BlockSize), m_CompressedBuffer(LzCompressBound(BlockSize)), m_BufferPosition{}, m_BufferSize{}, m_Position{}, m_WroteData{ false }, m_Finished{ false }
+{
+	if (!m_InternalStream)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be a valid pointer."_nv);
+	}
+
+	if (!m_InternalStream->CanRead())
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be readable."_nv);
+	}
+}
+
+natLzStream::natLzStream(natRefPointer<natStream> stream, natDeflateStream::CompressionLevel compressionLevel)
+	: m_InternalStream{ std::move(stream) }, m_Compress{ true }, m_Acceleration{ GetLzAcceleration(compressionLevel) }, m_Buffer(BlockSize), m_BufferPosition{}, m_BufferSize{}, m_Position{}, m_WroteData{ false }, m_Finished{ false }
+{
+	if (!m_InternalStream)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be a valid pointer."_nv);
+	}
+
+	if (!m_InternalStream->CanWrite())
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "stream should be writable."_nv);
+	}
+
+	if (m_Acceleration)
+	{
+		// ʵʾԤͷĿռ
+		m_CompressedBuffer.resize(LzCompressBound(BlockSize) + 4);
+		m_HashTable.resize(size_t{ 1 } << LzHashLog);
+	}
+}
+
+natLzStream::~natLzStream()
+{
+	try
+	{
+		Finish();
+	}
+	catch (...)
+	{
+		// ʵʾʱ޷Ҫ֪ʽFinish
+	}
+}
+
+natRefPointer<natStream> natLzStream::GetUnderlyingStream() const noexcept
+{
+	return m_InternalStream;
+}
+
+void natLzStream::Finish()
+{
+	if (!m_Compress || m_Finished)
+	{
+		return;
+	}
+
+	m_Finished = true;
+	if (m_BufferSize)
+	{
+		writeBlock();
+	}
+	if (m_WroteData)
+	{
+		nByte endMark[4]{};
+		m_InternalStream->ForceWriteBytes(endMark, sizeof endMark);
+	}
+}
+
+nBool natLzStream::CanWrite() const
+{
+	return m_Compress && m_InternalStream->CanWrite();
+}
+
+nBool natLzStream::CanRead() const
+{
+	return !m_Compress && m_InternalStream->CanRead();
+}
+
+nBool natLzStream::CanResize() const
+{
+	return false;
+}
+
+nBool natLzStream::CanSeek() const
+{
+	return false;
+}
+
+nBool natLzStream::IsEndOfStream() const
+{
+	return m_Compress ? m_InternalStream->IsEndOfStream() : m_Finished;
+}
+
+nLen natLzStream::GetSize() const
+{
+	nat_Throw(natErrException, NatErr_NotSupport, "This type of stream does not support GetSize."_nv);
+}
+
+void natLzStream::SetSize(nLen)
+{
+	nat_Throw(natErrException, NatErr_NotSupport, "This type of stream does not support SetSize."_nv);
+}
+
+nLen natLzStream::GetPosition() const
+{
+	return m_Position;
+}
+
+void natLzStream::SetPosition(NatSeek, nLong)
+{
+	nat_Throw(natErrException, NatErr_NotSupport, "This type of stream does not support SetPosition."_nv);
+}
+
+nLen natLzStream::ReadBytes(nData pData, nLen Length)
+{
+	if (!CanRead())
+	{
+		nat_Throw(natErrException, NatErr_IllegalState, "Stream is not readable."_nv);
+	}
+
+	nLen totalRead{};
+	while (totalRead < Length)
+	{
+		if (m_BufferPosition == m_BufferSize && !readBlock())
+		{
+			break;
+		}
+
+		const auto readBytes = static_cast<size_t>(std::min(static_cast<nLen>(m_BufferSize - m_BufferPosition), Length - totalRead));
+		std::memcpy(pData + totalRead, m_Buffer.data() + m_BufferPosition, readBytes);
+		m_BufferPosition += readBytes;
+		totalRead += readBytes;
+	}
+
+	m_Position += totalRead;
+	return totalRead;
+}
+
+nLen natLzStream::WriteBytes(ncData pData, nLen Length)
+{
+	if (!CanWrite())
+	{
+		nat_Throw(natErrException, NatErr_IllegalState, "Stream is not writable."_nv);
+	}
+
+	if (m_Finished)
+	{
+		nat_Throw(natErrException, NatErr_IllegalState, "Stream has already finished."_nv);
+	}
+
+	nLen totalWritten{};
+	while (totalWritten < Length)
+	{
+		const auto writeBytes = static_cast<size_t>(std::min(static_cast<nLen>(BlockSize - m_BufferSize), Length - totalWritten));
+		std::memcpy(m_Buffer.data() + m_BufferSize, pData + totalWritten, writeBytes);
+		m_BufferSize += writeBytes;
+		totalWritten += writeBytes;
+
+		if (m_BufferSize == BlockSize)
+		{
+			writeBlock();
+		}
+	}
+
+	m_Position += totalWritten;
+	return totalWritten;
+}
+
+void natLzStream::Flush()
+{
+	if (m_Compress && !m_Finished)
+	{
+		if (m_BufferSize)
+		{
+			writeBlock();
+		}
+		m_InternalStream->Flush();
+	}
+}
+
+nBool natLzStream::readBlock()
+{
+	m_BufferPosition = 0;
+	m_BufferSize = 0;
+
+	if (m_Finished)
+	{
+		return false;
+	}
+
+	nByte header[4];
+	const auto headerRead = m_InternalStream->ReadBytes(header, sizeof header);
+	if (headerRead < sizeof header)
+	{
+		if (headerRead)
+		{
+			m_InternalStream->ForceReadBytes(header + headerRead, sizeof header - headerRead);
+		}
+		else
+		{
+			// ڿı߽紦ֱӽ
+			m_Finished = true;
+			return false;
+		}
+	}
+
+	const auto blockHeader = static_cast<nuInt>(LoadLittleEndian(header, sizeof header));
+	const size_t length = blockHeader & ~LzStoredBlockFlag;
+	if (!length)
+	{
+		m_Finished = true;
+		return false;
+	}
+
+	if (blockHeader & LzStoredBlockFlag)
+	{
+		if (length > BlockSize)
+		{
+			nat_Throw(InvalidData, "Lz block is too big."_nv);
+		}
+		m_InternalStream->ForceReadBytes(m_Buffer.data(), length);
+		m_BufferSize = length;
+	}
+	else
+	{
+		if (length > m_CompressedBuffer.size())
+		{
+			nat_Throw(InvalidData, "Lz block is too big."_nv);
+		}
+		m_InternalStream->ForceReadBytes(m_CompressedBuffer.data(), length);
+		const auto size = LzDecompressBlock(m_CompressedBuffer.data(), length, m_Buffer.data(), m_Buffer.size());
+		if (!size)
+		{
+			nat_Throw(InvalidData, "Lz block is corrupted."_nv);
+		}
+		m_BufferSize = size.value();
+	}
+
+	return true;
+}
+
+void natLzStream::writeBlock()
+{
+	assert(m_BufferSize && m_BufferSize <= BlockSize);
+
+	size_t compressedSize{};
+	if (m_Acceleration)
+	{
+		compressedSize = LzCompressBlock(m_Buffer.data(), m_BufferSize, m_CompressedBuffer.data() + 4, m_Acceleration, m_HashTable.data());
+	}
+
+	nByte header[4];
+	if (compressedSize && compressedSize < m_BufferSize)
+	{
+		StoreLittleEndian(m_CompressedBuffer.data(), compressedSize, sizeof header);
+		m_InternalStream->ForceWriteBytes(m_CompressedBuffer.data(), compressedSize + 4);
+	}
+	else
+	{
+		// ޷ѹĿֱӴ洢
+		StoreLittleEndian(header, m_BufferSize | LzStoredBlockFlag, sizeof header);
+		m_InternalStream->ForceWriteBytes(header, sizeof header);
+		m_InternalStream->ForceWriteBytes(m_Buffer.data(), m_BufferSize);
+	}
+
+	m_BufferSize = 0;
+	m_WroteData = true;
 }
 
 natCrc32Stream::natCrc32Stream(natRefPointer<natStream> stream)
@@ -437,7 +2900,7 @@ nLen natCrc32Stream::WriteBytes(ncData pData, nLen Length)
 	}
 
 	const auto writtenBytes = m_InternalStream->WriteBytes(pData, Length);
-	m_Crc32 = static_cast<nuInt>(crc32_z(m_Crc32, pData, static_cast<z_size_t>(Length)));
+	m_Crc32 = Crc32::Update(m_Crc32, pData, static_cast<std::size_t>(Length));
 	m_CurrentPosition += Length;
 
 	return writtenBytes;
@@ -1,6 +1,8 @@
 #pragma once
 #include "natConfig.h"
 #include "natStream.h"
+#include "natMultiThread.h"
+#include <deque>
 
 namespace NatsuLib
 {
@@ -9,15 +11,89 @@ namespace NatsuLib
 		struct DeflateStreamImpl;
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	DeflateԤֵ
+	///	@note	ѹѹʱʹֵͬ䣬ڴѹСݣֵԽʱľԽ
+	///			ʹzlibͷʱֵIDֵAdler-32ᱻдͷѹʱṩֵǷƥ
+	////////////////////////////////////////////////////////////////////////////////
+	class natDeflateDictionary final
+		: public natRefObjImpl<natRefObj>
+	{
+	public:
+		enum : size_t
+		{
+			MaxSize = 32 * 1024,	///< @brief	deflateĴڴСֵ䳬˴СĲֲᱻʹ
+		};
+
+		natDeflateDictionary(ncData data, size_t size);
+		explicit natDeflateDictionary(std::vector<nByte> data);
+		~natDeflateDictionary();
+
+		ncData GetData() const noexcept;
+		size_t GetSize() const noexcept;
+		///	@brief	ֵIDzlibͷм¼ֵͬ
+		nuInt GetId() const noexcept;
+
+		///	@brief	ѵֵ
+		///	@param[in]	samples		Ӷɵ
+		///	@param[in]	sampleSizes	ĴС
+		///	@param[in]	maxSize		ֵС
+		///	@note	ΪɶΣÿѡȡڲͬгֵƬΣԽƬλֵԽλ
+		///			ӦʵʽҪѹƣܴСͨӦΪֵСʮ
+		static natRefPointer<natDeflateDictionary> Train(ncData samples, std::vector<size_t> const& sampleSizes, size_t maxSize = MaxSize);
+
+	private:
+		std::vector<nByte> m_Data;
+		nuInt m_Id;
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	Deflate
+	///	@note	zlibѹѹ״̬Ļʹô˳صnatDeflateStreamʱ״̬ò黹У
+	///			֮󴴽Щ״̬Ϊÿ·Լ256KBѹ״̬ʮKBĽѹ״̬
+	///			ѹ״̬ͬѹȼͷõãѹ״̬Աѹ
+	///			з̰߳ȫģгصã˳ʹŻ
+	////////////////////////////////////////////////////////////////////////////////
+	class natDeflateEnginePool final
+		: public natRefObjImpl<natRefObj>, public nonmovable
+	{
+		friend class natDeflateStream;
+
+	public:
+		enum : size_t
+		{
+			DefaultMaxIdleEngines = 16,
+		};
+
+		///	@brief	
+		///	@param[in]	maxIdleEngines	໺Ŀʱ黹潫ͷ
+		explicit natDeflateEnginePool(size_t maxIdleEngines = DefaultMaxIdleEngines);
+		~natDeflateEnginePool();
+
+		///	@brief	õǰĿ
+		size_t GetIdleEngineCount() const;
+		///	@brief	ͷпе
+		void Clear();
+
+	private:
+		mutable natCriticalSection m_Section;
+		std::vector<std::unique_ptr<detail_::DeflateStreamImpl>> m_IdleEngines;
+		const size_t m_MaxIdleEngines;
+
+		// ʵʾδҵɸõʱnullptr
+		std::unique_ptr<detail_::DeflateStreamImpl> acquire(nBool compress, int level, int windowBits);
+		void release(std::unique_ptr<detail_::DeflateStreamImpl> engine) noexcept;
+	};
+
 	class natDeflateStream
 		: public natRefObjImpl<natStream>, public nonmovable
 	{
+	public:
 		enum : size_t
 		{
 			DefaultBufferSize = 8192,
 		};
 
-	public:
 		enum class CompressionLevel
 		{
 			Optimal = 0,
@@ -27,10 +103,28 @@ namespace NatsuLib
 
 		explicit natDeflateStream(natRefPointer<natStream> stream, nBool useHeader = false);
 		natDeflateStream(natRefPointer<natStream> stream, CompressionLevel compressionLevel, nBool useHeader = false);
+		///	@brief	Ԥֵѹ
+		///	@note	ʹzlibͷʱҪֵṩֵ䲻ƥҪֵ䵫δṩڶȡʱ׳쳣
+		natDeflateStream(natRefPointer<natStream> stream, natRefPointer<natDeflateDictionary> dictionary, nBool useHeader = false);
+		///	@brief	Ԥֵѹ
+		natDeflateStream(natRefPointer<natStream> stream, CompressionLevel compressionLevel, natRefPointer<natDeflateDictionary> dictionary, nBool useHeader = false);
+		///	@brief	ʹؽѹ
+		///	@param[in]	pool		ĳأΪnullptrʱʹó
+		///	@param[in]	bufferSize	ײʱʹõĻС
+		natDeflateStream(natRefPointer<natStream> stream, natRefPointer<natDeflateEnginePool> pool, natRefPointer<natDeflateDictionary> dictionary, nBool useHeader = false, size_t bufferSize = DefaultBufferSize);
+		///	@brief	ʹѹ
+		///	@param[in]	pool		ĳأΪnullptrʱʹó
+		///	@param[in]	bufferSize	ײʱʹõĻС
+		natDeflateStream(natRefPointer<natStream> stream, CompressionLevel compressionLevel, natRefPointer<natDeflateEnginePool> pool, natRefPointer<natDeflateDictionary> dictionary, nBool useHeader = false, size_t bufferSize = DefaultBufferSize);
 		~natDeflateStream();
 
 		natRefPointer<natStream> GetUnderlyingStream() const noexcept;
 
+		///	@brief	ѹдʣ
+		///	@note	ѹЧúд룬ʱԶ
+		///			δд򲻻κ
+		void Finish();
+
 		nBool CanWrite() const override;
 		nBool CanRead() const override;
 		nBool CanResize() const override;
@@ -46,11 +140,347 @@ namespace NatsuLib
 
 	private:
 		natRefPointer<natStream> m_InternalStream;
-		nByte m_Buffer[DefaultBufferSize];
+		natRefPointer<natDeflateEnginePool> m_Pool;
+		// ʵʾλm_ImplУһ
 		std::unique_ptr<detail_::DeflateStreamImpl> m_Impl;
+		natRefPointer<natDeflateDictionary> m_Dictionary;
+		nBool m_WroteData;
+		nBool m_Finished;
+
+		void deflateAll(int flush);
+		void setDictionary();
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	Deflateѹ
+	///	@note	ָΪĿ鲢̳߳вѹÿǰһĩβΪԤֵ䣬
+	///			ѹ˳ƴΪϷdeflate/zlib/gzipCRC32ɸĽϲõ
+	///			֧д룬дϺFinishдβ
+	////////////////////////////////////////////////////////////////////////////////
+	class natParallelDeflateStream
+		: public natRefObjImpl<natStream>, public nonmovable
+	{
+	public:
+		enum class HeaderType
+		{
+			Raw,	///< @brief	ͷdeflate
+			Zlib,	///< @brief	RFC 1950
+			Gzip,	///< @brief	RFC 1952
+		};
+
+		enum : size_t
+		{
+			DefaultBlockSize = 128 * 1024,
+			DefaultMaxPendingBlocks = 16,
+		};
+
+		///	@brief	첢ѹ
+		///	@param[in]	stream				дѹݵ
+		///	@param[in]	threadPool			ѹ̳߳أ豣֤ڴǰЧ
+		///	@param[in]	compressionLevel	ѹȼ
+		///	@param[in]	headerType			ͷ
+		///	@param[in]	blockSize			ÿδѹݴС
+		///	@param[in]	maxPendingBlocks	ͬʱȴѹĿﵽʱд뽫ڴռ
+		natParallelDeflateStream(natRefPointer<natStream> stream, natThreadPool& threadPool,
+			natDeflateStream::CompressionLevel compressionLevel = natDeflateStream::CompressionLevel::Optimal,
+			HeaderType headerType = HeaderType::Raw, size_t blockSize = DefaultBlockSize, size_t maxPendingBlocks = DefaultMaxPendingBlocks);
+		~natParallelDeflateStream();
+
+		natRefPointer<natStream> GetUnderlyingStream() const noexcept;
+
+		///	@brief	дδѹݵCRC32
+		///	@note	дײĿ飬FlushFinishΪдݵCRC32
+		nuInt GetCrc32() const noexcept;
+
+		///	@brief	дײѹݴСͷβ
+		nLen GetCompressedSize() const noexcept;
+
+		///	@brief	ѹʣݲдβ֮ٽд
+		///	@note	ʱδýԶãʱ޷֪Ĵ
+		void Finish();
+
+		nBool CanWrite() const override;
+		nBool CanRead() const override;
+		nBool CanResize() const override;
+		nBool CanSeek() const override;
+		nBool IsEndOfStream() const override;
+		nLen GetSize() const override;
+		void SetSize(nLen /*Size*/) override;
+		nLen GetPosition() const override;
+		void SetPosition(NatSeek /*Origin*/, nLong /*Offset*/) override;
+		nLen ReadBytes(nData pData, nLen Length) override;
+		nLen WriteBytes(ncData pData, nLen Length) override;
+		void Flush() override;
+
+	private:
+		struct BlockJob;
+
+		natRefPointer<natStream> m_InternalStream;
+		natThreadPool& m_ThreadPool;
+		const int m_CompressionLevel;
+		const HeaderType m_HeaderType;
+		const size_t m_BlockSize;
+		const size_t m_MaxPendingBlocks;
+
+		std::shared_ptr<std::vector<nByte>> m_CurrentBlock;
+		std::shared_ptr<const std::vector<nByte>> m_PreviousBlock;
+		std::deque<std::unique_ptr<BlockJob>> m_PendingJobs;
+
+		nuInt m_Crc32, m_Adler32;
+		nLen m_TotalIn, m_TotalOut;
+		nBool m_Finished;
+
+		void submitBlock(nBool isLast);
+		void writeFrontBlock();
+		void discardPendingBlocks() noexcept;
+		void writeRaw(ncData data, size_t length);
+		void writeHeader();
+		void writeTrailer();
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	Gzip
+	///	@note	дRFC 1952ʽݣȡʱ֧ɶԱƴӶɵļԱݽ˳
+	///			һԱַ֮gzipͷݽΪļĽβ
+	///			ԱĶֶаBGZFBCֶΣѹɵ֪ԱĴС
+	///			̳߳شʱЩԱнѹ˳򱣳ֲ䣬ֶεĳԱ˳ѹ
+	///			дʱָ˳ԱСÿԱѹдBCֶΣʱ׷һճԱBGZF
+	////////////////////////////////////////////////////////////////////////////////
+	class natGzipStream
+		: public natRefObjImpl<natStream>, public nonmovable
+	{
+	public:
+		enum : size_t
+		{
+			DefaultBufferSize = 64 * 1024,
+			DefaultMaxPendingMembers = 16,
+			///	@brief	BGZF涨ĳԱδѹݵС֤ѹĳԱ64KB
+			MaxBgzfMemberSize = 65280,
+		};
+
+		///	@brief	Խѹģʽ
+		explicit natGzipStream(natRefPointer<natStream> stream);
+		///	@brief	Խѹģʽ򿪣нѹBCֶεĳԱ
+		///	@param[in]	threadPool			нѹ̳߳أ豣֤ڴǰЧ
+		///	@param[in]	maxPendingMembers	ͬʱȴѹĳԱ
+		natGzipStream(natRefPointer<natStream> stream, natThreadPool& threadPool, size_t maxPendingMembers = DefaultMaxPendingMembers);
+		///	@brief	ѹģʽ
+		///	@param[in]	memberSize	ÿԱδѹݴСΪ0ʱдͬһԱ
+		///							MaxBgzfMemberSizeʱɵļɱнѹ
+		natGzipStream(natRefPointer<natStream> stream, natDeflateStream::CompressionLevel compressionLevel, size_t memberSize = 0);
+		~natGzipStream();
+
+		natRefPointer<natStream> GetUnderlyingStream() const noexcept;
+
+		///	@brief	ѶȡдĳԱ
+		///	@note	ȡģʽ½ѿʼĳԱ
+		size_t GetMemberCount() const noexcept;
+
+		///	@brief	ѹдʣݼβ
+		///	@note	ѹЧúд룬ʱδýԶãʱ޷֪Ĵ
+		void Finish();
+
+		nBool CanWrite() const override;
+		nBool CanRead() const override;
+		nBool CanResize() const override;
+		nBool CanSeek() const override;
+		nBool IsEndOfStream() const override;
+		nLen GetSize() const override;
+		void SetSize(nLen /*Size*/) override;
+		nLen GetPosition() const override;
+		void SetPosition(NatSeek /*Origin*/, nLong /*Offset*/) override;
+		nLen ReadBytes(nData pData, nLen Length) override;
+		nLen WriteBytes(ncData pData, nLen Length) override;
+		void Flush() override;
+
+	private:
+		struct MemberJob;
+
+		natRefPointer<natStream> m_InternalStream;
+		// ʵʾڽѹģʽ̳߳عʱЧ
+		natThreadPool* m_ThreadPool;
+		size_t m_MaxPendingMembers;
+		const size_t m_MemberSize;
+		std::unique_ptr<detail_::DeflateStreamImpl> m_Impl;
+
+		// ȡģʽΪײ뻺壬дģʽΪ
+		std::vector<nByte> m_Buffer;
+		size_t m_BufferPosition, m_BufferSize;
+
+		// ȡģʽΪѽѹĳԱݣдģʽΪǰԱδѹ
+		std::vector<nByte> m_Member;
+		size_t m_MemberPosition;
+		std::deque<std::unique_ptr<MemberJob>> m_PendingJobs;
+
+		// ǰ˳ĳԱCRC32δѹС
+		nuInt m_Crc32;
+		nuInt m_MemberUncompressedSize;
+		// ѶȡͷδʼĳԱBCֶеĳԱСʱΪ0
+		size_t m_NextMemberBlockSize;
+		size_t m_NextMemberHeaderSize;
+
+		nLen m_Position;
+		size_t m_MemberCount;
+		nBool m_HasNextMember;
+		nBool m_Inflating;
+		nBool m_EndOfMembers;
+		nBool m_Finished;
+
+		size_t fillBuffer();
+		void readRaw(nData data, size_t length);
+		nBool readHeader();
+		void readTrailer();
+		void scheduleMembers();
+		void takeFrontMember();
+		void discardPendingMembers() noexcept;
+
+		void writeRaw(ncData data, size_t length);
+		void writeHeader(size_t blockSize);
+		void writeTrailer(nuInt crc32, nuInt size);
+		void deflateAll(int flush);
+		void writeMember();
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	ʵDeflate
+	///	@note	дʱÿ̶δѹһȫˢΪ㣬ȫˢºݲ֮ǰĴڣ
+	///			ʱѹ֮д̶СĽβ
+	///			ȡʱɵײĩβĽβλSetPositionתĿλõ㲢ѹ
+	///			ѹݱǺϷͷdeflateͨĽѹ˳ѹ
+	////////////////////////////////////////////////////////////////////////////////
+	class natSeekableDeflateStream
+		: public natRefObjImpl<natStream>, public nonmovable
+	{
+	public:
+		enum : size_t
+		{
+			DefaultCheckpointInterval = 256 * 1024,
+		};
+
+		///	@brief	Զȡģʽ
+		///	@param[in]	stream	ѹݵɶҿѰַĩβӦΪĽβ
+		explicit natSeekableDeflateStream(natRefPointer<natStream> stream);
+
+		///	@brief	дģʽ
+		///	@param[in]	stream				дѹݵ
+		///	@param[in]	compressionLevel	ѹȼ
+		///	@param[in]	checkpointInterval	ڼ֮δѹԽСѰַԽ쵫ѹԽ
+		natSeekableDeflateStream(natRefPointer<natStream> stream, natDeflateStream::CompressionLevel compressionLevel, size_t checkpointInterval = DefaultCheckpointInterval);
+		~natSeekableDeflateStream();
+
+		natRefPointer<natStream> GetUnderlyingStream() const noexcept;
+
+		///	@brief	ü
+		///	@note	λڿͷļ
+		size_t GetCheckpointCount() const noexcept;
+
+		///	@brief	ѹд֮д
+		///	@note	дģʽЧʱδýԶãʱ޷֪Ĵ
+		void Finish();
+
+		nBool CanWrite() const override;
+		nBool CanRead() const override;
+		nBool CanResize() const override;
+		nBool CanSeek() const override;
+		nBool IsEndOfStream() const override;
+		nLen GetSize() const override;
+		void SetSize(nLen /*Size*/) override;
+		nLen GetPosition() const override;
+		void SetPosition(NatSeek Origin, nLong Offset) override;
+		nLen ReadBytes(nData pData, nLen Length) override;
+		nLen WriteBytes(ncData pData, nLen Length) override;
+		void Flush() override;
+
+	private:
+		enum : size_t
+		{
+			BufferSize = 8192,
+		};
+
+		struct Checkpoint
+		{
+			nLen UncompressedOffset;
+			nLen CompressedOffset;
+		};
+
+		natRefPointer<natStream> m_InternalStream;
+		std::unique_ptr<detail_::DeflateStreamImpl> m_Impl;
+		std::vector<Checkpoint> m_Checkpoints;
+		const size_t m_CheckpointInterval;
+		nByte m_Buffer[BufferSize];
+
+		// ѹڵײеʼλ
+		nLen m_BaseOffset;
+		nLen m_UncompressedSize, m_CompressedSize;
+		// ǰδѹλãȡģʽ¼ѹѹλ
+		nLen m_Position, m_CompressedPosition;
+		nBool m_Finished;
+
+		void readIndex();
+		void writeIndex();
+		void deflateAll(int flush);
+		void writeRaw(ncData data, size_t length);
+		void resetToCheckpoint(Checkpoint const& checkpoint);
+		nLen inflateBytes(nData pData, nLen Length);
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	LZѹ
+	///	@note	LZ4ݵĿʽѹʹر룬ѹʵdeflateѹٶԶdeflateƵȡ
+	///			ݱָΪĿ飬ÿ֮ǰΪ4ֽڵСͷ31λΪݵĳȣλʾδѹ
+	///			Ϊ0ͷײĽβʾĽδд򲻻κ
+	////////////////////////////////////////////////////////////////////////////////
+	class natLzStream
+		: public natRefObjImpl<natStream>, public nonmovable
+	{
+	public:
+		enum : size_t
+		{
+			BlockSize = 64 * 1024,
+		};
+
+		///	@brief	Խѹģʽ
+		explicit natLzStream(natRefPointer<natStream> stream);
+		///	@brief	ѹģʽ
+		///	@param[in]	compressionLevel	ѹȼFastestԸ͵ѹʻȡѹٶȣNoCompressionѹ
+		natLzStream(natRefPointer<natStream> stream, natDeflateStream::CompressionLevel compressionLevel);
+		~natLzStream();
+
+		natRefPointer<natStream> GetUnderlyingStream() const noexcept;
+
+		///	@brief	ѹдʣ
+		///	@note	ѹЧúд룬ʱԶ
+		void Finish();
+
+		nBool CanWrite() const override;
+		nBool CanRead() const override;
+		nBool CanResize() const override;
+		nBool CanSeek() const override;
+		nBool IsEndOfStream() const override;
+		nLen GetSize() const override;
+		void SetSize(nLen /*Size*/) override;
+		nLen GetPosition() const override;
+		void SetPosition(NatSeek /*Origin*/, nLong /*Offset*/) override;
+		nLen ReadBytes(nData pData, nLen Length) override;
+		nLen WriteBytes(ncData pData, nLen Length) override;
+		void Flush() override;
+
+	private:
+		natRefPointer<natStream> m_InternalStream;
+		const nBool m_Compress;
+		// ѹʱļϵΪ0ʱѹ
+		const nuInt m_Acceleration;
+		std::vector<nByte> m_Buffer, m_CompressedBuffer;
+		std::vector<nuInt> m_HashTable;
+		// ȡģʽΪm_BufferѶȡλãдģʽδʹ
+		size_t m_BufferPosition;
+		size_t m_BufferSize;
+		nLen m_Position;
 		nBool m_WroteData;
+		nBool m_Finished;
 
-		nLen writeAll();
+		nBool readBlock();
+		void writeBlock();
 	};
 
 	class natCrc32Stream
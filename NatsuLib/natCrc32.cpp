@@ -0,0 +1,293 @@
+#include "stdafx.h"
+#include "natCrc32.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#	define NATCRC32_X64 1
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#	else
+#		include <cpuid.h>
+#	endif
+#	include <emmintrin.h>
+#	include <smmintrin.h>
+#	include <wmmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#	define NATCRC32_TARGET_PCLMUL
+#else
+#	define NATCRC32_TARGET_PCLMUL __attribute__((target("pclmul,sse4.1")))
+#endif
+
+using namespace NatsuLib;
+
+namespace
+{
+	constexpr nuInt Polynomial = 0xEDB88320;
+
+	// ʵʾTables[0]ΪֽڵıTables[k][i]Ϊֽi֮پkֽڵĽ
+	struct SlicingTables
+	{
+		nuInt Tables[16][256];
+
+		SlicingTables() noexcept
+		{
+			for (nuInt i = 0; i < 256; ++i)
+			{
+				auto crc = i;
+				for (auto j = 0; j < 8; ++j)
+				{
+					crc = crc & 1 ? (crc >> 1) ^ Polynomial : crc >> 1;
+				}
+				Tables[0][i] = crc;
+			}
+
+			for (nuInt i = 0; i < 256; ++i)
+			{
+				for (size_t k = 1; k < 16; ++k)
+				{
+					const auto prev = Tables[k - 1][i];
+					Tables[k][i] = (prev >> 8) ^ Tables[0][prev & 0xFF];
+				}
+			}
+		}
+	};
+
+	SlicingTables const& GetSlicingTables() noexcept
+	{
+		static const SlicingTables s_Tables;
+		return s_Tables;
+	}
+
+	// Сȡֽ޹
+	nuInt LoadLittleEndian32(ncData data) noexcept
+	{
+		return static_cast<nuInt>(data[0]) | static_cast<nuInt>(data[1]) << 8 | static_cast<nuInt>(data[2]) << 16 | static_cast<nuInt>(data[3]) << 24;
+	}
+
+	// ʵʾcrcΪδȡڲ״̬
+	nuInt UpdateSlicingBy16(nuInt crc, ncData data, size_t length) noexcept
+	{
+		const auto& t = GetSlicingTables().Tables;
+
+		while (length >= 16)
+		{
+			const auto a = LoadLittleEndian32(data) ^ crc;
+			const auto b = LoadLittleEndian32(data + 4);
+			const auto c = LoadLittleEndian32(data + 8);
+			const auto d = LoadLittleEndian32(data + 12);
+
+			crc = t[15][a & 0xFF] ^ t[14][(a >> 8) & 0xFF] ^ t[13][(a >> 16) & 0xFF] ^ t[12][a >> 24] ^
+				t[11][b & 0xFF] ^ t[10][(b >> 8) & 0xFF] ^ t[9][(b >> 16) & 0xFF] ^ t[8][b >> 24] ^
+				t[7][c & 0xFF] ^ t[6][(c >> 8) & 0xFF] ^ t[5][(c >> 16) & 0xFF] ^ t[4][c >> 24] ^
+				t[3][d & 0xFF] ^ t[2][(d >> 8) & 0xFF] ^ t[1][(d >> 16) & 0xFF] ^ t[0][d >> 24];
+
+			data += 16;
+			length -= 16;
+		}
+
+		while (length--)
+		{
+			crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+		}
+
+		return crc;
+	}
+
+#ifdef NATCRC32_X64
+	nBool CpuSupportsPclmul() noexcept
+	{
+#ifdef _MSC_VER
+		int cpuInfo[4];
+		__cpuid(cpuInfo, 1);
+		return (cpuInfo[2] & (1 << 1)) != 0 && (cpuInfo[2] & (1 << 19)) != 0;
+#else
+		unsigned eax, ebx, ecx, edx;
+		return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_PCLMUL) != 0 && (ecx & bit_SSE4_1) != 0;
+#endif
+	}
+
+	const nBool g_CpuSupportsPclmul = CpuSupportsPclmul();
+
+	constexpr size_t PclmulMinLength = 64;
+
+	// οIntelƤ Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction
+	// ʵʾlength벻С64Ϊ16ıcrcΪδȡڲ״̬
+	NATCRC32_TARGET_PCLMUL nuInt UpdatePclmul(nuInt crc, ncData data, size_t length) noexcept
+	{
+		// һ۵4õĳ
+		const auto k1k2 = _mm_set_epi64x(0x01C6E41596, 0x0154442BD4);
+		// һ۵1õĳ
+		const auto k3k4 = _mm_set_epi64x(0x00CCAA009E, 0x01751997D0);
+		// 96λԼ64λõĳ
+		const auto k5 = _mm_set_epi64x(0, 0x0163CD6124);
+		// BarrettԼõPmu
+		const auto poly = _mm_set_epi64x(0x01F7011641, 0x01DB710641);
+		const auto mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+		auto x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+		auto x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+		auto x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32));
+		auto x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48));
+		x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+
+		data += 64;
+		length -= 64;
+
+		// ͬʱ۵4128λĿ
+		while (length >= 64)
+		{
+			const auto x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+			const auto x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+			const auto x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+			const auto x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+
+			x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+			x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+			x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+			x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+			x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)));
+			x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)));
+			x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)));
+
+			data += 64;
+			length -= 64;
+		}
+
+		// ϲΪ1128λĿ
+		auto x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+		x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+		x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+		// ʣ16ֽڵĿ
+		while (length >= 16)
+		{
+			x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+			x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data))), x5);
+
+			data += 16;
+			length -= 16;
+		}
+
+		// 128λ۵Ϊ64λ
+		auto x6 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+		x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x6);
+
+		x6 = _mm_srli_si128(x1, 4);
+		x1 = _mm_and_si128(x1, mask32);
+		x1 = _mm_clmulepi64_si128(x1, k5, 0x00);
+		x1 = _mm_xor_si128(x1, x6);
+
+		// BarrettԼΪ32λ
+		x6 = _mm_and_si128(x1, mask32);
+		x6 = _mm_clmulepi64_si128(x6, poly, 0x10);
+		x6 = _mm_and_si128(x6, mask32);
+		x6 = _mm_clmulepi64_si128(x6, poly, 0x00);
+		x1 = _mm_xor_si128(x1, x6);
+
+		return static_cast<nuInt>(_mm_extract_epi32(x1, 1));
+	}
+#endif
+
+	//  a * b mod P
+	nuInt MultModP(nuInt a, nuInt b) noexcept
+	{
+		nuInt m = 1u << 31, p = 0;
+		while (true)
+		{
+			if (a & m)
+			{
+				p ^= b;
+				if ((a & (m - 1)) == 0)
+				{
+					break;
+				}
+			}
+			m >>= 1;
+			b = b & 1 ? (b >> 1) ^ Polynomial : b >> 1;
+		}
+		return p;
+	}
+
+	// X2nTable[k]Ϊ x^(2^k) mod P
+	struct X2nTable
+	{
+		nuInt Table[32];
+
+		X2nTable() noexcept
+		{
+			auto p = 1u << 30;	// x^1
+			Table[0] = p;
+			for (size_t n = 1; n < 32; ++n)
+			{
+				Table[n] = p = MultModP(p, p);
+			}
+		}
+	};
+
+	//  x^(n * 2^k) mod P
+	nuInt X2nModP(nuLong n, size_t k) noexcept
+	{
+		static const X2nTable s_Table;
+
+		auto p = 1u << 31;	// x^0
+		while (n)
+		{
+			if (n & 1)
+			{
+				p = MultModP(s_Table.Table[k & 31], p);
+			}
+			n >>= 1;
+			++k;
+		}
+		return p;
+	}
+}
+
+nuInt Crc32::Update(nuInt crc, ncData data, size_t length) noexcept
+{
+	if (!data || !length)
+	{
+		return crc;
+	}
+
+	crc = ~crc;
+
+#ifdef NATCRC32_X64
+	if (g_CpuSupportsPclmul && length >= PclmulMinLength)
+	{
+		const auto foldLength = length & ~static_cast<size_t>(15);
+		crc = UpdatePclmul(crc, data, foldLength);
+		data += foldLength;
+		length -= foldLength;
+	}
+#endif
+
+	return ~UpdateSlicingBy16(crc, data, length);
+}
+
+nuInt Crc32::Combine(nuInt crc1, nuInt crc2, nuLong length2) noexcept
+{
+	// length2ֽڼ 8 * length2 = length2 * 2^3 λ
+	return MultModP(X2nModP(length2, 3), crc1) ^ crc2;
+}
+
+nBool Crc32::IsHardwareAccelerated() noexcept
+{
+#ifdef NATCRC32_X64
+	return g_CpuSupportsPclmul;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,34 @@
+////////////////////////////////////////////////////////////////////////////////
+///	@file	natCrc32.h
+///	@brief	CRC-32
+///	@note	ʹzlibͬĶʽ0xEDB88320䣩ֵ/ȡԼzlibcrc32һ
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "natConfig.h"
+#include "natType.h"
+#include <cstddef>
+
+namespace NatsuLib
+{
+	namespace Crc32
+	{
+		///	@brief		ݸCRC-32
+		///	@param[in]	crc		֮ǰCRC-32μʱΪ0
+		///	@param[in]	data	
+		///	@param[in]	length	ݳ
+		///	@return		ºCRC-32
+		///	@note		ʱݴ֧ѡʵ֣x86֧PCLMULQDQʱʹ۵㷨ʹslicing-by-16
+		nuInt Update(nuInt crc, ncData data, std::size_t length) noexcept;
+
+		///	@brief		ϲݵCRC-32
+		///	@param[in]	crc1	ǰһݵCRC-32
+		///	@param[in]	crc2	һݵCRC-32
+		///	@param[in]	length2	һݵĳ
+		///	@return		ӺCRC-32
+		///	@note		ںϲмĲֽӶΪO(log(length2))
+		nuInt Combine(nuInt crc1, nuInt crc2, nuLong length2) noexcept;
+
+		///	@brief	UpdateǷʹӲٵʵ
+		nBool IsHardwareAccelerated() noexcept;
+	}
+}
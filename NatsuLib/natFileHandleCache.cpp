@@ -0,0 +1,528 @@
+#include "stdafx.h"
+#include "natFileHandleCache.h"
+#include "natException.h"
+
+#ifndef _WIN32
+#	include <fcntl.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#	include <cerrno>
+#endif
+
+#ifdef __linux__
+#	include <sys/inotify.h>
+#endif
+
+using namespace NatsuLib;
+
+#ifdef __linux__
+namespace
+{
+	// ʵʾIN_ATTRIBı仯ǻɾļʱʹȻҲյ֪ͨ
+	constexpr uint32_t WatchMask = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF;
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+///	@brief	ֻ
+///	@note	ReadAt޸ľ״̬Ա߳ͬʱ
+////////////////////////////////////////////////////////////////////////////////
+class natFileHandleCache::SharedHandle final
+	: public natRefObjImpl<natRefObj>, public nonmovable
+{
+public:
+	explicit SharedHandle(nString const& path)
+	{
+#ifdef _WIN32
+		m_hFile = CreateFile(
+#ifdef UNICODE
+			WideString{ path }.data(),
+#else
+			AnsiString{ path }.data(),
+#endif
+			GENERIC_READ,
+			// ʵʾľӦ޸Ļɾļ
+			FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			NULL,
+			OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL,
+			NULL
+		);
+
+		if (!m_hFile || m_hFile == INVALID_HANDLE_VALUE)
+		{
+			nat_Throw(natWinException, "Open file \"{0}\" failed"_nv, path);
+		}
+
+		BY_HANDLE_FILE_INFORMATION info;
+		if (!GetFileInformationByHandle(m_hFile, &info))
+		{
+			CloseHandle(m_hFile);
+			nat_Throw(natWinException, "GetFileInformationByHandle failed."_nv);
+		}
+
+		m_Size = static_cast<nLen>(info.nFileSizeHigh) << 32 | info.nFileSizeLow;
+		m_LastWriteTime = info.ftLastWriteTime;
+#else
+		m_Fd = open(path.data(), O_RDONLY | O_CLOEXEC);
+		if (m_Fd < 0)
+		{
+			nat_Throw(natErrException, NatErr_InternalErr, "Cannot open file \"{0}\"."_nv, path);
+		}
+
+		struct stat fileStat;
+		if (fstat(m_Fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
+		{
+			close(m_Fd);
+			nat_Throw(natErrException, NatErr_InvalidArg, "\"{0}\" is not a regular file."_nv, path);
+		}
+
+		m_Size = static_cast<nLen>(fileStat.st_size);
+		m_Inode = fileStat.st_ino;
+		m_LastWriteTime = fileStat.st_mtime;
+#endif
+	}
+
+	~SharedHandle()
+	{
+#ifdef _WIN32
+		CloseHandle(m_hFile);
+#else
+		close(m_Fd);
+#endif
+	}
+
+	nLen GetSize() const noexcept
+	{
+		return m_Size;
+	}
+
+	///	@brief	offsetȡ
+	///	@return	ʵʶȡֽڵļĩβʱСlength
+	size_t ReadAt(nLen offset, nData data, size_t length) const
+	{
+		size_t totalRead{};
+		while (totalRead < length)
+		{
+#ifdef _WIN32
+			OVERLAPPED overlapped{};
+			overlapped.Offset = static_cast<DWORD>(offset);
+			overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+			DWORD readBytes;
+			const auto chunk = static_cast<DWORD>(std::min<size_t>(length - totalRead, std::numeric_limits<DWORD>::max()));
+			if (!ReadFile(m_hFile, data + totalRead, chunk, &readBytes, &overlapped))
+			{
+				if (GetLastError() == ERROR_HANDLE_EOF)
+				{
+					break;
+				}
+				nat_Throw(natWinException, "ReadFile failed."_nv);
+			}
+#else
+			const auto readBytes = pread(m_Fd, data + totalRead, length - totalRead, static_cast<off_t>(offset));
+			if (readBytes < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				nat_Throw(natErrException, NatErr_InternalErr, "pread failed with errno {0}."_nv, errno);
+			}
+#endif
+			if (!readBytes)
+			{
+				break;
+			}
+			totalRead += static_cast<size_t>(readBytes);
+			offset += static_cast<nLen>(readBytes);
+		}
+		return totalRead;
+	}
+
+	///	@brief	pathϵļǷǴʱļ
+	///	@note	ȽļĴС޸ʱ䣬ִܷС޸ʱδı޸
+	nBool IsUpToDate(nString const& path) const noexcept
+	{
+#ifdef _WIN32
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+		if (!GetFileAttributesEx(
+#ifdef UNICODE
+			WideString{ path }.data(),
+#else
+			AnsiString{ path }.data(),
+#endif
+			GetFileExInfoStandard, &attributes))
+		{
+			return false;
+		}
+
+		return (static_cast<nLen>(attributes.nFileSizeHigh) << 32 | attributes.nFileSizeLow) == m_Size &&
+			CompareFileTime(&attributes.ftLastWriteTime, &m_LastWriteTime) == 0;
+#else
+		struct stat fileStat;
+		return stat(path.data(), &fileStat) == 0 && fileStat.st_ino == m_Inode &&
+			static_cast<nLen>(fileStat.st_size) == m_Size && fileStat.st_mtime == m_LastWriteTime;
+#endif
+	}
+
+private:
+#ifdef _WIN32
+	HANDLE m_hFile;
+	FILETIME m_LastWriteTime;
+#else
+	int m_Fd;
+	ino_t m_Inode;
+	time_t m_LastWriteTime;
+#endif
+	nLen m_Size;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///	@brief	Զλȡʹֻ
+////////////////////////////////////////////////////////////////////////////////
+class natFileHandleCache::CachedFileStream final
+	: public natRefObjImpl<natStream>
+{
+public:
+	explicit CachedFileStream(natRefPointer<SharedHandle> handle)
+		: m_Handle{ std::move(handle) }, m_Position{}
+	{
+	}
+
+	nBool CanWrite() const override
+	{
+		return false;
+	}
+
+	nBool CanRead() const override
+	{
+		return true;
+	}
+
+	nBool CanResize() const override
+	{
+		return false;
+	}
+
+	nBool CanSeek() const override
+	{
+		return true;
+	}
+
+	nBool IsEndOfStream() const override
+	{
+		return m_Position >= m_Handle->GetSize();
+	}
+
+	nLen GetSize() const override
+	{
+		return m_Handle->GetSize();
+	}
+
+	void SetSize(nLen /*Size*/) override
+	{
+		nat_Throw(natErrException, NatErr_NotSupport, "This stream cannot be resized."_nv);
+	}
+
+	nLen GetPosition() const override
+	{
+		return m_Position;
+	}
+
+	void SetPosition(NatSeek Origin, nLong Offset) override
+	{
+		const auto size = static_cast<nLong>(m_Handle->GetSize());
+		nLong position;
+		switch (Origin)
+		{
+		case NatSeek::Beg:
+			position = Offset;
+			break;
+		case NatSeek::Cur:
+			position = static_cast<nLong>(m_Position) + Offset;
+			break;
+		case NatSeek::End:
+			position = size + Offset;
+			break;
+		default:
+			nat_Throw(natErrException, NatErr_OutOfRange, "Out of range."_nv);
+		}
+
+		if (position < 0 || position > size)
+		{
+			nat_Throw(natErrException, NatErr_OutOfRange, "Out of range."_nv);
+		}
+
+		m_Position = static_cast<nLen>(position);
+	}
+
+	nLen ReadBytes(nData pData, nLen Length) override
+	{
+		const auto size = m_Handle->GetSize();
+		const auto length = static_cast<size_t>(std::min(Length, size - std::min(m_Position, size)));
+		if (!length)
+		{
+			return 0;
+		}
+
+		const auto readBytes = m_Handle->ReadAt(m_Position, pData, length);
+		m_Position += readBytes;
+		return readBytes;
+	}
+
+	nLen WriteBytes(ncData /*pData*/, nLen /*Length*/) override
+	{
+		nat_Throw(natErrException, NatErr_IllegalState, "Stream is not writable."_nv);
+	}
+
+	void Flush() override
+	{
+	}
+
+private:
+	const natRefPointer<SharedHandle> m_Handle;
+	nLen m_Position;
+};
+
+natFileHandleCache::natFileHandleCache(size_t maxOpenHandles)
+	: m_MaxOpenHandles{ maxOpenHandles }
+{
+#ifdef __linux__
+	// ʵʾʧʱ˻ΪʱļǷ仯
+	m_InotifyFd = maxOpenHandles ? inotify_init1(IN_NONBLOCK | IN_CLOEXEC) : -1;
+#endif
+}
+
+natFileHandleCache::~natFileHandleCache()
+{
+#ifdef __linux__
+	if (m_InotifyFd >= 0)
+	{
+		close(m_InotifyFd);
+	}
+#endif
+}
+
+natRefPointer<natStream> natFileHandleCache::OpenRead(nStrView path)
+{
+	nString key{ path };
+
+	if (!m_MaxOpenHandles)
+	{
+		return make_ref<CachedFileStream>(make_ref<SharedHandle>(key));
+	}
+
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+
+#ifdef __linux__
+	processEvents();
+#endif
+
+	const auto iter = m_EntryMap.find(key);
+	if (iter != m_EntryMap.end())
+	{
+		auto& entry = iter->second;
+		if (entry.WatchDescriptor >= 0 || entry.Handle->IsUpToDate(key))
+		{
+			m_LruList.splice(m_LruList.begin(), m_LruList, entry.LruIterator);
+			return make_ref<CachedFileStream>(entry.Handle);
+		}
+
+		eraseEntry(iter, true);
+	}
+
+	// ʵʾڴǰʼӣ뿪ʼ֮޸Ľᱻ
+	int watchDescriptor = -1;
+#ifdef __linux__
+	watchDescriptor = addWatch(key);
+#endif
+
+	natRefPointer<SharedHandle> handle;
+	try
+	{
+		handle = make_ref<SharedHandle>(key);
+	}
+	catch (...)
+	{
+#ifdef __linux__
+		releaseWatch(watchDescriptor, key);
+#endif
+		throw;
+	}
+
+	while (m_EntryMap.size() >= m_MaxOpenHandles)
+	{
+		eraseEntry(m_EntryMap.find(m_LruList.back()), true);
+	}
+
+	m_LruList.emplace_front(key);
+	m_EntryMap.emplace(std::move(key), CacheEntry{ handle, m_LruList.begin(), watchDescriptor });
+
+	return make_ref<CachedFileStream>(std::move(handle));
+}
+
+nBool natFileHandleCache::Invalidate(nStrView path)
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+
+	const auto iter = m_EntryMap.find(nString{ path });
+	if (iter == m_EntryMap.end())
+	{
+		return false;
+	}
+
+	eraseEntry(iter, true);
+	return true;
+}
+
+void natFileHandleCache::Clear()
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+
+#ifdef __linux__
+	for (const auto& watch : m_WatchMap)
+	{
+		inotify_rm_watch(m_InotifyFd, watch.first);
+	}
+	m_WatchMap.clear();
+#endif
+
+	m_EntryMap.clear();
+	m_LruList.clear();
+}
+
+size_t natFileHandleCache::GetOpenHandleCount() const
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	return m_EntryMap.size();
+}
+
+size_t natFileHandleCache::GetMaxOpenHandles() const noexcept
+{
+	return m_MaxOpenHandles;
+}
+
+nBool natFileHandleCache::IsWatching() const noexcept
+{
+#ifdef __linux__
+	return m_InotifyFd >= 0;
+#else
+	return false;
+#endif
+}
+
+#ifdef __linux__
+int natFileHandleCache::addWatch(nString const& path)
+{
+	if (m_InotifyFd < 0)
+	{
+		return -1;
+	}
+
+	// ʵʾͬһļԲͬ·ʱõͬļ
+	const auto watchDescriptor = inotify_add_watch(m_InotifyFd, path.data(), WatchMask);
+	if (watchDescriptor >= 0)
+	{
+		m_WatchMap[watchDescriptor].emplace_back(path);
+	}
+	return watchDescriptor;
+}
+
+void natFileHandleCache::releaseWatch(int watchDescriptor, nString const& path)
+{
+	const auto watchIter = m_WatchMap.find(watchDescriptor);
+	if (watchIter == m_WatchMap.end())
+	{
+		return;
+	}
+
+	auto& paths = watchIter->second;
+	const auto pathIter = std::find(paths.begin(), paths.end(), path);
+	if (pathIter != paths.end())
+	{
+		paths.erase(pathIter);
+	}
+
+	if (paths.empty())
+	{
+		inotify_rm_watch(m_InotifyFd, watchDescriptor);
+		m_WatchMap.erase(watchIter);
+	}
+}
+
+void natFileHandleCache::processEvents()
+{
+	if (m_InotifyFd < 0)
+	{
+		return;
+	}
+
+	alignas(inotify_event) char buffer[4096];
+	while (true)
+	{
+		const auto length = read(m_InotifyFd, buffer, sizeof buffer);
+		if (length <= 0)
+		{
+			// ʵʾȡEAGAINʾûи¼
+			break;
+		}
+
+		for (auto pRead = buffer; pRead < buffer + length;)
+		{
+			const auto event = reinterpret_cast<const inotify_event*>(pRead);
+			pRead += sizeof(inotify_event) + event->len;
+
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				// ʧ˲¼޷֪Щļ˱仯
+				for (const auto& watch : m_WatchMap)
+				{
+					inotify_rm_watch(m_InotifyFd, watch.first);
+				}
+				m_WatchMap.clear();
+				m_EntryMap.clear();
+				m_LruList.clear();
+				continue;
+			}
+
+			const auto watchIter = m_WatchMap.find(event->wd);
+			if (watchIter == m_WatchMap.end())
+			{
+				// ƳļӣƳIN_IGNORED
+				continue;
+			}
+
+			const auto paths = std::move(watchIter->second);
+			m_WatchMap.erase(watchIter);
+			if (!(event->mask & IN_IGNORED))
+			{
+				inotify_rm_watch(m_InotifyFd, event->wd);
+			}
+
+			for (const auto& path : paths)
+			{
+				const auto iter = m_EntryMap.find(path);
+				if (iter != m_EntryMap.end())
+				{
+					eraseEntry(iter, false);
+				}
+			}
+		}
+	}
+}
+#endif
+
+void natFileHandleCache::eraseEntry(EntryMap::iterator iter, nBool shouldReleaseWatch)
+{
+#ifdef __linux__
+	if (shouldReleaseWatch)
+	{
+		releaseWatch(iter->second.WatchDescriptor, iter->first);
+	}
+#else
+	static_cast<void>(shouldReleaseWatch);
+#endif
+
+	m_LruList.erase(iter->second.LruIterator);
+	m_EntryMap.erase(iter);
+}
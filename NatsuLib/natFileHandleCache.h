@@ -0,0 +1,80 @@
+#pragma once
+#include "natRefObj.h"
+#include "natStream.h"
+#include "natMultiThread.h"
+#include <list>
+#include <unordered_map>
+
+namespace NatsuLib
+{
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	ֻļ
+	///	@note	·޸򿪵ֻʱرδʹõľ
+	///			ͬһļĶȡͬһάȡλòԶλȡļӰ
+	///			Linuxinotifyӻļļ޸ġƶɾʱӦľ
+	///			ƽ̨ÿδʱȽļĴС޸ʱжϾǷ
+	///			ӰѴ򿪵ЩԶȡʱļ
+	///			зΪ̰߳ȫ
+	////////////////////////////////////////////////////////////////////////////////
+	class natFileHandleCache final
+		: public natRefObjImpl<natRefObj>, public nonmovable
+	{
+	public:
+		enum : size_t
+		{
+			DefaultMaxOpenHandles = 64,
+		};
+
+		///	@brief	
+		///	@param[in]	maxOpenHandles	ľΪ0ʱ
+		explicit natFileHandleCache(size_t maxOpenHandles = DefaultMaxOpenHandles);
+		~natFileHandleCache();
+
+		///	@brief	ֻʽļ
+		///	@return	ľֻԶλСΪʱļĴС
+		natRefPointer<natStream> OpenRead(nStrView path);
+
+		///	@brief	·Ӧľ
+		///	@return	Ƿ·Ӧľ
+		nBool Invalidate(nStrView path);
+		void Clear();
+
+		size_t GetOpenHandleCount() const;
+		size_t GetMaxOpenHandles() const noexcept;
+
+		///	@brief	Ƿļϵͳ֪ͨӻļ
+		///	@note	ΪfalseʱÿδʱļǷ仯
+		nBool IsWatching() const noexcept;
+
+	private:
+		class SharedHandle;
+		class CachedFileStream;
+
+		typedef std::list<nString> LruList;
+
+		struct CacheEntry
+		{
+			natRefPointer<SharedHandle> Handle;
+			LruList::iterator LruIterator;
+			int WatchDescriptor;
+		};
+
+		typedef std::unordered_map<nString, CacheEntry> EntryMap;
+
+		const size_t m_MaxOpenHandles;
+		mutable natCriticalSection m_Section;
+		LruList m_LruList;
+		EntryMap m_EntryMap;
+
+#ifdef __linux__
+		int m_InotifyFd;
+		std::unordered_map<int, std::vector<nString>> m_WatchMap;
+
+		int addWatch(nString const& path);
+		void releaseWatch(int watchDescriptor, nString const& path);
+		void processEvents();
+#endif
+
+		void eraseEntry(EntryMap::iterator iter, nBool shouldReleaseWatch);
+	};
+}
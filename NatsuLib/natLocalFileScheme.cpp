@@ -1,8 +1,144 @@
 #include "stdafx.h"
 #include "natLocalFileScheme.h"
 
+#include "natException.h"
+
+#ifndef _WIN32
+#	include <sys/stat.h>
+#	include <dirent.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <cerrno>
+#endif
+
+#ifdef __linux__
+#	include <sys/syscall.h>
+#endif
+
 using namespace NatsuLib;
 
+namespace
+{
+#ifdef _WIN32
+	std::chrono::system_clock::time_point ToTimePoint(FILETIME const& fileTime) noexcept
+	{
+		// FILETIMEΪ160111100
+		constexpr nuLong EpochDifference = 116444736000000000ull;
+		const auto ticks = static_cast<nuLong>(fileTime.dwHighDateTime) << 32 | fileTime.dwLowDateTime;
+		return std::chrono::system_clock::time_point{ std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds{ (static_cast<nLong>(ticks) - static_cast<nLong>(EpochDifference)) * 100 }) };
+	}
+
+	ResourceType AttributesToResourceType(DWORD attributes) noexcept
+	{
+		if (attributes & FILE_ATTRIBUTE_REPARSE_POINT)
+		{
+			return ResourceType::Other;
+		}
+		return attributes & FILE_ATTRIBUTE_DIRECTORY ? ResourceType::Directory : ResourceType::File;
+	}
+#else
+	std::chrono::system_clock::time_point ToTimePoint(nLong seconds, nLong nanoseconds) noexcept
+	{
+		return std::chrono::system_clock::time_point{ std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::seconds{ seconds } + std::chrono::nanoseconds{ nanoseconds }) };
+	}
+
+	ResourceType ModeToResourceType(mode_t mode) noexcept
+	{
+		if (S_ISREG(mode))
+		{
+			return ResourceType::File;
+		}
+		return S_ISDIR(mode) ? ResourceType::Directory : ResourceType::Other;
+	}
+
+	// Ŀ¼״̬dirFdΪAT_FDCWDʱڵǰĿ¼
+	nBool StatAt(int dirFd, const char* name, nBool followSymlink, ResourceStat& stat) noexcept
+	{
+#if defined(__linux__) && defined(STATX_TYPE)
+		// ʵʾstatxҪֶΣļϵͳϿܸۣں˻ɳ䲻֧ʱ˻Ϊfstatat
+		struct statx fileStatx;
+		if (statx(dirFd, name, (followSymlink ? 0 : AT_SYMLINK_NOFOLLOW) | AT_STATX_SYNC_AS_STAT, STATX_TYPE | STATX_SIZE | STATX_MTIME, &fileStatx) == 0)
+		{
+			stat.Type = ModeToResourceType(fileStatx.stx_mode);
+			stat.Size = fileStatx.stx_size;
+			stat.LastWriteTime = ToTimePoint(fileStatx.stx_mtime.tv_sec, fileStatx.stx_mtime.tv_nsec);
+			return true;
+		}
+
+		if (errno == ENOENT || errno == ENOTDIR)
+		{
+			return false;
+		}
+#endif
+
+		struct stat fileStat;
+		if (fstatat(dirFd, name, &fileStat, followSymlink ? 0 : AT_SYMLINK_NOFOLLOW) != 0)
+		{
+			return false;
+		}
+
+		stat.Type = ModeToResourceType(fileStat.st_mode);
+		stat.Size = static_cast<nLen>(fileStat.st_size);
+#ifdef __APPLE__
+		stat.LastWriteTime = ToTimePoint(fileStat.st_mtimespec.tv_sec, fileStat.st_mtimespec.tv_nsec);
+#else
+		stat.LastWriteTime = ToTimePoint(fileStat.st_mtim.tv_sec, fileStat.st_mtim.tv_nsec);
+#endif
+		return true;
+	}
+
+	ResourceType DirentTypeToResourceType(unsigned char direntType) noexcept
+	{
+		switch (direntType)
+		{
+		case DT_REG:
+			return ResourceType::File;
+		case DT_DIR:
+			return ResourceType::Directory;
+		case DT_UNKNOWN:
+			return ResourceType::Unknown;
+		default:
+			return ResourceType::Other;
+		}
+	}
+
+	nBool IsDotOrDotDot(const char* name) noexcept
+	{
+		return name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0));
+	}
+
+	void AddDirectoryEntry(std::vector<DirectoryEntry>& entries, int dirFd, const char* name, unsigned char direntType, nBool withStat)
+	{
+		if (IsDotOrDotDot(name))
+		{
+			return;
+		}
+
+		DirectoryEntry entry{ name, ResourceStat{ DirentTypeToResourceType(direntType), 0, {} } };
+		if (withStat && !StatAt(dirFd, name, false, entry.Stat))
+		{
+			// ö֮ɾ
+			return;
+		}
+		entries.emplace_back(std::move(entry));
+	}
+#endif
+
+#ifdef __linux__
+	// ʵʾglibcδ˽ṹں˵Ķ屣һ
+	struct LinuxDirent64
+	{
+		nuLong d_ino;
+		nLong d_off;
+		unsigned short d_reclen;
+		unsigned char d_type;
+		char d_name[1];
+	};
+
+	constexpr size_t DirentBufferSize = 64 * 1024;
+#endif
+}
+
 nStrView LocalFileScheme::GetSchemeName() const noexcept
 {
 	return "file";
@@ -10,14 +146,187 @@ nStrView LocalFileScheme::GetSchemeName() const noexcept
 
 natRefPointer<IRequest> LocalFileScheme::CreateRequest(Uri const& uri)
 {
-	return make_ref<LocalFileRequest>(uri);
+	return make_ref<LocalFileRequest>(uri, GetHandleCache());
+}
+
+nBool LocalFileScheme::Exists(Uri const& uri)
+{
+	const auto realPath = detail_::GetFullPath(uri);
+
+#ifdef _WIN32
+	const auto attributes = GetFileAttributes(
+#ifdef UNICODE
+		WideString{ realPath }.data()
+#else
+		AnsiString{ realPath }.data()
+#endif
+		);
+	return attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+	struct stat fileStat;
+	return stat(realPath.data(), &fileStat) == 0 && S_ISREG(fileStat.st_mode);
+#endif
+}
+
+void LocalFileScheme::SetHandleCache(natRefPointer<natFileHandleCache> handleCache)
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	m_HandleCache = std::move(handleCache);
+}
+
+natRefPointer<natFileHandleCache> LocalFileScheme::GetHandleCache() const
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	return m_HandleCache;
+}
+
+Optional<ResourceStat> LocalFileScheme::Stat(Uri const& uri)
+{
+	const auto realPath = detail_::GetFullPath(uri);
+
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesEx(
+#ifdef UNICODE
+		WideString{ realPath }.data(),
+#else
+		AnsiString{ realPath }.data(),
+#endif
+		GetFileExInfoStandard, &attributes))
+	{
+		return {};
+	}
+
+	return ResourceStat{ AttributesToResourceType(attributes.dwFileAttributes), static_cast<nLen>(attributes.nFileSizeHigh) << 32 | attributes.nFileSizeLow, ToTimePoint(attributes.ftLastWriteTime) };
+#else
+	ResourceStat stat;
+	if (!StatAt(AT_FDCWD, realPath.empty() ? "." : realPath.data(), true, stat))
+	{
+		return {};
+	}
+	return stat;
+#endif
+}
+
+std::vector<DirectoryEntry> LocalFileScheme::EnumerateDirectory(Uri const& uri, nBool withStat)
+{
+	const auto realPath = detail_::GetFullPath(uri);
+	std::vector<DirectoryEntry> entries;
+
+#ifdef _WIN32
+	static_cast<void>(withStat);
+
+	WIN32_FIND_DATA findData;
+	// ʵʾFindExInfoBasicѯļFIND_FIRST_EX_LARGE_FETCHʹÿε÷ظ
+	const auto hFind = FindFirstFileEx(
+#ifdef UNICODE
+		WideString{ natUtil::FormatString("{0}/*", realPath) }.data(),
+#else
+		AnsiString{ natUtil::FormatString("{0}/*", realPath) }.data(),
+#endif
+		FindExInfoBasic, &findData, FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+	if (hFind == INVALID_HANDLE_VALUE)
+	{
+		nat_Throw(natWinException, "Cannot open directory \"{0}\"."_nv, realPath);
+	}
+
+	const auto scope = make_scope([hFind]
+	{
+		FindClose(hFind);
+	});
+
+	do
+	{
+		const auto name = findData.cFileName;
+		if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0)))
+		{
+			continue;
+		}
+
+		entries.push_back(DirectoryEntry{
+#ifdef UNICODE
+			WideStringView{ name },
+#else
+			AnsiStringView{ name },
+#endif
+			ResourceStat{ AttributesToResourceType(findData.dwFileAttributes), static_cast<nLen>(findData.nFileSizeHigh) << 32 | findData.nFileSizeLow, ToTimePoint(findData.ftLastWriteTime) }
+		});
+	} while (FindNextFile(hFind, &findData));
+
+	if (GetLastError() != ERROR_NO_MORE_FILES)
+	{
+		nat_Throw(natWinException, "FindNextFile failed."_nv);
+	}
+#else
+	const auto dirFd = open(realPath.empty() ? "." : realPath.data(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (dirFd < 0)
+	{
+		nat_Throw(natErrException, errno == ENOENT ? NatErr_NotFound : NatErr_InternalErr, "Cannot open directory \"{0}\"."_nv, realPath);
+	}
+
+#ifdef __linux__
+	const auto scope = make_scope([dirFd]
+	{
+		close(dirFd);
+	});
+
+	// ʵʾÿεöȡܶĿ¼ϵͳõĴ
+	const auto buffer = std::make_unique<nuLong[]>(DirentBufferSize / sizeof(nuLong));
+	const auto pBuffer = reinterpret_cast<char*>(buffer.get());
+	while (true)
+	{
+		const auto readBytes = syscall(SYS_getdents64, dirFd, pBuffer, DirentBufferSize);
+		if (readBytes < 0)
+		{
+			nat_Throw(natErrException, NatErr_InternalErr, "getdents64 failed with errno {0}."_nv, errno);
+		}
+		if (!readBytes)
+		{
+			break;
+		}
+
+		for (long offset = 0; offset < readBytes;)
+		{
+			const auto dirent = reinterpret_cast<const LinuxDirent64*>(pBuffer + offset);
+			offset += dirent->d_reclen;
+			AddDirectoryEntry(entries, dirFd, dirent->d_name, dirent->d_type, withStat);
+		}
+	}
+#else
+	const auto dir = fdopendir(dirFd);
+	if (!dir)
+	{
+		close(dirFd);
+		nat_Throw(natErrException, NatErr_InternalErr, "fdopendir failed with errno {0}."_nv, errno);
+	}
+
+	const auto scope = make_scope([dir]
+	{
+		closedir(dir);
+	});
+
+	while (const auto dirent = readdir(dir))
+	{
+		AddDirectoryEntry(entries, dirFd, dirent->d_name, dirent->d_type, withStat);
+	}
+#endif
+#endif
+
+	return entries;
 }
 
 natRefPointer<IResponse> LocalFileRequest::GetResponse()
 {
-	nString realPath;
-	const auto host = m_Uri.GetHost();
-	realPath = host.empty() ? nString{ m_Uri.GetPath() } : natUtil::FormatString("{0}/{1}", m_Uri.GetHost(), m_Uri.GetPath());
+	const auto realPath = detail_::GetFullPath(m_Uri);
+
+	if (m_HandleCache && m_Readable && !m_Writable
+#ifdef _WIN32
+		&& !m_Async
+#endif
+		)
+	{
+		return make_ref<LocalFileResponse>(m_HandleCache->OpenRead(realPath));
+	}
 
 	return make_ref<LocalFileResponse>(make_ref<natFileStream>(realPath, m_Readable, m_Writable
 #ifdef _WIN32
@@ -58,8 +367,8 @@ nBool LocalFileRequest::IsAsync() const noexcept
 }
 #endif
 
-LocalFileRequest::LocalFileRequest(Uri const& uri)
-	: m_Uri{ uri }, m_Readable{ true }, m_Writable{ false }
+LocalFileRequest::LocalFileRequest(Uri const& uri, natRefPointer<natFileHandleCache> handleCache)
+	: m_Uri{ uri }, m_HandleCache{ std::move(handleCache) }, m_Readable{ true }, m_Writable{ false }
 #ifdef _WIN32
 		, m_Async{ false }
 #endif
@@ -71,7 +380,7 @@ natRefPointer<natStream> LocalFileResponse::GetResponseStream()
 	return m_InternalStream;
 }
 
-LocalFileResponse::LocalFileResponse(natRefPointer<natFileStream> stream)
+LocalFileResponse::LocalFileResponse(natRefPointer<natStream> stream)
 	: m_InternalStream{ std::move(stream) }
 {
 }
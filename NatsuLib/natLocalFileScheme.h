@@ -9,13 +9,30 @@ namespace NatsuLib
 	public:
 		nStrView GetSchemeName() const noexcept override;
 		natRefPointer<IRequest> CreateRequest(Uri const& uri) override;
+		nBool Exists(Uri const& uri) override;
+		///	@brief	ļĿ¼״̬
+		///	@note	
+		Optional<ResourceStat> Stat(Uri const& uri) override;
+		///	@brief	öĿ¼е
+		///	@note	Linuxgetdents64ȡĿ¼״̬ʱstatxĿ¼ѯ
+		///			WindowsFindFirstFileExȡĿ¼Ѱ״̬
+		std::vector<DirectoryEntry> EnumerateDirectory(Uri const& uri, nBool withStat) override;
+
+		///	@brief	þ
+		///	@note	ú󴴽ֻʽļʱľΪnullptrʱʹû
+		void SetHandleCache(natRefPointer<natFileHandleCache> handleCache);
+		natRefPointer<natFileHandleCache> GetHandleCache() const;
+
+	private:
+		mutable natCriticalSection m_Section;
+		natRefPointer<natFileHandleCache> m_HandleCache;
 	};
 
 	class LocalFileRequest final
 		: public natRefObjImpl<IRequest>
 	{
 	public:
-		explicit LocalFileRequest(Uri const& uri);
+		explicit LocalFileRequest(Uri const& uri, natRefPointer<natFileHandleCache> handleCache = nullptr);
 
 		natRefPointer<IResponse> GetResponse() override;
 
@@ -32,6 +49,7 @@ namespace NatsuLib
 
 	private:
 		Uri m_Uri;
+		natRefPointer<natFileHandleCache> m_HandleCache;
 		nBool m_Readable;
 		nBool m_Writable;
 #ifdef _WIN32
@@ -43,11 +61,11 @@ namespace NatsuLib
 		: public natRefObjImpl<IResponse>
 	{
 	public:
-		explicit LocalFileResponse(natRefPointer<natFileStream> stream);
+		explicit LocalFileResponse(natRefPointer<natStream> stream);
 
 		natRefPointer<natStream> GetResponseStream() override;
 
 	private:
-		natRefPointer<natFileStream> m_InternalStream;
+		natRefPointer<natStream> m_InternalStream;
 	};
 }
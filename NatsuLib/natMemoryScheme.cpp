@@ -0,0 +1,362 @@
+#include "stdafx.h"
+#include "natMemoryScheme.h"
+#include "natException.h"
+
+using namespace NatsuLib;
+
+namespace
+{
+	// пֻ֤ͷǰЧ
+	class BlobReadStream
+		: public natExternMemoryStream
+	{
+	public:
+		explicit BlobReadStream(MemoryScheme::Blob blob)
+			: natExternMemoryStream(blob->empty() ? &s_EmptyData : blob->data(), blob->size(), true), m_Blob{ std::move(blob) }
+		{
+		}
+
+	private:
+		static const nByte s_EmptyData;
+
+		const MemoryScheme::Blob m_Blob;
+	};
+
+	const nByte BlobReadStream::s_EmptyData{};
+
+	// д״޸ʱŸƿ飬ύ¹ύĿ
+	class BlobWriteStream
+		: public natRefObjImpl<natStream>
+	{
+	public:
+		BlobWriteStream(natRefPointer<MemoryScheme> scheme, nString path, MemoryScheme::Blob blob)
+			: m_Scheme{ std::move(scheme) }, m_Path{ std::move(path) }, m_Blob{ std::move(blob) }, m_Position{}, m_Modified{ !m_Blob }
+		{
+			if (!m_Blob)
+			{
+				m_Blob = std::make_shared<const std::vector<nByte>>();
+			}
+		}
+
+		~BlobWriteStream()
+		{
+			try
+			{
+				Flush();
+			}
+			catch (...)
+			{
+				// ʵʾʱ޷Ҫ֪ʽFlush
+			}
+		}
+
+		nBool CanWrite() const override
+		{
+			return true;
+		}
+
+		nBool CanRead() const override
+		{
+			return true;
+		}
+
+		nBool CanResize() const override
+		{
+			return true;
+		}
+
+		nBool CanSeek() const override
+		{
+			return true;
+		}
+
+		nBool IsEndOfStream() const override
+		{
+			return m_Position >= getData().size();
+		}
+
+		nLen GetSize() const override
+		{
+			return getData().size();
+		}
+
+		void SetSize(nLen Size) override
+		{
+			if (Size == GetSize())
+			{
+				return;
+			}
+
+			auto& data = getMutableData();
+			data.resize(static_cast<size_t>(Size));
+			m_Position = std::min(m_Position, data.size());
+		}
+
+		nLen GetPosition() const override
+		{
+			return m_Position;
+		}
+
+		void SetPosition(NatSeek Origin, nLong Offset) override
+		{
+			const auto size = static_cast<nLong>(getData().size());
+			nLong position;
+			switch (Origin)
+			{
+			case NatSeek::Beg:
+				position = Offset;
+				break;
+			case NatSeek::Cur:
+				position = static_cast<nLong>(m_Position) + Offset;
+				break;
+			case NatSeek::End:
+				position = size + Offset;
+				break;
+			default:
+				nat_Throw(natErrException, NatErr_OutOfRange, "Out of range."_nv);
+			}
+
+			if (position < 0 || position > size)
+			{
+				nat_Throw(natErrException, NatErr_OutOfRange, "Out of range."_nv);
+			}
+
+			m_Position = static_cast<size_t>(position);
+		}
+
+		nLen ReadBytes(nData pData, nLen Length) override
+		{
+			const auto& data = getData();
+			const auto readBytes = static_cast<size_t>(std::min(Length, static_cast<nLen>(data.size() - std::min(m_Position, data.size()))));
+			if (readBytes)
+			{
+				std::memcpy(pData, data.data() + m_Position, readBytes);
+				m_Position += readBytes;
+			}
+			return readBytes;
+		}
+
+		nLen WriteBytes(ncData pData, nLen Length) override
+		{
+			if (!Length)
+			{
+				return 0;
+			}
+
+			auto& data = getMutableData();
+			const auto end = m_Position + static_cast<size_t>(Length);
+			if (end > data.size())
+			{
+				data.resize(end);
+			}
+			std::memcpy(data.data() + m_Position, pData, static_cast<size_t>(Length));
+			m_Position = end;
+			return Length;
+		}
+
+		void Flush() override
+		{
+			if (!m_Modified)
+			{
+				return;
+			}
+
+			// ʵʾύ뷽ͬһ飬ٴ޸ʱ¸
+			m_Blob = std::make_shared<const std::vector<nByte>>(std::move(m_Data));
+			m_Data = {};
+			m_Modified = false;
+			m_Scheme->SetBlob(m_Path, m_Blob);
+		}
+
+	private:
+		natRefPointer<MemoryScheme> m_Scheme;
+		nString m_Path;
+		MemoryScheme::Blob m_Blob;
+		std::vector<nByte> m_Data;
+		size_t m_Position;
+		nBool m_Modified;
+
+		std::vector<nByte> const& getData() const noexcept
+		{
+			return m_Modified ? m_Data : *m_Blob;
+		}
+
+		std::vector<nByte>& getMutableData()
+		{
+			if (!m_Modified)
+			{
+				m_Data = *m_Blob;
+				m_Modified = true;
+			}
+			return m_Data;
+		}
+	};
+}
+
+MemoryScheme::MemoryScheme()
+{
+}
+
+MemoryScheme::~MemoryScheme()
+{
+}
+
+nStrView MemoryScheme::GetSchemeName() const noexcept
+{
+	return "mem";
+}
+
+natRefPointer<IRequest> MemoryScheme::CreateRequest(Uri const& uri)
+{
+	return make_ref<MemoryRequest>(natRefPointer<MemoryScheme>{ this }, uri);
+}
+
+nBool MemoryScheme::Exists(Uri const& uri)
+{
+	const auto path = GetPath(uri);
+
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	return m_BlobMap.find(path) != m_BlobMap.end();
+}
+
+Optional<ResourceStat> MemoryScheme::Stat(Uri const& uri)
+{
+	const auto path = GetPath(uri);
+
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	const auto iter = m_BlobMap.find(path);
+	if (iter != m_BlobMap.end())
+	{
+		return ResourceStat{ ResourceType::File, iter->second->size(), {} };
+	}
+
+	detail_::FlatDirectoryLister lister{ path };
+	for (const auto& blob : m_BlobMap)
+	{
+		lister.Add(blob.first, blob.second->size());
+		if (lister.IsFound())
+		{
+			return ResourceStat{ ResourceType::Directory, 0, {} };
+		}
+	}
+
+	return {};
+}
+
+std::vector<DirectoryEntry> MemoryScheme::EnumerateDirectory(Uri const& uri, nBool /*withStat*/)
+{
+	const auto path = GetPath(uri);
+	detail_::FlatDirectoryLister lister{ path };
+
+	{
+		natRefScopeGuard<natCriticalSection> guard{ m_Section };
+		for (const auto& blob : m_BlobMap)
+		{
+			lister.Add(blob.first, blob.second->size());
+		}
+	}
+
+	if (!lister.IsFound())
+	{
+		nat_Throw(natErrException, NatErr_NotFound, "Directory \"{0}\" is not found in memory scheme."_nv, path);
+	}
+
+	return lister.GetEntries();
+}
+
+void MemoryScheme::SetBlob(nStrView path, Blob blob)
+{
+	if (!blob)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "blob should be a valid pointer."_nv);
+	}
+
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	m_BlobMap[path] = std::move(blob);
+}
+
+void MemoryScheme::SetBlob(nStrView path, std::vector<nByte> data)
+{
+	SetBlob(path, std::make_shared<const std::vector<nByte>>(std::move(data)));
+}
+
+void MemoryScheme::SetBlob(nStrView path, ncData data, size_t size)
+{
+	SetBlob(path, std::vector<nByte>(data, data + size));
+}
+
+MemoryScheme::Blob MemoryScheme::GetBlob(nStrView path) const
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	const auto iter = m_BlobMap.find(path);
+	return iter != m_BlobMap.end() ? iter->second : nullptr;
+}
+
+nBool MemoryScheme::RemoveBlob(nStrView path)
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	return m_BlobMap.erase(path) != 0;
+}
+
+size_t MemoryScheme::GetBlobCount() const
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	return m_BlobMap.size();
+}
+
+void MemoryScheme::Clear()
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	m_BlobMap.clear();
+}
+
+nString MemoryScheme::GetPath(Uri const& uri)
+{
+	return detail_::GetFullPath(uri);
+}
+
+MemoryRequest::MemoryRequest(natRefPointer<MemoryScheme> scheme, Uri const& uri)
+	: m_Scheme{ std::move(scheme) }, m_Path{ MemoryScheme::GetPath(uri) }, m_Writable{ false }
+{
+}
+
+natRefPointer<IResponse> MemoryRequest::GetResponse()
+{
+	auto blob = m_Scheme->GetBlob(m_Path);
+	if (m_Writable)
+	{
+		return make_ref<MemoryResponse>(make_ref<BlobWriteStream>(m_Scheme, m_Path, std::move(blob)));
+	}
+
+	if (!blob)
+	{
+		nat_Throw(natErrException, NatErr_NotFound, "\"{0}\" is not found in memory scheme."_nv, m_Path);
+	}
+
+	return make_ref<MemoryResponse>(make_ref<BlobReadStream>(std::move(blob)));
+}
+
+void MemoryRequest::SetWritable(nBool value) noexcept
+{
+	m_Writable = value;
+}
+
+nBool MemoryRequest::IsWritable() const noexcept
+{
+	return m_Writable;
+}
+
+nStrView MemoryRequest::GetPath() const noexcept
+{
+	return m_Path;
+}
+
+MemoryResponse::MemoryResponse(natRefPointer<natStream> stream)
+	: m_InternalStream{ std::move(stream) }
+{
+}
+
+natRefPointer<natStream> MemoryResponse::GetResponseStream()
+{
+	return m_InternalStream;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "natVFS.h"
+#include "natMultiThread.h"
+
+namespace NatsuLib
+{
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	ڴ淽
+	///	@note	mem://·ʽʱڴеݣ·Ľͷʽfileͬ
+	///			ԲɱĿ鹲ֻʱḴݣдʱ״޸ʱƣ
+	///			дFlushͷʱΪµĿ滻ԭеĿ飬Ѵ򿪵Զȡʱ
+	///			зΪ̰߳ȫ
+	////////////////////////////////////////////////////////////////////////////////
+	class MemoryScheme final
+		: public natRefObjImpl<IScheme>
+	{
+	public:
+		typedef std::shared_ptr<const std::vector<nByte>> Blob;
+
+		MemoryScheme();
+		~MemoryScheme();
+
+		nStrView GetSchemeName() const noexcept override;
+		natRefPointer<IRequest> CreateRequest(Uri const& uri) override;
+		nBool Exists(Uri const& uri) override;
+		///	@brief	ݻĿ¼״̬
+		///	@note	Ŀ¼ݵ·ṩ޸ʱ
+		Optional<ResourceStat> Stat(Uri const& uri) override;
+		std::vector<DirectoryEntry> EnumerateDirectory(Uri const& uri, nBool withStat) override;
+
+		///	@brief	·ϵݣ滻е
+		void SetBlob(nStrView path, Blob blob);
+		void SetBlob(nStrView path, std::vector<nByte> data);
+		void SetBlob(nStrView path, ncData data, size_t size);
+		///	@brief	·ϵ
+		///	@return	·ϵݣ򷵻nullptr
+		Blob GetBlob(nStrView path) const;
+		///	@brief	Ƴ·ϵ
+		///	@return	·Ƿ
+		nBool RemoveBlob(nStrView path);
+
+		size_t GetBlobCount() const;
+		void Clear();
+
+		///	@brief	uriڴ˷жӦ·
+		static nString GetPath(Uri const& uri);
+
+	private:
+		mutable natCriticalSection m_Section;
+		std::unordered_map<nString, Blob> m_BlobMap;
+	};
+
+	class MemoryRequest final
+		: public natRefObjImpl<IRequest>
+	{
+	public:
+		MemoryRequest(natRefPointer<MemoryScheme> scheme, Uri const& uri);
+
+		///	@brief	ûظ
+		///	@note	ֻʱ·ϲݽ׳쳣дʱдύ󴴽
+		natRefPointer<IResponse> GetResponse() override;
+
+		void SetWritable(nBool value) noexcept;
+		nBool IsWritable() const noexcept;
+
+		nStrView GetPath() const noexcept;
+
+	private:
+		natRefPointer<MemoryScheme> m_Scheme;
+		nString m_Path;
+		nBool m_Writable;
+	};
+
+	class MemoryResponse final
+		: public natRefObjImpl<IResponse>
+	{
+	public:
+		explicit MemoryResponse(natRefPointer<natStream> stream);
+
+		natRefPointer<natStream> GetResponseStream() override;
+
+	private:
+		natRefPointer<natStream> m_InternalStream;
+	};
+}
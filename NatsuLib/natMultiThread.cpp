@@ -8,12 +8,10 @@
 using namespace NatsuLib;
 
 natThread::natThread(nBool Pause)
-	: m_Paused(Pause), m_Thread([this]()
+	: m_Paused(Pause), m_Result(m_ResultPromise.get_future()), m_Thread([this]()
 {
 	m_Pause.get_future().get();
-	std::promise<ResultType> Result;
-	m_Result = Result.get_future();
-	Result.set_value(ThreadJob());
+	m_ResultPromise.set_value(ThreadJob());
 })
 {
 	if (!Pause)
@@ -131,10 +129,13 @@ natThreadPool::natThreadPool(nuInt InitialThreadCount, nuInt MaxThreadCount)
 
 natThreadPool::~natThreadPool()
 {
+	// δͣĹ߳ʱҪֹ޷join
+	WaitAllJobsFinish();
 }
 
 void natThreadPool::KillIdleThreads()
 {
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
 	for (auto&& thread : m_Threads)
 	{
 		if (thread.second->IsIdle())
@@ -146,6 +147,7 @@ void natThreadPool::KillIdleThreads()
 
 void natThreadPool::KillAllThreads()
 {
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
 	for (auto&& thread : m_Threads)
 	{
 		thread.second->RequestTerminate();
@@ -154,6 +156,9 @@ void natThreadPool::KillAllThreads()
 
 std::future<natThreadPool::WorkToken> natThreadPool::QueueWork(WorkFunc workFunc, void* param)
 {
+	// ʵʾҿ߳乤ҪͬһٽɣܻὫ䵽ͬһ߳
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+
 	auto Index = getIdleThreadIndex();
 	if (Index == std::numeric_limits<nuInt>::max() && m_Threads.size() < m_MaxThreadCount)
 	{
@@ -181,6 +186,11 @@ std::future<natThreadPool::WorkToken> natThreadPool::QueueWork(WorkFunc workFunc
 	return move(ret);
 }
 
+nuInt natThreadPool::GetMaxThreadCount() const noexcept
+{
+	return m_MaxThreadCount;
+}
+
 natThread::ThreadIdType natThreadPool::GetThreadId(nuInt Index) const
 {
 	auto iter = m_Threads.find(Index);
@@ -194,11 +204,7 @@ natThread::ThreadIdType natThreadPool::GetThreadId(nuInt Index) const
 
 void natThreadPool::WaitAllJobsFinish(nuInt WaitTime)
 {
-	KillIdleThreads();
-	for (auto&& thread : m_Threads)
-	{
-		thread.second->RequestTerminate();
-	}
+	KillAllThreads();
 	for (auto&& thread : m_Threads)
 	{
 		thread.second->Wait(WaitTime);
@@ -223,10 +229,15 @@ nBool natThreadPool::WorkerThread::IsIdle() const
 
 std::future<nuInt> natThreadPool::WorkerThread::SetWork(WorkFunc CallableObj, void* Param)
 {
+	// ʵʾҪڳm_Mutexʱ޸״̬߳̿ڼm_Idle֮󡢿ʼȴ֮ǰ֪ͨ
+	std::unique_lock<std::mutex> lock{ m_Mutex };
 	m_CallableObj = std::move(CallableObj);
 	m_Arg = Param;
 	m_Idle = false;
 	m_LastResult = std::promise<nuInt>{};
+	auto ret = m_LastResult.get_future();
+	lock.unlock();
+
 	if (m_First)
 	{
 		Resume();
@@ -236,7 +247,7 @@ std::future<nuInt> natThreadPool::WorkerThread::SetWork(WorkFunc CallableObj, vo
 	{
 		m_Cond.notify_one();
 	}
-	return m_LastResult.get_future();
+	return ret;
 }
 
 void natThreadPool::WorkerThread::RequestTerminate()
@@ -246,30 +257,29 @@ void natThreadPool::WorkerThread::RequestTerminate()
 		return;
 	}
 
-	m_ShouldTerminate.store(true, std::memory_order_release);
-	
-	if (m_Idle)
 	{
-		if (m_First)
-		{
-			Resume();
-			m_First = false;
-		}
-		m_Cond.notify_one();
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_ShouldTerminate.store(true, std::memory_order_release);
+	}
+
+	if (m_First)
+	{
+		Resume();
+		m_First = false;
 	}
+	m_Cond.notify_one();
 }
 
 natThread::ResultType natThreadPool::WorkerThread::ThreadJob()
 {
 	while (true)
 	{
-		auto value = m_ShouldTerminate.load(std::memory_order_acquire);
-		if (value)
+		// ѷĹǻᱻִУڿʱҪֹŻ˳
+		if (m_Idle)
 		{
 			break;
 		}
 
-		m_Idle = false;
 		try
 		{
 			m_LastResult.set_value(m_CallableObj(m_Arg));
@@ -279,14 +289,15 @@ natThread::ResultType natThreadPool::WorkerThread::ThreadJob()
 			m_LastResult.set_exception(std::current_exception());
 		}
 		m_Idle = true;
-		m_Pool.onWorkerThreadIdle(m_Index, value);
+		// ʹѱҪֹҲʣĹԱ֤WaitAllJobsFinishʱй
+		m_Pool.onWorkerThreadIdle(m_Index, false);
 
 		{
 			std::unique_lock<std::mutex> lock{ m_Mutex };
-			if (!value && m_Idle)
+			m_Cond.wait(lock, [this]
 			{
-				m_Cond.wait(lock);
-			}
+				return !m_Idle || m_ShouldTerminate.load(std::memory_order_acquire);
+			});
 		}
 	}
 	
@@ -331,7 +342,8 @@ void natThreadPool::onWorkerThreadIdle(nuInt Index, nBool isTerminating)
 {
 	natRefScopeGuard<natCriticalSection> guard{ m_Section };
 
-	if (!isTerminating && !m_WorkQueue.empty())
+	// ߳̿ѾQueueWorkбµĹ
+	if (!isTerminating && !m_WorkQueue.empty() && m_Threads[Index]->IsIdle())
 	{
 		auto&& work = m_WorkQueue.front();
 		auto&& ret = m_Threads[Index]->SetWork(std::get<0>(work), std::get<1>(work));
@@ -75,6 +75,7 @@ namespace NatsuLib
 	private:
 		std::atomic_bool m_Paused;
 		std::promise<void> m_Pause;
+		std::promise<ResultType> m_ResultPromise;
 		std::future<ResultType> m_Result;
 		std::thread m_Thread;
 	};
@@ -276,6 +277,7 @@ namespace NatsuLib
 		void KillIdleThreads();
 		void KillAllThreads();
 		std::future<WorkToken> QueueWork(WorkFunc workFunc, void* param = nullptr);
+		nuInt GetMaxThreadCount() const noexcept;
 		natThread::ThreadIdType GetThreadId(nuInt Index) const;
 		void WaitAllJobsFinish(nuInt WaitTime = Infinity);
 
@@ -0,0 +1,213 @@
+#include "stdafx.h"
+#include "natOverlayScheme.h"
+#include "natException.h"
+
+using namespace NatsuLib;
+
+constexpr size_t OverlayScheme::npos;
+
+OverlayScheme::OverlayScheme(nString schemeName, size_t maxCachedLookups)
+	: m_SchemeName{ std::move(schemeName) }, m_MaxCachedLookups{ maxCachedLookups }, m_Generation{}
+{
+}
+
+OverlayScheme::~OverlayScheme()
+{
+}
+
+nStrView OverlayScheme::GetSchemeName() const noexcept
+{
+	return m_SchemeName;
+}
+
+natRefPointer<IRequest> OverlayScheme::CreateRequest(Uri const& uri)
+{
+	const auto path = detail_::GetFullPath(uri);
+	const auto index = FindLayer(path);
+
+	natRefPointer<IScheme> scheme;
+	nString layerUri;
+
+	{
+		natRefScopeGuard<natCriticalSection> guard{ m_Section };
+		// ʵʾҺѱƳ
+		if (index < m_Layers.size())
+		{
+			scheme = natRefPointer<IScheme>{ m_Layers[index].Scheme };
+			layerUri = m_Layers[index].UriPrefix + path;
+		}
+	}
+
+	if (!scheme)
+	{
+		nat_Throw(natErrException, NatErr_NotFound, "\"{0}\" is not found in any layer."_nv, path);
+	}
+
+	return scheme->CreateRequest(Uri{ std::move(layerUri) });
+}
+
+nBool OverlayScheme::Exists(Uri const& uri)
+{
+	return FindLayer(detail_::GetFullPath(uri)) != npos;
+}
+
+Optional<ResourceStat> OverlayScheme::Stat(Uri const& uri)
+{
+	const auto path = detail_::GetFullPath(uri);
+	for (const auto& layer : getLayers())
+	{
+		auto stat = layer.Scheme->Stat(Uri{ layer.UriPrefix + path });
+		if (stat)
+		{
+			return stat;
+		}
+	}
+
+	return {};
+}
+
+std::vector<DirectoryEntry> OverlayScheme::EnumerateDirectory(Uri const& uri, nBool withStat)
+{
+	const auto path = detail_::GetFullPath(uri);
+	std::vector<DirectoryEntry> entries;
+	std::unordered_set<nString> names;
+	nBool found = false;
+
+	for (const auto& layer : getLayers())
+	{
+		const Uri layerUri{ layer.UriPrefix + path };
+		// ʵʾStatжϣ쳣ڴĿ¼Ĳ
+		const auto stat = layer.Scheme->Stat(layerUri);
+		if (!stat || stat->Type != ResourceType::Directory)
+		{
+			continue;
+		}
+
+		found = true;
+		for (auto& entry : layer.Scheme->EnumerateDirectory(layerUri, withStat))
+		{
+			if (names.emplace(entry.Name).second)
+			{
+				entries.emplace_back(std::move(entry));
+			}
+		}
+	}
+
+	if (!found)
+	{
+		nat_Throw(natErrException, NatErr_NotFound, "Directory \"{0}\" is not found in any layer."_nv, path);
+	}
+
+	return entries;
+}
+
+void OverlayScheme::AddLayer(natRefPointer<IScheme> scheme, nString uriPrefix)
+{
+	InsertLayer(GetLayerCount(), std::move(scheme), std::move(uriPrefix));
+}
+
+void OverlayScheme::InsertLayer(size_t index, natRefPointer<IScheme> scheme, nString uriPrefix)
+{
+	if (!scheme)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "scheme should be a valid pointer."_nv);
+	}
+
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	if (index > m_Layers.size())
+	{
+		nat_Throw(natErrException, NatErr_OutOfRange, "index is out of range."_nv);
+	}
+
+	m_Layers.insert(m_Layers.begin() + index, Layer{ std::move(scheme), std::move(uriPrefix) });
+	m_LookupCache.clear();
+	++m_Generation;
+}
+
+void OverlayScheme::RemoveLayer(size_t index)
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	if (index >= m_Layers.size())
+	{
+		nat_Throw(natErrException, NatErr_OutOfRange, "index is out of range."_nv);
+	}
+
+	m_Layers.erase(m_Layers.begin() + index);
+	m_LookupCache.clear();
+	++m_Generation;
+}
+
+size_t OverlayScheme::GetLayerCount() const
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	return m_Layers.size();
+}
+
+size_t OverlayScheme::FindLayer(nStrView path)
+{
+	auto cachedIndex = npos;
+	nBool cached = false;
+	nuLong generation{};
+	const auto layers = [&]
+	{
+		natRefScopeGuard<natCriticalSection> guard{ m_Section };
+		const auto iter = m_LookupCache.find(path);
+		if (iter != m_LookupCache.end())
+		{
+			cachedIndex = iter->second;
+			cached = true;
+			return std::vector<Layer>{};
+		}
+
+		generation = m_Generation;
+		return m_Layers;
+	}();
+
+	if (cached)
+	{
+		return cachedIndex;
+	}
+
+	// ʵʾٽѯ㣬Ĳѯܽʴ̣
+	auto index = npos;
+	for (size_t i = 0; i < layers.size(); ++i)
+	{
+		if (layers[i].Scheme->Exists(Uri{ layers[i].UriPrefix + path }))
+		{
+			index = i;
+			break;
+		}
+	}
+
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	if (m_MaxCachedLookups && generation == m_Generation)
+	{
+		if (m_LookupCache.size() >= m_MaxCachedLookups)
+		{
+			m_LookupCache.clear();
+		}
+		m_LookupCache.emplace(path, index);
+	}
+
+	return index;
+}
+
+void OverlayScheme::InvalidateCache()
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	m_LookupCache.clear();
+	++m_Generation;
+}
+
+void OverlayScheme::InvalidateCache(nStrView path)
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	m_LookupCache.erase(path);
+	++m_Generation;
+}
+
+std::vector<OverlayScheme::Layer> OverlayScheme::getLayers() const
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	return m_Layers;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "natVFS.h"
+#include "natMultiThread.h"
+
+namespace NatsuLib
+{
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	ӷ
+	///	@note	㰴˳ӣÿһuriǰ׺ɣԴ·׷ӵǰ׺֮õеuri
+	///			"mem://patch/""zip://base.zip!/"Ϊʱoverlay:///a.txtβmem://patch/a.txtzip://base.zip!/a.txt
+	///			󽫽һڴԴĲ㴦·ĽͷʽfileͬʱΪ·ĵһ֣
+	///			overlay://dir/a.txtӦ·dir/a.txtעoverlay://a.txtеa.txtΪû·
+	///			ÿ·Ĳҽδҵ棬лʱһιϣң
+	///			ıʱ潫գеԴ仯ʱInvalidateCacheзΪ̰߳ȫ
+	////////////////////////////////////////////////////////////////////////////////
+	class OverlayScheme final
+		: public natRefObjImpl<IScheme>
+	{
+	public:
+		enum : size_t
+		{
+			DefaultMaxCachedLookups = 4096,
+		};
+
+		///	@brief	ӷ
+		///	@param[in]	schemeName			
+		///	@param[in]	maxCachedLookups	໺Ĳҽʱջ棬Ϊ0ʱл
+		explicit OverlayScheme(nString schemeName = "overlay"_ns, size_t maxCachedLookups = DefaultMaxCachedLookups);
+		~OverlayScheme();
+
+		nStrView GetSchemeName() const noexcept override;
+		///	@brief	
+		///	@note	صһڴԴĲ㴴вжڽ׳쳣
+		natRefPointer<IRequest> CreateRequest(Uri const& uri) override;
+		nBool Exists(Uri const& uri) override;
+		///	@brief	Դ״̬
+		///	@note	صһڴԴĲ״̬ʹòҽĻ
+		Optional<ResourceStat> Stat(Uri const& uri) override;
+		///	@brief	öĿ¼
+		///	@note	ϲдڴĿ¼ĲöٽͬȼϸߵĲΪ׼вжڽ׳쳣
+		std::vector<DirectoryEntry> EnumerateDirectory(Uri const& uri, nBool withStat) override;
+
+		///	@brief	͵ȼӲ
+		///	@param[in]	scheme		ķ
+		///	@param[in]	uriPrefix	uriǰ׺ӦschemeΪ
+		void AddLayer(natRefPointer<IScheme> scheme, nString uriPrefix);
+		///	@brief	ָλò㣬λԽǰȼԽ
+		void InsertLayer(size_t index, natRefPointer<IScheme> scheme, nString uriPrefix);
+		void RemoveLayer(size_t index);
+		size_t GetLayerCount() const;
+
+		///	@brief	·ڵĲ
+		///	@return	λãвж򷵻npos
+		size_t FindLayer(nStrView path);
+
+		///	@brief	лĲҽ
+		void InvalidateCache();
+		///	@brief	ָ·Ĳҽ
+		void InvalidateCache(nStrView path);
+
+		static constexpr size_t npos = size_t(-1);
+
+	private:
+		struct Layer
+		{
+			natRefPointer<IScheme> Scheme;
+			nString UriPrefix;
+		};
+
+		const nString m_SchemeName;
+		const size_t m_MaxCachedLookups;
+		mutable natCriticalSection m_Section;
+		std::vector<Layer> m_Layers;
+		// ·ڲλãnposʾвж
+		std::unordered_map<nString, size_t> m_LookupCache;
+		// ʵʾ򻺴ıʱڶڸı֮ǰʼĲҽ
+		nuLong m_Generation;
+
+		std::vector<Layer> getLayers() const;
+	};
+}
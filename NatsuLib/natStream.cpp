@@ -4,6 +4,10 @@
 #include <algorithm>
 #include <cstring>
 
+#ifndef _WIN32
+#	include <unistd.h>
+#endif
+
 using namespace NatsuLib;
 
 natStream::~natStream()
@@ -95,8 +99,42 @@ nLen natStream::CopyTo(natRefPointer<natStream> const& other)
 	return totalReadBytes;
 }
 
+namespace
+{
+	// ʵʾδṩٽʱ
+	class OptionalSectionGuard final
+		: public nonmovable
+	{
+	public:
+		explicit OptionalSectionGuard(natCriticalSection* section)
+			: m_Section{ section }
+		{
+			if (m_Section)
+			{
+				m_Section->Lock();
+			}
+		}
+
+		~OptionalSectionGuard()
+		{
+			if (m_Section)
+			{
+				m_Section->UnLock();
+			}
+		}
+
+	private:
+		natCriticalSection* const m_Section;
+	};
+}
+
 natSubStream::natSubStream(natRefPointer<natStream> stream, nLen startPosition, nLen endPosition)
-	: m_InternalStream{ std::move(stream) }, m_StartPosition{ startPosition }, m_EndPosition{ endPosition }, m_CurrentPosition{ startPosition }
+	: natSubStream(std::move(stream), startPosition, endPosition, nullptr)
+{
+}
+
+natSubStream::natSubStream(natRefPointer<natStream> stream, nLen startPosition, nLen endPosition, std::shared_ptr<natCriticalSection> streamSection)
+	: m_InternalStream{ std::move(stream) }, m_StartPosition{ startPosition }, m_EndPosition{ endPosition }, m_CurrentPosition{ startPosition }, m_StreamSection{ std::move(streamSection) }
 {
 	if (!m_InternalStream->CanSeek())
 	{
@@ -106,11 +144,17 @@ natSubStream::natSubStream(natRefPointer<natStream> stream, nLen startPosition,
 	{
 		nat_Throw(natErrException, NatErr_OutOfRange, "startPosition cannot be bigger than endPosition."_nv);
 	}
+
+	OptionalSectionGuard guard{ m_StreamSection.get() };
 	if (m_InternalStream->GetSize() < endPosition)
 	{
 		nat_Throw(natErrException, NatErr_OutOfRange, "Range is too big."_nv);
 	}
-	m_InternalStream->SetPosition(NatSeek::Beg, startPosition);
+	// ʵʾײʱʹãƳٵʵʶдʱѰַ
+	if (!m_StreamSection)
+	{
+		m_InternalStream->SetPosition(NatSeek::Beg, startPosition);
+	}
 }
 
 natSubStream::~natSubStream()
@@ -159,7 +203,7 @@ void natSubStream::SetSize(nLen /*Size*/)
 
 nLen natSubStream::GetPosition() const
 {
-	return m_CurrentPosition;
+	return m_CurrentPosition - m_StartPosition;
 }
 
 void natSubStream::SetPosition(NatSeek Origin, nLong Offset)
@@ -186,8 +230,6 @@ void natSubStream::SetPosition(NatSeek Origin, nLong Offset)
 	}
 
 	m_CurrentPosition = position;
-
-	adjustPosition();
 }
 
 nByte natSubStream::ReadByte()
@@ -202,8 +244,11 @@ nByte natSubStream::ReadByte()
 		nat_Throw(natErrException, NatErr_OutOfRange, "Reached end of stream."_nv);
 	}
 
+	OptionalSectionGuard guard{ m_StreamSection.get() };
 	adjustPosition();
-	return m_InternalStream->ReadByte();
+	const auto byte = m_InternalStream->ReadByte();
+	++m_CurrentPosition;
+	return byte;
 }
 
 nLen natSubStream::ReadBytes(nData pData, nLen Length)
@@ -214,8 +259,16 @@ nLen natSubStream::ReadBytes(nData pData, nLen Length)
 	}
 
 	const auto realLength = std::min(Length, m_EndPosition - m_CurrentPosition);
+	if (!realLength)
+	{
+		return 0;
+	}
+
+	OptionalSectionGuard guard{ m_StreamSection.get() };
 	adjustPosition();
-	return m_InternalStream->ReadBytes(pData, realLength);
+	const auto readBytes = m_InternalStream->ReadBytes(pData, realLength);
+	m_CurrentPosition += readBytes;
+	return readBytes;
 }
 
 std::future<nLen> natSubStream::ReadBytesAsync(nData pData, nLen Length)
@@ -225,9 +278,8 @@ std::future<nLen> natSubStream::ReadBytesAsync(nData pData, nLen Length)
 		nat_Throw(natErrException, NatErr_NotSupport, "Underlying stream cannot read."_nv);
 	}
 
-	const auto realLength = std::min(Length, m_EndPosition - m_CurrentPosition);
-	adjustPosition();
-	return m_InternalStream->ReadBytesAsync(pData, realLength);
+	// ʵʾҪɺλã˲ֱתײ
+	return natStream::ReadBytesAsync(pData, Length);
 }
 
 void natSubStream::WriteByte(nByte byte)
@@ -242,8 +294,10 @@ void natSubStream::WriteByte(nByte byte)
 		nat_Throw(natErrException, NatErr_OutOfRange, "Reached end of stream."_nv);
 	}
 
+	OptionalSectionGuard guard{ m_StreamSection.get() };
 	adjustPosition();
-	return m_InternalStream->WriteByte(byte);
+	m_InternalStream->WriteByte(byte);
+	++m_CurrentPosition;
 }
 
 nLen natSubStream::WriteBytes(ncData pData, nLen Length)
@@ -254,8 +308,16 @@ nLen natSubStream::WriteBytes(ncData pData, nLen Length)
 	}
 
 	const auto realLength = std::min(Length, m_EndPosition - m_CurrentPosition);
+	if (!realLength)
+	{
+		return 0;
+	}
+
+	OptionalSectionGuard guard{ m_StreamSection.get() };
 	adjustPosition();
-	return m_InternalStream->WriteBytes(pData, realLength);
+	const auto writtenBytes = m_InternalStream->WriteBytes(pData, realLength);
+	m_CurrentPosition += writtenBytes;
+	return writtenBytes;
 }
 
 std::future<nLen> natSubStream::WriteBytesAsync(ncData pData, nLen Length)
@@ -265,13 +327,13 @@ std::future<nLen> natSubStream::WriteBytesAsync(ncData pData, nLen Length)
 		nat_Throw(natErrException, NatErr_NotSupport, "Underlying stream cannot write."_nv);
 	}
 
-	const auto realLength = std::min(Length, m_EndPosition - m_CurrentPosition);
-	adjustPosition();
-	return m_InternalStream->WriteBytesAsync(pData, realLength);
+	// ʵʾҪɺλã˲ֱתײ
+	return natStream::WriteBytesAsync(pData, Length);
 }
 
 void natSubStream::Flush()
 {
+	OptionalSectionGuard guard{ m_StreamSection.get() };
 	m_InternalStream->Flush();
 }
 
@@ -941,21 +1003,20 @@ void natFileStream::SetSize(nLen Size)
 		nat_Throw(natErrException, NatErr_IllegalState, "Stream is not writable."_nv);
 	}
 
-	const auto currentSize = GetSize();
-
-	if (Size < currentSize)
+	if (Size == GetSize())
 	{
-		nat_Throw(natErrException, NatErr_InvalidArg, "Cannot truncate file."_nv);
+		return;
 	}
 
-	if (Size == currentSize)
+	// ʵʾstd::fstream޷ıļСдݺֱӵļС
+	const auto current = GetPosition();
+	m_File.flush();
+	if (truncate(m_Filename.data(), static_cast<off_t>(Size)) != 0)
 	{
-		return;
+		nat_Throw(natErrException, NatErr_InternalErr, "Cannot resize file \"{0}\"."_nv, m_Filename);
 	}
-
-	auto current = m_File.tellp();
-	m_File.seekp(Size);
-	m_File.seekp(current);
+	m_File.clear();
+	m_File.seekp(static_cast<std::streamoff>(std::min(current, Size)));
 }
 
 nLen natFileStream::GetPosition() const
@@ -1204,7 +1265,7 @@ nLen natStdStream::WriteBytes(ncData pData, nLen Length)
 		nat_Throw(natErrException, NatErr_IllegalState, "This stream cannot write."_nv);
 	}
 
-	return static_cast<nLen>(fwrite(pData, Length, 1, m_StdHandle));
+	return static_cast<nLen>(fwrite(pData, 1, Length, m_StdHandle));
 }
 
 std::future<nLen> natStdStream::WriteBytesAsync(ncData pData, nLen Length)
@@ -1223,7 +1284,7 @@ void natStdStream::Flush()
 #endif
 
 natMemoryStream::natMemoryStream(ncData pData, nLen Length, nBool bReadable, nBool bWritable, nBool autoResize)
-	: m_pData(nullptr), m_CurPos(0u), m_bReadable(bReadable), m_bWritable(bWritable), m_AutoResize(autoResize)
+	: m_pData(nullptr), m_Size(0u), m_Capacity(0u), m_CurPos(0u), m_bReadable(bReadable), m_bWritable(bWritable), m_AutoResize(autoResize)
 {
 	Reserve(Length);
 	m_Size = Length;
@@ -1272,12 +1333,12 @@ nBool natMemoryStream::CanSeek() const
 
 nBool natMemoryStream::IsEndOfStream() const
 {
-	return m_CurPos >= m_Capacity;
+	return m_CurPos >= m_Size;
 }
 
 nLen natMemoryStream::GetSize() const
 {
-	return m_Capacity;
+	return m_Size;
 }
 
 void natMemoryStream::SetSize(nLen Size)
@@ -1297,19 +1358,19 @@ void natMemoryStream::SetPosition(NatSeek Origin, nLong Offset)
 	switch (Origin)
 	{
 	case NatSeek::Beg:
-		if (Offset < 0 || m_Capacity < static_cast<nLen>(Offset))
+		if (Offset < 0 || m_Size < static_cast<nLen>(Offset))
 			nat_Throw(natErrException, NatErr_OutOfRange, "Out of range."_nv);
 		m_CurPos = Offset;
 		break;
 	case NatSeek::Cur:
-		if ((Offset < 0 && m_CurPos < static_cast<nLen>(-Offset)) || m_Capacity > static_cast<nLen>(m_CurPos + Offset))
+		if ((Offset < 0 && m_CurPos < static_cast<nLen>(-Offset)) || (Offset > 0 && m_Size - m_CurPos < static_cast<nLen>(Offset)))
 			nat_Throw(natErrException, NatErr_OutOfRange, "Out of range."_nv);
 		m_CurPos += Offset;
 		break;
 	case NatSeek::End:
-		if (Offset > 0 || m_Capacity < static_cast<nLen>(-Offset))
+		if (Offset > 0 || m_Size < static_cast<nLen>(-Offset))
 			nat_Throw(natErrException, NatErr_OutOfRange, "Out of range."_nv);
-		m_CurPos = m_Capacity + Offset;
+		m_CurPos = m_Size + Offset;
 		break;
 	default:
 		nat_Throw(natErrException, NatErr_OutOfRange, "Out of range."_nv);
@@ -1345,7 +1406,7 @@ nLen natMemoryStream::ReadBytes(nData pData, nLen Length)
 	natRefScopeGuard<natCriticalSection> guard(m_CriSection);
 
 	tReadBytes = std::min(Length, m_Size - m_CurPos);
-	memmove(pData + m_CurPos, m_pData, static_cast<size_t>(tReadBytes));
+	memmove(pData, m_pData + m_CurPos, static_cast<size_t>(tReadBytes));
 	m_CurPos += tReadBytes;
 
 	return tReadBytes;
@@ -1363,7 +1424,11 @@ void natMemoryStream::WriteByte(nByte byte)
 {
 	if (m_CurPos >= m_Capacity)
 	{
-		nat_Throw(natErrException, NatErr_IllegalState, "End of stream reached."_nv);
+		if (!m_AutoResize)
+		{
+			nat_Throw(natErrException, NatErr_IllegalState, "End of stream reached."_nv);
+		}
+		Reserve(detail_::Grow(m_CurPos + 1));
 	}
 
 	m_pData[m_CurPos++] = byte;
@@ -1388,12 +1453,12 @@ nLen natMemoryStream::WriteBytes(ncData pData, nLen Length)
 
 	natRefScopeGuard<natCriticalSection> guard(m_CriSection);
 
+	tWriteBytes = Length;
 	if (Length > m_Capacity - m_CurPos)
 	{
 		if (m_AutoResize)
 		{
-			Reserve(detail_::Grow(Length));
-			tWriteBytes = Length;
+			Reserve(detail_::Grow(m_CurPos + Length));
 		}
 		else
 		{
@@ -1401,7 +1466,7 @@ nLen natMemoryStream::WriteBytes(ncData pData, nLen Length)
 		}
 	}
 
-	memmove(m_pData, pData + m_CurPos, static_cast<size_t>(tWriteBytes));
+	memmove(m_pData + m_CurPos, pData, static_cast<size_t>(tWriteBytes));
 	m_CurPos += tWriteBytes;
 	m_Size = std::max(m_CurPos, m_Size);
 
@@ -1434,7 +1499,7 @@ void natMemoryStream::Reserve(nLen newCapacity)
 {
 	using std::swap;
 
-	if (newCapacity > 0 && newCapacity <= m_Capacity)
+	if (m_pData && newCapacity <= m_Capacity)
 	{
 		return;
 	}
@@ -1451,6 +1516,7 @@ void natMemoryStream::Reserve(nLen newCapacity)
 	}
 	
 	swap(m_pData, pNewStorage);
+	m_Capacity = newCapacity;
 }
 
 nLen natMemoryStream::GetCapacity() const noexcept
@@ -1524,6 +1590,7 @@ void natMemoryStream::allocateAndInvalidateOldData(nLen newCapacity)
 	auto pNewStorage = new nByte[newCapacity];
 	swap(m_pData, pNewStorage); // swapnoexcept 
 	delete[] pNewStorage;
+	m_Capacity = newCapacity;
 }
 
 natExternMemoryStream::natExternMemoryStream(nData externData, nLen size, nBool readable, nBool writable)
@@ -1595,7 +1662,7 @@ void natExternMemoryStream::SetPosition(NatSeek Origin, nLong Offset)
 		m_CurrentPos = Offset;
 		break;
 	case NatSeek::Cur:
-		if ((Offset < 0 && m_CurrentPos < static_cast<nLen>(-Offset)) || m_Size > static_cast<nLen>(m_CurrentPos + Offset))
+		if ((Offset < 0 && m_CurrentPos < static_cast<nLen>(-Offset)) || (Offset > 0 && m_Size - m_CurrentPos < static_cast<nLen>(Offset)))
 			nat_Throw(OutOfRange, "Out of range."_nv);
 		m_CurrentPos += Offset;
 		break;
@@ -1636,7 +1703,7 @@ nLen natExternMemoryStream::ReadBytes(nData pData, nLen Length)
 	}
 
 	const auto readBytes = std::min(Length, m_Size - m_CurrentPos);
-	memmove(pData, m_ExternData, readBytes);
+	memmove(pData, m_ExternData + m_CurrentPos, readBytes);
 	m_CurrentPos += readBytes;
 	return readBytes;
 }
@@ -1656,9 +1723,9 @@ nLen natExternMemoryStream::WriteBytes(ncData pData, nLen Length)
 	assert(pData && "pData should not be nullptr.");
 	assert(m_CurrentPos <= m_Size);
 
-	if (!CanRead())
+	if (!CanWrite())
 	{
-		nat_Throw(natErrException, NatErr_IllegalState, "Stream is not readable."_nv);
+		nat_Throw(natErrException, NatErr_IllegalState, "Stream is not writable."_nv);
 	}
 
 	if (Length == 0)
@@ -285,11 +285,18 @@ namespace NatsuLib
 		nBool m_bReadable, m_bWritable;
 	};
 
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	
+	///	@note	ʾײ[startPosition, endPosition)䣬λstartPosition
+	///			ṩstreamSectionÿζдѰַλٽв
+	///			ʱͬһײͬһstreamSectionڲͬ߳ͬʱʹ
+	////////////////////////////////////////////////////////////////////////////////
 	class natSubStream
 		: public natRefObjImpl<natStream>
 	{
 	public:
 		natSubStream(natRefPointer<natStream> stream, nLen startPosition, nLen endPosition);
+		natSubStream(natRefPointer<natStream> stream, nLen startPosition, nLen endPosition, std::shared_ptr<natCriticalSection> streamSection);
 		~natSubStream();
 
 		natRefPointer<natStream> GetUnderlyingStream() const noexcept;
@@ -316,6 +323,7 @@ namespace NatsuLib
 		const nLen m_StartPosition;
 		const nLen m_EndPosition;
 		nLen m_CurrentPosition;
+		const std::shared_ptr<natCriticalSection> m_StreamSection;
 
 		void adjustPosition() const;
 		void checkPosition() const;
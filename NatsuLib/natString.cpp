@@ -2,6 +2,24 @@
 #include "natString.h"
 #include "natUtil.h"
 
+#if defined(_M_X64) || defined(__x86_64__)
+#	define NATSTRING_X64 1
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#	else
+#		include <cpuid.h>
+#	endif
+#	include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#	define NATSTRING_TARGET_SSE41
+#	define NATSTRING_TARGET_AVX2
+#else
+#	define NATSTRING_TARGET_SSE41 __attribute__((target("ssse3,sse4.1")))
+#	define NATSTRING_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
 using namespace NatsuLib;
 
 template class StringView<StringType::Utf8>;
@@ -311,534 +329,1849 @@ std::pair<EncodingResult, char32_t*> NatsuLib::EncodeUtf32(char32_t* strBegin, c
 	return { EncodingResult::Accept, current };
 }
 
-namespace NatsuLib
+namespace
 {
-	namespace detail_
+	// ʵʾתתЧУǷɹreadwriteָѳɹתλ
+	//          ÷豣֤µĽ汾ݴʣ㹻ʱдתֵݽ
+
+	std::tuple<EncodingResult, char32_t, const char*> DecodeOne(const char* read, const char* readEnd) noexcept
 	{
-		EncodingResult EncodingCodePoint<StringType::Utf8>::Encode(String<StringType::Utf8>& output, nuInt codePoint)
+		return DecodeUtf8(read, readEnd);
+	}
+
+	std::tuple<EncodingResult, char32_t, const char16_t*> DecodeOne(const char16_t* read, const char16_t* readEnd) noexcept
+	{
+		return DecodeUtf16(read, readEnd);
+	}
+
+	std::tuple<EncodingResult, char32_t, const char32_t*> DecodeOne(const char32_t* read, const char32_t* readEnd) noexcept
+	{
+		return DecodeUtf32(read, readEnd);
+	}
+
+	void EncodeOne(char*& write, char32_t codePoint) noexcept
+	{
+		const auto result = EncodeUtf8(write, write + 4, codePoint);
+		assert(result.first == EncodingResult::Accept && "EncodeUtf8 failed.");
+		write = result.second;
+	}
+
+	void EncodeOne(char16_t*& write, char32_t codePoint) noexcept
+	{
+		const auto result = EncodeUtf16(write, write + 2, codePoint);
+		assert(result.first == EncodingResult::Accept && "EncodeUtf16 failed.");
+		write = result.second;
+	}
+
+	void EncodeOne(char32_t*& write, char32_t codePoint) noexcept
+	{
+		*write++ = codePoint;
+	}
+
+	template <typename SrcChar, typename DstChar>
+	nBool TransCodeOne(const SrcChar*& read, const SrcChar* readEnd, DstChar*& write) noexcept
+	{
+		EncodingResult result;
+		char32_t codePoint;
+		const SrcChar* next;
+		std::tie(result, codePoint, next) = DecodeOne(read, readEnd);
+		if (result != EncodingResult::Accept)
 		{
-			StringEncodingTrait<StringType::Utf8>::CharType buffer[StringEncodingTrait<StringType::Utf8>::MaxCharSize]{};
-			EncodingResult result;
-			const char* end;
-			std::tie(result, end) = EncodeUtf8(std::begin(buffer), std::end(buffer), static_cast<char32_t>(codePoint));
-			if (result == EncodingResult::Accept)
-			{
-				output.Append(StringView<StringType::Utf8>{ std::cbegin(buffer), end });
-			}
-			return result;
+			return false;
 		}
+		read = next;
+		EncodeOne(write, codePoint);
+		return true;
+	}
 
-		std::pair<EncodingResult, size_t> EncodingCodePoint<StringType::Utf8>::Decode(StringView<StringType::Utf8> const& input, nuInt& codePoint)
+	template <typename SrcChar, typename DstChar>
+	void CopyAsciiScalar(const SrcChar*& read, const SrcChar* readEnd, DstChar*& write) noexcept
+	{
+		while (read < readEnd && static_cast<nuInt>(*read) < 0x80)
 		{
-			EncodingResult result;
-			char32_t tmpCodePoint;
-			const char* end;
-			std::tie(result, tmpCodePoint, end) = DecodeUtf8(std::cbegin(input), std::cend(input));
-			if (result == EncodingResult::Accept)
-			{
-				codePoint = static_cast<nuInt>(tmpCodePoint);
-			}
-
-			return { result, std::distance(std::cbegin(input), end) };
+			*write++ = static_cast<DstChar>(*read++);
 		}
+	}
 
-		EncodingResult EncodingCodePoint<StringType::Utf16>::Encode(String<StringType::Utf16>& output, nuInt codePoint)
+	// ÿ8ֽڼǷΪASCIIַ
+	template <typename DstChar>
+	void CopyAsciiScalar(const char*& read, const char* readEnd, DstChar*& write) noexcept
+	{
+		while (readEnd - read >= 8)
 		{
-			StringEncodingTrait<StringType::Utf16>::CharType buffer[StringEncodingTrait<StringType::Utf16>::MaxCharSize]{};
-			EncodingResult result;
-			const char16_t* end;
-			std::tie(result, end) = EncodeUtf16(std::begin(buffer), std::end(buffer), static_cast<char32_t>(codePoint));
-			if (result == EncodingResult::Accept)
+			nuLong block;
+			std::memcpy(&block, read, sizeof block);
+			if (block & 0x8080808080808080)
 			{
-				output.Append(StringView<StringType::Utf16>{ std::cbegin(buffer), end });
+				break;
 			}
-			return result;
-		}
-
-		std::pair<EncodingResult, size_t> EncodingCodePoint<StringType::Utf16>::Decode(StringView<StringType::Utf16> const& input, nuInt& codePoint)
-		{
-			EncodingResult result;
-			char32_t tmpCodePoint;
-			const char16_t* end;
-			std::tie(result, tmpCodePoint, end) = DecodeUtf16(std::cbegin(input), std::cend(input));
-			if (result == EncodingResult::Accept)
+			for (size_t i = 0; i < 8; ++i)
 			{
-				codePoint = static_cast<nuInt>(tmpCodePoint);
+				write[i] = static_cast<DstChar>(read[i]);
 			}
-
-			return{ result, std::distance(std::cbegin(input), end) };
+			read += 8;
+			write += 8;
 		}
 
-		EncodingResult EncodingCodePoint<StringType::Utf32>::Encode(String<StringType::Utf32>& output, nuInt codePoint)
+		while (read < readEnd && static_cast<nByte>(*read) < 0x80)
 		{
-			StringEncodingTrait<StringType::Utf32>::CharType buffer[StringEncodingTrait<StringType::Utf32>::MaxCharSize]{};
-			EncodingResult result;
-			const char32_t* end;
-			std::tie(result, end) = EncodeUtf32(std::begin(buffer), std::end(buffer), static_cast<char32_t>(codePoint));
-			if (result == EncodingResult::Accept)
-			{
-				output.Append(StringView<StringType::Utf32>{ std::cbegin(buffer), end });
-			}
-			return result;
+			*write++ = static_cast<DstChar>(*read++);
 		}
+	}
 
-		std::pair<EncodingResult, size_t> EncodingCodePoint<StringType::Utf32>::Decode(StringView<StringType::Utf32> const& input, nuInt& codePoint)
+	template <typename SrcChar, typename DstChar>
+	nBool TransCodeScalar(const SrcChar*& read, const SrcChar* readEnd, DstChar*& write) noexcept
+	{
+		while (true)
 		{
-			EncodingResult result;
-			char32_t tmpCodePoint;
-			const char32_t* end;
-			std::tie(result, tmpCodePoint, end) = DecodeUtf32(std::cbegin(input), std::cend(input));
-			if (result == EncodingResult::Accept)
+			CopyAsciiScalar(read, readEnd, write);
+			if (read == readEnd)
 			{
-				codePoint = static_cast<nuInt>(tmpCodePoint);
+				return true;
+			}
+			if (!TransCodeOne(read, readEnd, write))
+			{
+				return false;
 			}
-
-			return{ result, std::distance(std::cbegin(input), end) };
 		}
+	}
 
-#ifdef _WIN32
-		EncodingResult EncodingCodePoint<StringType::Ansi>::Encode(String<StringType::Ansi>& output, nuInt codePoint)
+	template <typename Char>
+	nBool ValidateScalar(const Char* read, const Char* readEnd) noexcept
+	{
+		while (read < readEnd)
 		{
-			try
+			if (static_cast<nuInt>(*read) < 0x80)
 			{
-				output.ResizeMore(4);
-				output.Append(StringView<StringType::Utf32>{ codePoint });
+				++read;
+				continue;
 			}
-			catch (...)
+
+			EncodingResult result;
+			std::tie(result, std::ignore, read) = DecodeOne(read, readEnd);
+			if (result != EncodingResult::Accept)
 			{
-				output.pop_back(4);
-				return EncodingResult::Reject;	// 쳣
+				return false;
 			}
-
-			return EncodingResult::Accept;
 		}
 
-		std::pair<EncodingResult, size_t> EncodingCodePoint<StringType::Ansi>::Decode(StringView<StringType::Ansi> const& input, nuInt& codePoint)
+		return true;
+	}
+
+	enum class SimdLevel
+	{
+		Scalar,
+		Sse41,
+		Avx2,
+	};
+
+#ifdef NATSTRING_X64
+	SimdLevel DetectSimdLevel() noexcept
+	{
+		nuInt features = 0, extendedFeatures = 0;
+		nuLong enabledStates = 0;
+
+#ifdef _MSC_VER
+		int cpuInfo[4];
+		__cpuid(cpuInfo, 0);
+		const auto maxLeaf = cpuInfo[0];
+		__cpuid(cpuInfo, 1);
+		features = static_cast<nuInt>(cpuInfo[2]);
+		if (maxLeaf >= 7)
 		{
-			codePoint = static_cast<nuInt>(*input.begin());	// ޷AnsiַһЧַռõֽ
-			return { EncodingResult::Accept, 1 };
+			__cpuidex(cpuInfo, 7, 0);
+			extendedFeatures = static_cast<nuInt>(cpuInfo[1]);
+		}
+		if (features & (1u << 27))
+		{
+			enabledStates = _xgetbv(0);
 		}
+#else
+		unsigned eax, ebx, ecx, edx;
+		if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		{
+			return SimdLevel::Scalar;
+		}
+		features = ecx;
+		if (__get_cpuid_max(0, nullptr) >= 7)
+		{
+			__cpuid_count(7, 0, eax, ebx, ecx, edx);
+			extendedFeatures = ebx;
+		}
+		if (features & (1u << 27))
+		{
+			nuInt low, high;
+			__asm__ __volatile__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+			enabledStates = static_cast<nuLong>(high) << 32 | low;
+		}
+#endif
 
-		EncodingResult EncodingCodePoint<StringType::Wide>::Encode(String<StringType::Wide>& output, nuInt codePoint)
+		// SSSE3, SSE4.1
+		if ((features & (1u << 9)) == 0 || (features & (1u << 19)) == 0)
 		{
-			//  Windows ƽ̨µĿַַΪUTF-16
-			return EncodingCodePoint<StringType::Utf16>::Encode(reinterpret_cast<String<StringType::Utf16>&>(output), codePoint);
+			return SimdLevel::Scalar;
 		}
 
-		std::pair<EncodingResult, size_t> EncodingCodePoint<StringType::Wide>::Decode(StringView<StringType::Wide> const& input, nuInt& codePoint)
+		// AVX2ҪϵͳYMMĴ
+		if ((features & (1u << 28)) != 0 && (extendedFeatures & (1u << 5)) != 0 && (enabledStates & 6) == 6)
 		{
-			return EncodingCodePoint<StringType::Utf16>::Decode(reinterpret_cast<StringView<StringType::Utf16> const&>(input), codePoint);
+			return SimdLevel::Avx2;
 		}
 
+		return SimdLevel::Sse41;
+	}
+
+	// ʵʾSimdLevel::ScalarΪֵ뵥Ԫľ̬ʼڱʹתʱȫʹñ汾
+	const SimdLevel g_SimdLevel = DetectSimdLevel();
+
+	size_t CountTrailingZeros(nuInt value) noexcept
+	{
+		assert(value);
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, value);
+		return index;
+#else
+		return static_cast<size_t>(__builtin_ctz(value));
 #endif
 	}
 
-	template <>
-	void U8String::TransAppendTo(U16String& dst, View const& src)
+	struct Utf8Tables
 	{
-		const auto dstBegin = dst.ResizeMore(src.size());
+		// ʵʾԵ112ֽǷΪֽɵΪ011ֽǷΪеĽβ
+		//          ¼ʼ8Ȳ3ֽڵУShuffleiеֽi32λͨ
+		struct DecodeEntry
+		{
+			nByte Shuffle[32];
+			nByte Consumed;
+			nByte Count;
+		};
 
-		try
+		// ʵʾ4ǷС0x80ǷС0x800ɵΪShuffleͨЧֽڽ
+		struct EncodeEntry
 		{
-			auto write = dstBegin;
-			const auto writeEnd = dst.end();
-			auto read = src.cbegin();
-			const auto readEnd = src.cend();
+			nByte Shuffle[16];
+			nByte Length;
+		};
 
-			EncodingResult result;
-			char32_t u32CodePoint;
+		DecodeEntry Decode[4096];
+		EncodeEntry Encode[256];
+
+		Utf8Tables() noexcept
+		{
+			for (size_t mask = 0; mask < 4096; ++mask)
+			{
+				auto& entry = Decode[mask];
+				std::fill(std::begin(entry.Shuffle), std::end(entry.Shuffle), nByte{ 0x80 });
+
+				size_t pos = 0, count = 0;
+				while (count < 8)
+				{
+					auto end = pos;
+					while (end < 12 && !(mask >> end & 1))
+					{
+						++end;
+					}
+					if (end == 12 || end - pos >= 3)
+					{
+						break;
+					}
+					for (size_t i = 0; i <= end - pos; ++i)
+					{
+						entry.Shuffle[count * 4 + i] = static_cast<nByte>(end - i);
+					}
+					++count;
+					pos = end + 1;
+				}
+
+				entry.Consumed = static_cast<nByte>(pos);
+				entry.Count = static_cast<nByte>(count);
+			}
 
-			while (read < readEnd)
+			for (size_t mask = 0; mask < 256; ++mask)
 			{
-				std::tie(result, u32CodePoint, read) = DecodeUtf8(read, readEnd);
-				if (result != EncodingResult::Accept)
+				auto& entry = Encode[mask];
+				std::fill(std::begin(entry.Shuffle), std::end(entry.Shuffle), nByte{ 0x80 });
+
+				size_t length = 0;
+				for (size_t lane = 0; lane < 4; ++lane)
 				{
-					nat_Throw(natException, "DecodeUtf8 failed."_nv);
+					const auto laneLength = 1 + (mask >> lane & 1) + (mask >> (lane + 4) & 1);
+					for (size_t i = 0; i < laneLength; ++i)
+					{
+						entry.Shuffle[length++] = static_cast<nByte>(lane * 4 + i);
+					}
 				}
-				std::tie(result, write) = EncodeUtf16(write, writeEnd, u32CodePoint);
-				assert(result == EncodingResult::Accept && "EncodeUtf16 failed.");
+
+				entry.Length = static_cast<nByte>(length);
 			}
-			dst.Resize(static_cast<size_t>(write - dst.begin()));
-		}
-		catch (...)
-		{
-			dst.Resize(static_cast<size_t>(dstBegin - dst.begin()));
-			throw;
 		}
+	};
+
+	Utf8Tables const& GetUtf8Tables() noexcept
+	{
+		static const Utf8Tables s_Tables;
+		return s_Tables;
 	}
 
-	template <>
-	void U8String::TransAppendFrom(U8String& dst, U16StringView const& src)
+	// ʵʾ32λͨΪеĩֽڡڶֽֽڣڵֽΪ0
+	//          ȥλĹ׺ǷڸóȵпɱʾķΧڣԴͬʱֽǷ볤
+	NATSTRING_TARGET_SSE41 __m128i DecodeUtf8Lanes(__m128i lanes, __m128i& invalid) noexcept
 	{
-		const auto dstBegin = dst.ResizeMore(src.size() * 3);
+		const auto byteMask = _mm_set1_epi32(0xFF);
+		const auto byte0 = _mm_and_si128(lanes, byteMask);
+		const auto byte1 = _mm_and_si128(_mm_srli_epi32(lanes, 8), byteMask);
+		const auto byte2 = _mm_srli_epi32(lanes, 16);
+		const auto sum = _mm_add_epi32(_mm_add_epi32(byte0, _mm_slli_epi32(byte1, 6)), _mm_slli_epi32(byte2, 12));
+
+		const auto zero = _mm_setzero_si128();
+		const auto isThreeBytes = _mm_cmpgt_epi32(byte2, zero);
+		const auto isTwoBytes = _mm_andnot_si128(isThreeBytes, _mm_cmpgt_epi32(byte1, zero));
+
+		const auto offset = _mm_or_si128(_mm_and_si128(isThreeBytes, _mm_set1_epi32(0xE2080)), _mm_and_si128(isTwoBytes, _mm_set1_epi32(0x3080)));
+		const auto minValue = _mm_or_si128(_mm_and_si128(isThreeBytes, _mm_set1_epi32(0x800)), _mm_and_si128(isTwoBytes, _mm_set1_epi32(0x80)));
+		const auto maxValue = _mm_blendv_epi8(_mm_blendv_epi8(_mm_set1_epi32(0x7F), _mm_set1_epi32(0x7FF), isTwoBytes), _mm_set1_epi32(0xFFFF), isThreeBytes);
+		const auto codePoint = _mm_sub_epi32(sum, offset);
+
+		invalid = _mm_or_si128(_mm_or_si128(_mm_cmplt_epi32(codePoint, minValue), _mm_cmpgt_epi32(codePoint, maxValue)),
+			_mm_cmpeq_epi32(_mm_and_si128(codePoint, _mm_set1_epi32(0xF800)), _mm_set1_epi32(0xD800)));
+		return codePoint;
+	}
 
-		try
+	// inputʼУ޷ʱnullptrʱӦԱ汾һ
+	NATSTRING_TARGET_SSE41 const Utf8Tables::DecodeEntry* DecodeUtf8Block(Utf8Tables const& tables, __m128i input, __m128i& low, __m128i& high) noexcept
+	{
+		const auto continuation = _mm_cmplt_epi8(input, _mm_set1_epi8(static_cast<char>(0xC0)));
+		const auto endMask = (~static_cast<nuInt>(_mm_movemask_epi8(continuation)) >> 1) & 0xFFF;
+		const auto& entry = tables.Decode[endMask];
+		if (!entry.Count)
 		{
-			auto write = dstBegin;
-			const auto writeEnd = dst.end();
-			auto read = src.cbegin();
-			const auto readEnd = src.cend();
-
-			EncodingResult result;
-			char32_t u32CodePoint;
+			return nullptr;
+		}
 
-			while (read < readEnd)
-			{
-				std::tie(result, u32CodePoint, read) = DecodeUtf16(read, readEnd);
-				if (result != EncodingResult::Accept)
-				{
-					nat_Throw(natException, "DecodeUtf16 failed."_nv);
-				}
-				std::tie(result, write) = EncodeUtf8(write, writeEnd, u32CodePoint);
-				assert(result == EncodingResult::Accept && "EncodeUtf8 failed.");
-			}
-			dst.Resize(static_cast<size_t>(write - dst.begin()));
+		__m128i invalid;
+		low = DecodeUtf8Lanes(_mm_shuffle_epi8(input, _mm_loadu_si128(reinterpret_cast<const __m128i*>(entry.Shuffle))), invalid);
+		if (entry.Count > 4)
+		{
+			__m128i invalidHigh;
+			high = DecodeUtf8Lanes(_mm_shuffle_epi8(input, _mm_loadu_si128(reinterpret_cast<const __m128i*>(entry.Shuffle + 16))), invalidHigh);
+			invalid = _mm_or_si128(invalid, invalidHigh);
 		}
-		catch (...)
+		else
 		{
-			dst.Resize(static_cast<size_t>(dstBegin - dst.begin()));
-			throw;
+			high = _mm_setzero_si128();
 		}
+
+		return _mm_testz_si128(invalid, invalid) ? &entry : nullptr;
 	}
 
-	template <>
-	void U8String::TransAppendTo(U32String& dst, View const& src)
+	NATSTRING_TARGET_SSE41 void StoreAscii(char16_t* write, __m128i input) noexcept
 	{
-		const auto dstBegin = dst.ResizeMore(src.size());
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(write), _mm_cvtepu8_epi16(input));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(write + 8), _mm_cvtepu8_epi16(_mm_srli_si128(input, 8)));
+	}
 
-		try
-		{
-			auto write = dstBegin;
-			const auto writeEnd = dst.end();
-			auto read = src.cbegin();
-			const auto readEnd = src.cend();
+	NATSTRING_TARGET_SSE41 void StoreAscii(char32_t* write, __m128i input) noexcept
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(write), _mm_cvtepu8_epi32(input));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(write + 4), _mm_cvtepu8_epi32(_mm_srli_si128(input, 4)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(write + 8), _mm_cvtepu8_epi32(_mm_srli_si128(input, 8)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(write + 12), _mm_cvtepu8_epi32(_mm_srli_si128(input, 12)));
+	}
 
-			EncodingResult result;
-			char32_t u32CodePoint;
+	NATSTRING_TARGET_SSE41 void StoreCodePoints(char16_t* write, __m128i low, __m128i high) noexcept
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(write), _mm_packus_epi32(low, high));
+	}
 
-			while (read < readEnd)
-			{
-				std::tie(result, u32CodePoint, read) = DecodeUtf8(read, readEnd);
-				if (result != EncodingResult::Accept)
-				{
-					nat_Throw(natException, "DecodeUtf8 failed."_nv);
-				}
-				std::tie(result, write) = EncodeUtf32(write, writeEnd, u32CodePoint);
-				assert(result == EncodingResult::Accept && "EncodeUtf32 failed.");
-			}
-			dst.Resize(static_cast<size_t>(write - dst.begin()));
-		}
-		catch (...)
-		{
-			dst.Resize(static_cast<size_t>(dstBegin - dst.begin()));
-			throw;
-		}
+	NATSTRING_TARGET_SSE41 void StoreCodePoints(char32_t* write, __m128i low, __m128i high) noexcept
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(write), low);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(write + 4), high);
 	}
 
-	template <>
-	void U8String::TransAppendFrom(U8String& dst, U32StringView const& src)
+	// ʵʾÿֽһԪʣ벻16ֽʱд16Ԫ
+	template <typename DstChar>
+	NATSTRING_TARGET_SSE41 nBool TransCodeUtf8Sse41(const char*& read, const char* readEnd, DstChar*& write) noexcept
 	{
-		const auto dstBegin = dst.ResizeMore(src.size() * 4);
+		const auto& tables = GetUtf8Tables();
 
-		try
+		while (readEnd - read >= 16)
 		{
-			auto write = dstBegin;
-			const auto writeEnd = dst.end();
-			auto read = src.cbegin();
-			const auto readEnd = src.cend();
+			const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(read));
+			const auto nonAsciiMask = static_cast<nuInt>(_mm_movemask_epi8(input));
 
-			EncodingResult result;
-			char32_t u32CodePoint;
+			// ʼ8ASCIIַʱֱչ
+			if (!(nonAsciiMask & 0xFF))
+			{
+				const auto asciiCount = nonAsciiMask ? CountTrailingZeros(nonAsciiMask) : 16;
+				StoreAscii(write, input);
+				read += asciiCount;
+				write += asciiCount;
+				continue;
+			}
 
-			while (read < readEnd)
+			__m128i low, high;
+			if (const auto entry = DecodeUtf8Block(tables, input, low, high))
 			{
-				std::tie(result, u32CodePoint, read) = DecodeUtf32(read, readEnd);
-				if (result != EncodingResult::Accept)
-				{
-					nat_Throw(natException, "DecodeUtf32 failed."_nv);
-				}
-				std::tie(result, write) = EncodeUtf8(write, writeEnd, u32CodePoint);
-				assert(result == EncodingResult::Accept && "EncodeUtf8 failed.");
+				StoreCodePoints(write, low, high);
+				read += entry->Consumed;
+				write += entry->Count;
+			}
+			else if (!TransCodeOne(read, readEnd, write))
+			{
+				return false;
 			}
-			dst.Resize(static_cast<size_t>(write - dst.begin()));
 		}
-		catch (...)
+
+		return TransCodeScalar(read, readEnd, write);
+	}
+
+	NATSTRING_TARGET_AVX2 __m256i DecodeUtf8Lanes(__m256i lanes, __m256i& invalid) noexcept
+	{
+		const auto byteMask = _mm256_set1_epi32(0xFF);
+		const auto byte0 = _mm256_and_si256(lanes, byteMask);
+		const auto byte1 = _mm256_and_si256(_mm256_srli_epi32(lanes, 8), byteMask);
+		const auto byte2 = _mm256_srli_epi32(lanes, 16);
+		const auto sum = _mm256_add_epi32(_mm256_add_epi32(byte0, _mm256_slli_epi32(byte1, 6)), _mm256_slli_epi32(byte2, 12));
+
+		const auto zero = _mm256_setzero_si256();
+		const auto isThreeBytes = _mm256_cmpgt_epi32(byte2, zero);
+		const auto isTwoBytes = _mm256_andnot_si256(isThreeBytes, _mm256_cmpgt_epi32(byte1, zero));
+
+		const auto offset = _mm256_or_si256(_mm256_and_si256(isThreeBytes, _mm256_set1_epi32(0xE2080)), _mm256_and_si256(isTwoBytes, _mm256_set1_epi32(0x3080)));
+		const auto minValue = _mm256_or_si256(_mm256_and_si256(isThreeBytes, _mm256_set1_epi32(0x800)), _mm256_and_si256(isTwoBytes, _mm256_set1_epi32(0x80)));
+		const auto maxValue = _mm256_blendv_epi8(_mm256_blendv_epi8(_mm256_set1_epi32(0x7F), _mm256_set1_epi32(0x7FF), isTwoBytes), _mm256_set1_epi32(0xFFFF), isThreeBytes);
+		const auto codePoint = _mm256_sub_epi32(sum, offset);
+
+		invalid = _mm256_or_si256(_mm256_or_si256(_mm256_cmpgt_epi32(minValue, codePoint), _mm256_cmpgt_epi32(codePoint, maxValue)),
+			_mm256_cmpeq_epi32(_mm256_and_si256(codePoint, _mm256_set1_epi32(0xF800)), _mm256_set1_epi32(0xD800)));
+		return codePoint;
+	}
+
+	// 16ֽڸƵ128λͨһ8ͨ
+	NATSTRING_TARGET_AVX2 const Utf8Tables::DecodeEntry* DecodeUtf8Block(Utf8Tables const& tables, __m128i input, __m256i& codePoints) noexcept
+	{
+		const auto continuation = _mm_cmplt_epi8(input, _mm_set1_epi8(static_cast<char>(0xC0)));
+		const auto endMask = (~static_cast<nuInt>(_mm_movemask_epi8(continuation)) >> 1) & 0xFFF;
+		const auto& entry = tables.Decode[endMask];
+		if (!entry.Count)
 		{
-			dst.Resize(static_cast<size_t>(dstBegin - dst.begin()));
-			throw;
+			return nullptr;
 		}
+
+		__m256i invalid;
+		const auto lanes = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(input), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(entry.Shuffle)));
+		codePoints = DecodeUtf8Lanes(lanes, invalid);
+		return _mm256_testz_si256(invalid, invalid) ? &entry : nullptr;
 	}
 
-	template <>
-	void U16String::TransAppendTo(U16String& dst, View const& src)
+	NATSTRING_TARGET_AVX2 void StoreAscii(char16_t* write, __m256i input) noexcept
 	{
-		const auto dstBegin = dst.ResizeMore(src.size());
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(write), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(input)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(write + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(input, 1)));
+	}
 
-		try
-		{
-			auto write = dstBegin;
-			const auto writeEnd = dst.end();
-			auto read = src.cbegin();
-			const auto readEnd = src.cend();
+	NATSTRING_TARGET_AVX2 void StoreAscii(char32_t* write, __m256i input) noexcept
+	{
+		const auto low = _mm256_castsi256_si128(input);
+		const auto high = _mm256_extracti128_si256(input, 1);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(write), _mm256_cvtepu8_epi32(low));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(write + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(low, 8)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(write + 16), _mm256_cvtepu8_epi32(high));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(write + 24), _mm256_cvtepu8_epi32(_mm_srli_si128(high, 8)));
+	}
 
-			EncodingResult result;
-			char32_t u32CodePoint;
+	NATSTRING_TARGET_AVX2 void StoreCodePoints(char16_t* write, __m256i codePoints) noexcept
+	{
+		const auto packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(codePoints, codePoints), 0x08);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(write), _mm256_castsi256_si128(packed));
+	}
 
-			while (read < readEnd)
-			{
-				std::tie(result, u32CodePoint, read) = DecodeUtf16(read, readEnd);
-				if (result != EncodingResult::Accept)
-				{
-					nat_Throw(natException, "DecodeUtf16 failed."_nv);
-				}
-				std::tie(result, write) = EncodeUtf16(write, writeEnd, u32CodePoint);
-				assert(result == EncodingResult::Accept && "EncodeUtf16 failed.");
-			}
-			dst.Resize(static_cast<size_t>(write - dst.begin()));
-		}
-		catch (...)
-		{
-			dst.Resize(static_cast<size_t>(dstBegin - dst.begin()));
-			throw;
-		}
+	NATSTRING_TARGET_AVX2 void StoreCodePoints(char32_t* write, __m256i codePoints) noexcept
+	{
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(write), codePoints);
 	}
 
-	template <>
-	void U16String::TransAppendFrom(U16String& dst, U16StringView const& src)
+	template <typename DstChar>
+	NATSTRING_TARGET_AVX2 nBool TransCodeUtf8Avx2(const char*& read, const char* readEnd, DstChar*& write) noexcept
 	{
-		const auto dstBegin = dst.ResizeMore(src.size());
+		const auto& tables = GetUtf8Tables();
 
-		try
+		while (readEnd - read >= 32)
 		{
-			auto write = dstBegin;
-			const auto writeEnd = dst.end();
-			auto read = src.cbegin();
-			const auto readEnd = src.cend();
+			const auto input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(read));
+			const auto nonAsciiMask = static_cast<nuInt>(_mm256_movemask_epi8(input));
 
-			EncodingResult result;
-			char32_t u32CodePoint;
+			if (!(nonAsciiMask & 0xFFFF))
+			{
+				const auto asciiCount = nonAsciiMask ? CountTrailingZeros(nonAsciiMask) : 32;
+				StoreAscii(write, input);
+				read += asciiCount;
+				write += asciiCount;
+				continue;
+			}
 
-			while (read < readEnd)
+			__m256i codePoints;
+			if (const auto entry = DecodeUtf8Block(tables, _mm256_castsi256_si128(input), codePoints))
 			{
-				std::tie(result, u32CodePoint, read) = DecodeUtf16(read, readEnd);
-				if (result != EncodingResult::Accept)
-				{
-					nat_Throw(natException, "DecodeUtf16 failed."_nv);
-				}
-				std::tie(result, write) = EncodeUtf16(write, writeEnd, u32CodePoint);
-				assert(result == EncodingResult::Accept && "EncodeUtf16 failed.");
+				StoreCodePoints(write, codePoints);
+				read += entry->Consumed;
+				write += entry->Count;
+			}
+			else if (!TransCodeOne(read, readEnd, write))
+			{
+				return false;
 			}
-			dst.Resize(static_cast<size_t>(write - dst.begin()));
-		}
-		catch (...)
-		{
-			dst.Resize(static_cast<size_t>(dstBegin - dst.begin()));
-			throw;
 		}
+
+		return TransCodeUtf8Sse41(read, readEnd, write);
 	}
 
-	template <>
-	void U16String::TransAppendTo(U32String& dst, View const& src)
+	// ʵʾ32λͨΪ0xFFFFҲΪ㣬д12ֽڣд16ֽ
+	NATSTRING_TARGET_SSE41 void EncodeUtf8Lanes(Utf8Tables const& tables, __m128i codePoints, char*& write) noexcept
 	{
-		const auto dstBegin = dst.ResizeMore(src.size());
+		const auto sixBits = _mm_set1_epi32(0x3F);
+		const auto low = _mm_and_si128(codePoints, sixBits);
+		const auto middle = _mm_and_si128(_mm_srli_epi32(codePoints, 6), sixBits);
+
+		// 110xxxxx 10xxxxxx
+		const auto twoBytes = _mm_or_si128(_mm_or_si128(_mm_srli_epi32(codePoints, 6), _mm_slli_epi32(low, 8)), _mm_set1_epi32(0x80C0));
+		// 1110xxxx 10xxxxxx 10xxxxxx
+		const auto threeBytes = _mm_or_si128(_mm_or_si128(_mm_srli_epi32(codePoints, 12), _mm_slli_epi32(middle, 8)),
+			_mm_or_si128(_mm_slli_epi32(low, 16), _mm_set1_epi32(0x8080E0)));
+
+		const auto isTwoBytes = _mm_cmpgt_epi32(codePoints, _mm_set1_epi32(0x7F));
+		const auto isThreeBytes = _mm_cmpgt_epi32(codePoints, _mm_set1_epi32(0x7FF));
+		const auto lanes = _mm_blendv_epi8(_mm_blendv_epi8(codePoints, twoBytes, isTwoBytes), threeBytes, isThreeBytes);
+
+		const auto index = _mm_movemask_ps(_mm_castsi128_ps(isTwoBytes)) | _mm_movemask_ps(_mm_castsi128_ps(isThreeBytes)) << 4;
+		const auto& entry = tables.Encode[index];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(write), _mm_shuffle_epi8(lanes, _mm_loadu_si128(reinterpret_cast<const __m128i*>(entry.Shuffle))));
+		write += entry.Length;
+	}
 
-		try
-		{
-			auto write = dstBegin;
-			const auto writeEnd = dst.end();
-			auto read = src.cbegin();
-			const auto readEnd = src.cend();
+	// ʵʾÿδ8Ԫд28ֽڣ16Ԫ48ֽڵдʱǰĲ
+	NATSTRING_TARGET_SSE41 nBool TransCodeUtf16ToUtf8Sse41(const char16_t*& read, const char16_t* readEnd, char*& write) noexcept
+	{
+		const auto& tables = GetUtf8Tables();
 
-			EncodingResult result;
-			char32_t u32CodePoint;
+		while (readEnd - read >= 16)
+		{
+			const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(read));
+			if (_mm_testz_si128(input, _mm_set1_epi16(static_cast<short>(0xFF80))))
+			{
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(write), _mm_packus_epi16(input, input));
+				read += 8;
+				write += 8;
+				continue;
+			}
 
-			while (read < readEnd)
+			const auto surrogate = _mm_cmpeq_epi16(_mm_and_si128(input, _mm_set1_epi16(static_cast<short>(0xF800))), _mm_set1_epi16(static_cast<short>(0xD800)));
+			const auto surrogateMask = static_cast<nuInt>(_mm_movemask_epi8(surrogate));
+			if (surrogateMask & 0xFF)
 			{
-				std::tie(result, u32CodePoint, read) = DecodeUtf16(read, readEnd);
-				if (result != EncodingResult::Accept)
+				if (!TransCodeOne(read, readEnd, write))
 				{
-					nat_Throw(natException, "DecodeUtf16 failed."_nv);
+					return false;
 				}
-				std::tie(result, write) = EncodeUtf32(write, writeEnd, u32CodePoint);
-				assert(result == EncodingResult::Accept && "EncodeUtf32 failed.");
+				continue;
 			}
-			dst.Resize(static_cast<size_t>(write - dst.begin()));
-		}
-		catch (...)
-		{
-			dst.Resize(static_cast<size_t>(dstBegin - dst.begin()));
-			throw;
+
+			EncodeUtf8Lanes(tables, _mm_cvtepu16_epi32(input), write);
+			if (surrogateMask)
+			{
+				read += 4;
+				continue;
+			}
+
+			EncodeUtf8Lanes(tables, _mm_cvtepu16_epi32(_mm_srli_si128(input, 8)), write);
+			read += 8;
 		}
+
+		return TransCodeScalar(read, readEnd, write);
 	}
 
-	template <>
-	void U16String::TransAppendFrom(U16String& dst, U32StringView const& src)
+	// ʵʾÿд16ֽڣ8Ԫ32ֽڵ
+	NATSTRING_TARGET_SSE41 nBool TransCodeUtf32ToUtf8Sse41(const char32_t*& read, const char32_t* readEnd, char*& write) noexcept
 	{
-		const auto dstBegin = dst.ResizeMore(src.size() * 2);
+		const auto& tables = GetUtf8Tables();
+		const auto maxValue = _mm_set1_epi32(0xFFFF);
 
-		try
+		while (readEnd - read >= 8)
 		{
-			auto write = dstBegin;
-			const auto writeEnd = dst.end();
-			auto read = src.cbegin();
-			const auto readEnd = src.cend();
-
-			EncodingResult result;
-			char32_t u32CodePoint;
-
-			while (read < readEnd)
+			const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(read));
+			const auto inBmp = _mm_cmpeq_epi32(_mm_max_epu32(input, maxValue), maxValue);
+			const auto surrogate = _mm_cmpeq_epi32(_mm_and_si128(input, _mm_set1_epi32(0xF800)), _mm_set1_epi32(0xD800));
+			if (_mm_movemask_epi8(_mm_andnot_si128(surrogate, inBmp)) == 0xFFFF)
 			{
-				std::tie(result, u32CodePoint, read) = DecodeUtf32(read, readEnd);
-				if (result != EncodingResult::Accept)
-				{
-					nat_Throw(natException, "DecodeUtf32 failed."_nv);
-				}
-				std::tie(result, write) = EncodeUtf16(write, writeEnd, u32CodePoint);
-				assert(result == EncodingResult::Accept && "EncodeUtf16 failed.");
+				EncodeUtf8Lanes(tables, input, write);
+				read += 4;
+			}
+			else if (!TransCodeOne(read, readEnd, write))
+			{
+				return false;
 			}
-			dst.Resize(static_cast<size_t>(write - dst.begin()));
 		}
-		catch (...)
+
+		return TransCodeScalar(read, readEnd, write);
+	}
+
+	NATSTRING_TARGET_SSE41 nBool TransCodeUtf16ToUtf32Sse41(const char16_t*& read, const char16_t* readEnd, char32_t*& write) noexcept
+	{
+		while (readEnd - read >= 8)
 		{
-			dst.Resize(static_cast<size_t>(dstBegin - dst.begin()));
-			throw;
+			const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(read));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(write), _mm_cvtepu16_epi32(input));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(write + 4), _mm_cvtepu16_epi32(_mm_srli_si128(input, 8)));
+
+			const auto surrogate = _mm_cmpeq_epi16(_mm_and_si128(input, _mm_set1_epi16(static_cast<short>(0xF800))), _mm_set1_epi16(static_cast<short>(0xD800)));
+			const auto surrogateMask = static_cast<nuInt>(_mm_movemask_epi8(surrogate));
+			if (!surrogateMask)
+			{
+				read += 8;
+				write += 8;
+				continue;
+			}
+
+			// ֮ǰĲ֣ɱ汾
+			const auto prefix = CountTrailingZeros(surrogateMask) / 2;
+			read += prefix;
+			write += prefix;
+			if (!TransCodeOne(read, readEnd, write))
+			{
+				return false;
+			}
 		}
+
+		return TransCodeScalar(read, readEnd, write);
 	}
 
-	template <>
-	void U32String::TransAppendTo(U16String& dst, View const& src)
+	NATSTRING_TARGET_SSE41 nBool TransCodeUtf32ToUtf16Sse41(const char32_t*& read, const char32_t* readEnd, char16_t*& write) noexcept
+	{
+		const auto maxValue = _mm_set1_epi32(0xFFFF);
+		const auto surrogateMask = _mm_set1_epi32(0xF800);
+		const auto surrogateValue = _mm_set1_epi32(0xD800);
+
+		while (readEnd - read >= 8)
+		{
+			const auto low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(read));
+			const auto high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(read + 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(write), _mm_packus_epi32(low, high));
+
+			const auto validLow = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_and_si128(low, surrogateMask), surrogateValue), _mm_cmpeq_epi32(_mm_max_epu32(low, maxValue), maxValue));
+			const auto validHigh = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_and_si128(high, surrogateMask), surrogateValue), _mm_cmpeq_epi32(_mm_max_epu32(high, maxValue), maxValue));
+			const auto invalidMask = ~static_cast<nuInt>(_mm_movemask_ps(_mm_castsi128_ps(validLow)) | _mm_movemask_ps(_mm_castsi128_ps(validHigh)) << 4) & 0xFF;
+			if (!invalidMask)
+			{
+				read += 8;
+				write += 8;
+				continue;
+			}
+
+			const auto prefix = CountTrailingZeros(invalidMask);
+			read += prefix;
+			write += prefix;
+			if (!TransCodeOne(read, readEnd, write))
+			{
+				return false;
+			}
+		}
+
+		return TransCodeScalar(read, readEnd, write);
+	}
+
+	// ο Keiser, Lemire. Validating UTF-8 In Less Than One Instruction Per Byte
+	// ʵʾǰһֽڵĸߵ4λǰֽڵĸ4λ߰λĽ㼴ʾڴ
+	//          3ֽڼ4ֽеĵֽǷΪֽм
+	enum : nByte
+	{
+		Utf8TooShort = 1 << 0,		// 11______ 0_______  11______ 11______
+		Utf8TooLong = 1 << 1,		// 0_______ 10______
+		Utf8Overlong3 = 1 << 2,		// 11100000 100_____
+		Utf8TooLarge = 1 << 3,		// 11110100 1001____  11110100 101_____  11110101+ 10______
+		Utf8Surrogate = 1 << 4,		// 11101101 101_____
+		Utf8Overlong2 = 1 << 5,		// 1100000_ 10______
+		Utf8TooLarge1000 = 1 << 6,	// 11110101+ 1000____
+		Utf8Overlong4 = 1 << 6,		// 11110000 1000____
+		Utf8TwoConts = 1 << 7,		// 10______ 10______
+		Utf8Carry = Utf8TooShort | Utf8TooLong | Utf8TwoConts,
+	};
+
+	alignas(16) const nByte Utf8Byte1High[16] = {
+		Utf8TooLong, Utf8TooLong, Utf8TooLong, Utf8TooLong,
+		Utf8TooLong, Utf8TooLong, Utf8TooLong, Utf8TooLong,
+		Utf8TwoConts, Utf8TwoConts, Utf8TwoConts, Utf8TwoConts,
+		Utf8TooShort | Utf8Overlong2,
+		Utf8TooShort,
+		Utf8TooShort | Utf8Overlong3 | Utf8Surrogate,
+		Utf8TooShort | Utf8TooLarge | Utf8TooLarge1000 | Utf8Overlong4,
+	};
+
+	alignas(16) const nByte Utf8Byte1Low[16] = {
+		Utf8Carry | Utf8Overlong3 | Utf8Overlong2 | Utf8Overlong4,
+		Utf8Carry | Utf8Overlong2,
+		Utf8Carry,
+		Utf8Carry,
+		Utf8Carry | Utf8TooLarge,
+		Utf8Carry | Utf8TooLarge | Utf8TooLarge1000,
+		Utf8Carry | Utf8TooLarge | Utf8TooLarge1000,
+		Utf8Carry | Utf8TooLarge | Utf8TooLarge1000,
+		Utf8Carry | Utf8TooLarge | Utf8TooLarge1000,
+		Utf8Carry | Utf8TooLarge | Utf8TooLarge1000,
+		Utf8Carry | Utf8TooLarge | Utf8TooLarge1000,
+		Utf8Carry | Utf8TooLarge | Utf8TooLarge1000,
+		Utf8Carry | Utf8TooLarge | Utf8TooLarge1000,
+		Utf8Carry | Utf8TooLarge | Utf8TooLarge1000 | Utf8Surrogate,
+		Utf8Carry | Utf8TooLarge | Utf8TooLarge1000,
+		Utf8Carry | Utf8TooLarge | Utf8TooLarge1000,
+	};
+
+	alignas(16) const nByte Utf8Byte2High[16] = {
+		Utf8TooShort, Utf8TooShort, Utf8TooShort, Utf8TooShort,
+		Utf8TooShort, Utf8TooShort, Utf8TooShort, Utf8TooShort,
+		Utf8TooLong | Utf8Overlong2 | Utf8TwoConts | Utf8Overlong3 | Utf8TooLarge1000 | Utf8Overlong4,
+		Utf8TooLong | Utf8Overlong2 | Utf8TwoConts | Utf8Overlong3 | Utf8TooLarge,
+		Utf8TooLong | Utf8Overlong2 | Utf8TwoConts | Utf8Surrogate | Utf8TooLarge,
+		Utf8TooLong | Utf8Overlong2 | Utf8TwoConts | Utf8Surrogate | Utf8TooLarge,
+		Utf8TooShort, Utf8TooShort, Utf8TooShort, Utf8TooShort,
+	};
+
+	// ʵʾprevΪǰһ飬errorۻincomplete¼ĩβǷδ
+	NATSTRING_TARGET_SSE41 void ValidateUtf8Block(__m128i input, __m128i& prev, __m128i& error, __m128i& incomplete) noexcept
+	{
+		if (!_mm_movemask_epi8(input))
+		{
+			error = _mm_or_si128(error, incomplete);
+			incomplete = _mm_setzero_si128();
+			prev = input;
+			return;
+		}
+
+		const auto lowNibble = _mm_set1_epi8(0x0F);
+		const auto prev1 = _mm_alignr_epi8(input, prev, 15);
+		const auto byte1High = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Byte1High)), _mm_and_si128(_mm_srli_epi16(prev1, 4), lowNibble));
+		const auto byte1Low = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Byte1Low)), _mm_and_si128(prev1, lowNibble));
+		const auto byte2High = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Byte2High)), _mm_and_si128(_mm_srli_epi16(input, 4), lowNibble));
+		const auto special = _mm_and_si128(_mm_and_si128(byte1High, byte1Low), byte2High);
+
+		// ǰڶֽڲС0xE0ǰֽڲС0xF0ʱǰֽڱΪֽ
+		const auto prev2 = _mm_alignr_epi8(input, prev, 14);
+		const auto prev3 = _mm_alignr_epi8(input, prev, 13);
+		const auto mustBeContinuation = _mm_and_si128(_mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8(0x60)), _mm_subs_epu8(prev3, _mm_set1_epi8(0x70))), _mm_set1_epi8(static_cast<char>(0x80)));
+
+		error = _mm_or_si128(error, _mm_xor_si128(mustBeContinuation, special));
+		incomplete = _mm_subs_epu8(input, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+			static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1)));
+		prev = input;
+	}
+
+	NATSTRING_TARGET_SSE41 nBool ValidateUtf8Sse41(const char* read, const char* readEnd) noexcept
+	{
+		auto prev = _mm_setzero_si128(), error = _mm_setzero_si128(), incomplete = _mm_setzero_si128();
+
+		for (; readEnd - read >= 16; read += 16)
+		{
+			ValidateUtf8Block(_mm_loadu_si128(reinterpret_cast<const __m128i*>(read)), prev, error, incomplete);
+		}
+
+		// ʣಿ0䣬0ΪASCIIַӰ
+		alignas(16) char tail[16]{};
+		std::memcpy(tail, read, static_cast<size_t>(readEnd - read));
+		ValidateUtf8Block(_mm_load_si128(reinterpret_cast<const __m128i*>(tail)), prev, error, incomplete);
+
+		error = _mm_or_si128(error, incomplete);
+		return _mm_testz_si128(error, error) != 0;
+	}
+
+	NATSTRING_TARGET_AVX2 void ValidateUtf8Block(__m256i input, __m256i& prev, __m256i& error, __m256i& incomplete) noexcept
+	{
+		if (!_mm256_movemask_epi8(input))
+		{
+			error = _mm256_or_si256(error, incomplete);
+			incomplete = _mm256_setzero_si256();
+			prev = input;
+			return;
+		}
+
+		// ǰһĸ128λ뵱ǰĵ128λƴӣʹ128λͨеalignrܹԽͨ
+		const auto shifted = _mm256_permute2x128_si256(prev, input, 0x21);
+		const auto lowNibble = _mm256_set1_epi8(0x0F);
+		const auto prev1 = _mm256_alignr_epi8(input, shifted, 15);
+		const auto byte1High = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Byte1High))), _mm256_and_si256(_mm256_srli_epi16(prev1, 4), lowNibble));
+		const auto byte1Low = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Byte1Low))), _mm256_and_si256(prev1, lowNibble));
+		const auto byte2High = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Byte2High))), _mm256_and_si256(_mm256_srli_epi16(input, 4), lowNibble));
+		const auto special = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+
+		const auto prev2 = _mm256_alignr_epi8(input, shifted, 14);
+		const auto prev3 = _mm256_alignr_epi8(input, shifted, 13);
+		const auto mustBeContinuation = _mm256_and_si256(_mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8(0x60)), _mm256_subs_epu8(prev3, _mm256_set1_epi8(0x70))), _mm256_set1_epi8(static_cast<char>(0x80)));
+
+		error = _mm256_or_si256(error, _mm256_xor_si256(mustBeContinuation, special));
+		incomplete = _mm256_subs_epu8(input, _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+			static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1)));
+		prev = input;
+	}
+
+	NATSTRING_TARGET_AVX2 nBool ValidateUtf8Avx2(const char* read, const char* readEnd) noexcept
 	{
-		const auto dstBegin = dst.ResizeMore(src.size() * 2);
+		auto prev = _mm256_setzero_si256(), error = _mm256_setzero_si256(), incomplete = _mm256_setzero_si256();
+
+		for (; readEnd - read >= 32; read += 32)
+		{
+			ValidateUtf8Block(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(read)), prev, error, incomplete);
+		}
 
-		try
+		alignas(32) char tail[32]{};
+		std::memcpy(tail, read, static_cast<size_t>(readEnd - read));
+		ValidateUtf8Block(_mm256_load_si256(reinterpret_cast<const __m256i*>(tail)), prev, error, incomplete);
+
+		error = _mm256_or_si256(error, incomplete);
+		return _mm256_testz_si256(error, error) != 0;
+	}
+
+	NATSTRING_TARGET_SSE41 nBool ValidateUtf16Sse41(const char16_t* read, const char16_t* readEnd) noexcept
+	{
+		while (readEnd - read >= 8)
 		{
-			auto write = dstBegin;
-			const auto writeEnd = dst.end();
-			auto read = src.cbegin();
-			const auto readEnd = src.cend();
+			const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(read));
+			const auto surrogate = _mm_cmpeq_epi16(_mm_and_si128(input, _mm_set1_epi16(static_cast<short>(0xF800))), _mm_set1_epi16(static_cast<short>(0xD800)));
+			const auto surrogateMask = static_cast<nuInt>(_mm_movemask_epi8(surrogate));
+			if (!surrogateMask)
+			{
+				read += 8;
+				continue;
+			}
 
+			// ɱ汾Ƿɶ
+			read += CountTrailingZeros(surrogateMask) / 2;
 			EncodingResult result;
-			char32_t u32CodePoint;
+			std::tie(result, std::ignore, read) = DecodeUtf16(read, readEnd);
+			if (result != EncodingResult::Accept)
+			{
+				return false;
+			}
+		}
+
+		return ValidateScalar(read, readEnd);
+	}
+
+	NATSTRING_TARGET_SSE41 nBool ValidateUtf32Sse41(const char32_t* read, const char32_t* readEnd) noexcept
+	{
+		const auto maxValue = _mm_set1_epi32(0x10FFFF);
+		auto error = _mm_setzero_si128();
+
+		for (; readEnd - read >= 4; read += 4)
+		{
+			const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(read));
+			const auto tooLarge = _mm_xor_si128(_mm_cmpeq_epi32(_mm_max_epu32(input, maxValue), maxValue), _mm_set1_epi32(-1));
+			const auto surrogate = _mm_cmpeq_epi32(_mm_and_si128(input, _mm_set1_epi32(static_cast<int>(0xFFFFF800))), _mm_set1_epi32(0xD800));
+			error = _mm_or_si128(error, _mm_or_si128(tooLarge, surrogate));
+		}
+
+		return _mm_testz_si128(error, error) && ValidateScalar(read, readEnd);
+	}
+#endif
+
+	template <typename DstChar>
+	nBool TransCode(const char*& read, const char* readEnd, DstChar*& write) noexcept
+	{
+#ifdef NATSTRING_X64
+		switch (g_SimdLevel)
+		{
+		case SimdLevel::Avx2:
+			return TransCodeUtf8Avx2(read, readEnd, write);
+		case SimdLevel::Sse41:
+			return TransCodeUtf8Sse41(read, readEnd, write);
+		default:
+			break;
+		}
+#endif
+		return TransCodeScalar(read, readEnd, write);
+	}
+
+	nBool TransCode(const char16_t*& read, const char16_t* readEnd, char*& write) noexcept
+	{
+#ifdef NATSTRING_X64
+		if (g_SimdLevel != SimdLevel::Scalar)
+		{
+			return TransCodeUtf16ToUtf8Sse41(read, readEnd, write);
+		}
+#endif
+		return TransCodeScalar(read, readEnd, write);
+	}
+
+	nBool TransCode(const char32_t*& read, const char32_t* readEnd, char*& write) noexcept
+	{
+#ifdef NATSTRING_X64
+		if (g_SimdLevel != SimdLevel::Scalar)
+		{
+			return TransCodeUtf32ToUtf8Sse41(read, readEnd, write);
+		}
+#endif
+		return TransCodeScalar(read, readEnd, write);
+	}
+
+	nBool TransCode(const char16_t*& read, const char16_t* readEnd, char32_t*& write) noexcept
+	{
+#ifdef NATSTRING_X64
+		if (g_SimdLevel != SimdLevel::Scalar)
+		{
+			return TransCodeUtf16ToUtf32Sse41(read, readEnd, write);
+		}
+#endif
+		return TransCodeScalar(read, readEnd, write);
+	}
+
+	nBool TransCode(const char32_t*& read, const char32_t* readEnd, char16_t*& write) noexcept
+	{
+#ifdef NATSTRING_X64
+		if (g_SimdLevel != SimdLevel::Scalar)
+		{
+			return TransCodeUtf32ToUtf16Sse41(read, readEnd, write);
+		}
+#endif
+		return TransCodeScalar(read, readEnd, write);
+	}
+
+	// ʵʾmaxExpansionΪÿԴ뵥ԪĿ뵥Ԫʧʱıdst
+	template <typename DstString, typename SrcView>
+	nBool TransAppendBulk(DstString& dst, SrcView const& src, size_t maxExpansion)
+	{
+		const auto dstBegin = dst.ResizeMore(src.size() * maxExpansion);
+		const auto oldSize = static_cast<size_t>(dstBegin - dst.begin());
+		auto read = src.cbegin();
+		auto write = dstBegin;
+
+		if (!TransCode(read, src.cend(), write))
+		{
+			dst.Resize(oldSize);
+			return false;
+		}
+
+		dst.Resize(static_cast<size_t>(write - dst.begin()));
+		return true;
+	}
+}
+
+nBool NatsuLib::ValidateUtf8(const char* strBegin, const char* strEnd) noexcept
+{
+	if (strBegin == strEnd)
+	{
+		return true;
+	}
+
+#ifdef NATSTRING_X64
+	switch (g_SimdLevel)
+	{
+	case SimdLevel::Avx2:
+		return ValidateUtf8Avx2(strBegin, strEnd);
+	case SimdLevel::Sse41:
+		return ValidateUtf8Sse41(strBegin, strEnd);
+	default:
+		break;
+	}
+#endif
+	return ValidateScalar(strBegin, strEnd);
+}
+
+nBool NatsuLib::ValidateUtf16(const char16_t* strBegin, const char16_t* strEnd) noexcept
+{
+	if (strBegin == strEnd)
+	{
+		return true;
+	}
+
+#ifdef NATSTRING_X64
+	if (g_SimdLevel != SimdLevel::Scalar)
+	{
+		return ValidateUtf16Sse41(strBegin, strEnd);
+	}
+#endif
+	return ValidateScalar(strBegin, strEnd);
+}
+
+nBool NatsuLib::ValidateUtf32(const char32_t* strBegin, const char32_t* strEnd) noexcept
+{
+	if (strBegin == strEnd)
+	{
+		return true;
+	}
+
+#ifdef NATSTRING_X64
+	if (g_SimdLevel != SimdLevel::Scalar)
+	{
+		return ValidateUtf32Sse41(strBegin, strEnd);
+	}
+#endif
+	return ValidateScalar(strBegin, strEnd);
+}
+
+namespace
+{
+	// ʵʾ²ҺequalΪfalseʱ׸findCharԪأǰδҵʱendδҵʱnullptr
 
-			while (read < readEnd)
+	template <typename T>
+	const T* SearchCharScalar(const T* read, const T* end, T findChar, nBool equal) noexcept
+	{
+		for (; read < end; ++read)
+		{
+			if ((*read == findChar) == equal)
 			{
-				std::tie(result, u32CodePoint, read) = DecodeUtf32(read, readEnd);
-				if (result != EncodingResult::Accept)
-				{
-					nat_Throw(natException, "DecodeUtf32 failed."_nv);
-				}
-				std::tie(result, write) = EncodeUtf16(write, writeEnd, u32CodePoint);
-				assert(result == EncodingResult::Accept && "EncodeUtf16 failed.");
+				return read;
 			}
-			dst.Resize(static_cast<size_t>(write - dst.begin()));
 		}
-		catch (...)
+
+		return end;
+	}
+
+	template <typename T>
+	const T* SearchCharBackwardScalar(const T* begin, const T* read, T findChar, nBool equal) noexcept
+	{
+		while (read > begin)
 		{
-			dst.Resize(static_cast<size_t>(dstBegin - dst.begin()));
-			throw;
+			if ((*--read == findChar) == equal)
+			{
+				return read;
+			}
 		}
+
+		return nullptr;
 	}
 
-	template <>
-	void U32String::TransAppendFrom(U32String& dst, U16StringView const& src)
+	template <typename T>
+	const T* SearchAnyCharScalar(const T* read, const T* end, const T* setBegin, const T* setEnd) noexcept
 	{
-		const auto dstBegin = dst.ResizeMore(src.size());
+		for (; read < end; ++read)
+		{
+			if (std::find(setBegin, setEnd, *read) != setEnd)
+			{
+				return read;
+			}
+		}
+
+		return end;
+	}
 
-		try
+	// βԪɸѡѡλúٱȽϣڴһʣಿ
+	template <typename T>
+	const T* SearchStringScalar(const T* read, const T* end, const T* pattern, size_t patternLength) noexcept
+	{
+		for (; static_cast<size_t>(end - read) >= patternLength; ++read)
 		{
-			auto write = dstBegin;
-			const auto writeEnd = dst.end();
-			auto read = src.cbegin();
-			const auto readEnd = src.cend();
+			if (read[0] == pattern[0] && read[patternLength - 1] == pattern[patternLength - 1] && std::equal(pattern + 1, pattern + patternLength - 1, read + 1))
+			{
+				return read;
+			}
+		}
 
-			EncodingResult result;
-			char32_t u32CodePoint;
+		return nullptr;
+	}
+
+	template <typename T>
+	const T* SearchStringBackwardScalar(const T* begin, const T* end, const T* pattern, size_t patternLength) noexcept
+	{
+		if (static_cast<size_t>(end - begin) < patternLength)
+		{
+			return nullptr;
+		}
 
-			while (read < readEnd)
+		for (auto read = end - patternLength + 1; read > begin; )
+		{
+			--read;
+			if (read[0] == pattern[0] && read[patternLength - 1] == pattern[patternLength - 1] && std::equal(pattern + 1, pattern + patternLength - 1, read + 1))
 			{
-				std::tie(result, u32CodePoint, read) = DecodeUtf16(read, readEnd);
-				if (result != EncodingResult::Accept)
-				{
-					nat_Throw(natException, "DecodeUtf16 failed."_nv);
-				}
-				std::tie(result, write) = EncodeUtf32(write, writeEnd, u32CodePoint);
-				assert(result == EncodingResult::Accept && "EncodeUtf32 failed.");
+				return read;
 			}
-			dst.Resize(static_cast<size_t>(write - dst.begin()));
 		}
-		catch (...)
+
+		return nullptr;
+	}
+
+	// ʹKMP㷨֤µԸӶ
+	template <typename T>
+	const T* SearchStringKmp(const T* begin, const T* end, const T* pattern, size_t patternLength) noexcept
+	{
+		if (static_cast<size_t>(end - begin) < patternLength)
 		{
-			dst.Resize(static_cast<size_t>(dstBegin - dst.begin()));
-			throw;
+			return nullptr;
 		}
+
+		const auto pos = detail_::MatchString(begin, end, pattern, pattern + patternLength);
+		return pos == detail_::npos ? nullptr : begin + pos;
 	}
 
-	template <>
-	void U32String::TransAppendTo(U32String& dst, View const& src)
+	template <typename T>
+	const T* SearchStringBackwardKmp(const T* begin, const T* end, const T* pattern, size_t patternLength) noexcept
 	{
-		const auto dstBegin = dst.ResizeMore(src.size());
+		typedef std::reverse_iterator<const T*> ReverseIterator;
 
-		try
+		if (static_cast<size_t>(end - begin) < patternLength)
 		{
-			auto write = dstBegin;
-			const auto writeEnd = dst.end();
-			auto read = src.cbegin();
-			const auto readEnd = src.cend();
+			return nullptr;
+		}
 
-			EncodingResult result;
-			char32_t u32CodePoint;
+		const auto pos = detail_::MatchString(ReverseIterator{ end }, ReverseIterator{ begin }, ReverseIterator{ pattern + patternLength }, ReverseIterator{ pattern });
+		return pos == detail_::npos ? nullptr : end - pos - patternLength;
+	}
+
+	// ѡλõ֤ȽϵԪɨԪĸñʱKMP㷨
+	constexpr size_t SearchVerifyFactor = 8;
+	constexpr size_t SearchVerifyThreshold = 4096;
+
+#ifdef NATSTRING_X64
+	size_t HighestSetBit(nuInt value) noexcept
+	{
+		assert(value);
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse(&index, value);
+		return index;
+#else
+		return static_cast<size_t>(31 - __builtin_clz(value));
+#endif
+	}
+
+	// еindexԪضӦλ
+	template <typename T>
+	nuInt ClearElement(nuInt mask, size_t index) noexcept
+	{
+		return mask & ~(((1u << sizeof(T)) - 1) << (index * sizeof(T)));
+	}
+
+	__m128i Broadcast(char value) noexcept
+	{
+		return _mm_set1_epi8(value);
+	}
+
+	__m128i Broadcast(char16_t value) noexcept
+	{
+		return _mm_set1_epi16(static_cast<short>(value));
+	}
+
+	__m128i Broadcast(char32_t value) noexcept
+	{
+		return _mm_set1_epi32(static_cast<int>(value));
+	}
+
+	__m128i CompareEqual(__m128i a, __m128i b, char) noexcept
+	{
+		return _mm_cmpeq_epi8(a, b);
+	}
+
+	__m128i CompareEqual(__m128i a, __m128i b, char16_t) noexcept
+	{
+		return _mm_cmpeq_epi16(a, b);
+	}
 
-			while (read < readEnd)
+	__m128i CompareEqual(__m128i a, __m128i b, char32_t) noexcept
+	{
+		return _mm_cmpeq_epi32(a, b);
+	}
+
+	template <typename T>
+	__m128i Load(const T* read) noexcept
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(read));
+	}
+
+	// ʵʾx64SSE2ǿãSSE2汾
+	template <typename T>
+	const T* SearchCharSse2(const T* read, const T* end, T findChar, nBool equal) noexcept
+	{
+		constexpr std::ptrdiff_t Width = 16 / sizeof(T);
+		const auto needle = Broadcast(findChar);
+		const nuInt flip = equal ? 0 : 0xFFFF;
+
+		for (; end - read >= Width; read += Width)
+		{
+			const auto mask = static_cast<nuInt>(_mm_movemask_epi8(CompareEqual(Load(read), needle, T{}))) ^ flip;
+			if (mask)
 			{
-				std::tie(result, u32CodePoint, read) = DecodeUtf32(read, readEnd);
-				if (result != EncodingResult::Accept)
-				{
-					nat_Throw(natException, "DecodeUtf32 failed."_nv);
-				}
-				std::tie(result, write) = EncodeUtf32(write, writeEnd, u32CodePoint);
-				assert(result == EncodingResult::Accept && "EncodeUtf32 failed.");
+				return read + CountTrailingZeros(mask) / sizeof(T);
 			}
-			dst.Resize(static_cast<size_t>(write - dst.begin()));
 		}
-		catch (...)
+
+		return SearchCharScalar(read, end, findChar, equal);
+	}
+
+	template <typename T>
+	const T* SearchCharBackwardSse2(const T* begin, const T* read, T findChar, nBool equal) noexcept
+	{
+		constexpr std::ptrdiff_t Width = 16 / sizeof(T);
+		const auto needle = Broadcast(findChar);
+		const nuInt flip = equal ? 0 : 0xFFFF;
+
+		for (; read - begin >= Width; read -= Width)
 		{
-			dst.Resize(static_cast<size_t>(dstBegin - dst.begin()));
-			throw;
+			const auto mask = static_cast<nuInt>(_mm_movemask_epi8(CompareEqual(Load(read - Width), needle, T{}))) ^ flip;
+			if (mask)
+			{
+				return read - Width + HighestSetBit(mask) / sizeof(T);
+			}
 		}
+
+		return SearchCharBackwardScalar(begin, read, findChar, equal);
 	}
 
-	template <>
-	void U32String::TransAppendFrom(U32String& dst, U32StringView const& src)
+	// ʵʾÿ뼯еÿַһȽϣϽϴʱɱ汾
+	template <typename T>
+	const T* SearchAnyCharSse2(const T* read, const T* end, const T* setBegin, const T* setEnd) noexcept
 	{
-		const auto dstBegin = dst.ResizeMore(src.size());
+		constexpr std::ptrdiff_t Width = 16 / sizeof(T);
+		constexpr size_t MaxSetSize = 16;
 
-		try
+		const auto setSize = static_cast<size_t>(setEnd - setBegin);
+		if (setSize > MaxSetSize)
 		{
-			auto write = dstBegin;
-			const auto writeEnd = dst.end();
-			auto read = src.cbegin();
-			const auto readEnd = src.cend();
+			return SearchAnyCharScalar(read, end, setBegin, setEnd);
+		}
 
-			EncodingResult result;
-			char32_t u32CodePoint;
+		__m128i needles[MaxSetSize];
+		for (size_t i = 0; i < setSize; ++i)
+		{
+			needles[i] = Broadcast(setBegin[i]);
+		}
+
+		for (; end - read >= Width; read += Width)
+		{
+			const auto input = Load(read);
+			auto found = _mm_setzero_si128();
+			for (size_t i = 0; i < setSize; ++i)
+			{
+				found = _mm_or_si128(found, CompareEqual(input, needles[i], T{}));
+			}
+
+			const auto mask = static_cast<nuInt>(_mm_movemask_epi8(found));
+			if (mask)
+			{
+				return read + CountTrailingZeros(mask) / sizeof(T);
+			}
+		}
+
+		return SearchAnyCharScalar(read, end, setBegin, setEnd);
+	}
+
+	// ο Mula. SIMD-friendly algorithms for substring searching
+	// ʵʾͬʱȽϸλõԪģʽԪءpatternLength - 1ԪģʽβԪɸѡѡλã֤
+	//          ֤ĿʱKMP㷨Ա֤µԸӶȣpatternLengthС2
+	template <typename T>
+	const T* SearchStringSse2(const T* begin, const T* end, const T* pattern, size_t patternLength) noexcept
+	{
+		constexpr std::ptrdiff_t Width = 16 / sizeof(T);
+		const auto first = Broadcast(pattern[0]);
+		const auto last = Broadcast(pattern[patternLength - 1]);
+		const auto lastOffset = static_cast<std::ptrdiff_t>(patternLength - 1);
+		size_t verified = 0;
+
+		auto read = begin;
+		for (; end - read >= Width + lastOffset; read += Width)
+		{
+			if (verified > SearchVerifyFactor * static_cast<size_t>(read - begin) + SearchVerifyThreshold)
+			{
+				return SearchStringKmp(read, end, pattern, patternLength);
+			}
 
-			while (read < readEnd)
+			auto mask = static_cast<nuInt>(_mm_movemask_epi8(_mm_and_si128(CompareEqual(Load(read), first, T{}), CompareEqual(Load(read + lastOffset), last, T{}))));
+			while (mask)
 			{
-				std::tie(result, u32CodePoint, read) = DecodeUtf32(read, readEnd);
-				if (result != EncodingResult::Accept)
+				const auto index = CountTrailingZeros(mask) / sizeof(T);
+				if (std::memcmp(read + index + 1, pattern + 1, (patternLength - 2) * sizeof(T)) == 0)
 				{
-					nat_Throw(natException, "DecodeUtf32 failed."_nv);
+					return read + index;
 				}
-				std::tie(result, write) = EncodeUtf32(write, writeEnd, u32CodePoint);
-				assert(result == EncodingResult::Accept && "EncodeUtf32 failed.");
+				mask = ClearElement<T>(mask, index);
+				verified += patternLength;
 			}
-			dst.Resize(static_cast<size_t>(write - dst.begin()));
 		}
-		catch (...)
+
+		return SearchStringScalar(read, end, pattern, patternLength);
+	}
+
+	template <typename T>
+	const T* SearchStringBackwardSse2(const T* begin, const T* end, const T* pattern, size_t patternLength) noexcept
+	{
+		constexpr std::ptrdiff_t Width = 16 / sizeof(T);
+		const auto first = Broadcast(pattern[0]);
+		const auto last = Broadcast(pattern[patternLength - 1]);
+		const auto lastOffset = static_cast<std::ptrdiff_t>(patternLength - 1);
+		size_t verified = 0;
+
+		// ʵʾreadΪδĺѡλõϽ磬[read, read + lastOffset)δΪƥĽβ
+		auto read = end - lastOffset;
+		for (; read - begin >= Width; read -= Width)
+		{
+			if (verified > SearchVerifyFactor * static_cast<size_t>(end - read) + SearchVerifyThreshold)
+			{
+				return SearchStringBackwardKmp(begin, read + lastOffset, pattern, patternLength);
+			}
+
+			const auto start = read - Width;
+			auto mask = static_cast<nuInt>(_mm_movemask_epi8(_mm_and_si128(CompareEqual(Load(start), first, T{}), CompareEqual(Load(start + lastOffset), last, T{}))));
+			while (mask)
+			{
+				const auto index = HighestSetBit(mask) / sizeof(T);
+				if (std::memcmp(start + index + 1, pattern + 1, (patternLength - 2) * sizeof(T)) == 0)
+				{
+					return start + index;
+				}
+				mask = ClearElement<T>(mask, index);
+				verified += patternLength;
+			}
+		}
+
+		return SearchStringBackwardScalar(begin, read + lastOffset, pattern, patternLength);
+	}
+
+	NATSTRING_TARGET_AVX2 __m256i Broadcast256(char value) noexcept
+	{
+		return _mm256_set1_epi8(value);
+	}
+
+	NATSTRING_TARGET_AVX2 __m256i Broadcast256(char16_t value) noexcept
+	{
+		return _mm256_set1_epi16(static_cast<short>(value));
+	}
+
+	NATSTRING_TARGET_AVX2 __m256i Broadcast256(char32_t value) noexcept
+	{
+		return _mm256_set1_epi32(static_cast<int>(value));
+	}
+
+	NATSTRING_TARGET_AVX2 __m256i CompareEqual(__m256i a, __m256i b, char) noexcept
+	{
+		return _mm256_cmpeq_epi8(a, b);
+	}
+
+	NATSTRING_TARGET_AVX2 __m256i CompareEqual(__m256i a, __m256i b, char16_t) noexcept
+	{
+		return _mm256_cmpeq_epi16(a, b);
+	}
+
+	NATSTRING_TARGET_AVX2 __m256i CompareEqual(__m256i a, __m256i b, char32_t) noexcept
+	{
+		return _mm256_cmpeq_epi32(a, b);
+	}
+
+	template <typename T>
+	NATSTRING_TARGET_AVX2 __m256i Load256(const T* read) noexcept
+	{
+		return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(read));
+	}
+
+	// ʵʾʣ಻32ֽʱ128λAVX2е÷VEXSSE2汾
+	template <typename T>
+	NATSTRING_TARGET_AVX2 const T* SearchCharAvx2(const T* read, const T* end, T findChar, nBool equal) noexcept
+	{
+		constexpr std::ptrdiff_t Width = 32 / sizeof(T);
+		const auto needle = Broadcast256(findChar);
+		const nuInt flip = equal ? 0 : 0xFFFFFFFF;
+
+		for (; end - read >= Width; read += Width)
+		{
+			const auto mask = static_cast<nuInt>(_mm256_movemask_epi8(CompareEqual(Load256(read), needle, T{}))) ^ flip;
+			if (mask)
+			{
+				return read + CountTrailingZeros(mask) / sizeof(T);
+			}
+		}
+
+		if (end - read >= Width / 2)
+		{
+			const auto mask = static_cast<nuInt>(_mm_movemask_epi8(CompareEqual(Load(read), _mm256_castsi256_si128(needle), T{}))) ^ (flip & 0xFFFF);
+			if (mask)
+			{
+				return read + CountTrailingZeros(mask) / sizeof(T);
+			}
+			read += Width / 2;
+		}
+
+		return SearchCharScalar(read, end, findChar, equal);
+	}
+
+	template <typename T>
+	NATSTRING_TARGET_AVX2 const T* SearchCharBackwardAvx2(const T* begin, const T* read, T findChar, nBool equal) noexcept
+	{
+		constexpr std::ptrdiff_t Width = 32 / sizeof(T);
+		const auto needle = Broadcast256(findChar);
+		const nuInt flip = equal ? 0 : 0xFFFFFFFF;
+
+		for (; read - begin >= Width; read -= Width)
+		{
+			const auto mask = static_cast<nuInt>(_mm256_movemask_epi8(CompareEqual(Load256(read - Width), needle, T{}))) ^ flip;
+			if (mask)
+			{
+				return read - Width + HighestSetBit(mask) / sizeof(T);
+			}
+		}
+
+		if (read - begin >= Width / 2)
+		{
+			read -= Width / 2;
+			const auto mask = static_cast<nuInt>(_mm_movemask_epi8(CompareEqual(Load(read), _mm256_castsi256_si128(needle), T{}))) ^ (flip & 0xFFFF);
+			if (mask)
+			{
+				return read + HighestSetBit(mask) / sizeof(T);
+			}
+		}
+
+		return SearchCharBackwardScalar(begin, read, findChar, equal);
+	}
+
+	template <typename T>
+	NATSTRING_TARGET_AVX2 const T* SearchStringAvx2(const T* begin, const T* end, const T* pattern, size_t patternLength) noexcept
+	{
+		constexpr std::ptrdiff_t Width = 32 / sizeof(T);
+		const auto first = Broadcast256(pattern[0]);
+		const auto last = Broadcast256(pattern[patternLength - 1]);
+		const auto lastOffset = static_cast<std::ptrdiff_t>(patternLength - 1);
+		size_t verified = 0;
+
+		auto read = begin;
+		for (; end - read >= Width + lastOffset; read += Width)
+		{
+			if (verified > SearchVerifyFactor * static_cast<size_t>(read - begin) + SearchVerifyThreshold)
+			{
+				return SearchStringKmp(read, end, pattern, patternLength);
+			}
+
+			auto mask = static_cast<nuInt>(_mm256_movemask_epi8(_mm256_and_si256(CompareEqual(Load256(read), first, T{}), CompareEqual(Load256(read + lastOffset), last, T{}))));
+			while (mask)
+			{
+				const auto index = CountTrailingZeros(mask) / sizeof(T);
+				if (std::memcmp(read + index + 1, pattern + 1, (patternLength - 2) * sizeof(T)) == 0)
+				{
+					return read + index;
+				}
+				mask = ClearElement<T>(mask, index);
+				verified += patternLength;
+			}
+		}
+
+		return SearchStringScalar(read, end, pattern, patternLength);
+	}
+#endif
+
+	template <typename T>
+	const T* SearchChar(const T* read, const T* end, T findChar, nBool equal) noexcept
+	{
+#ifdef NATSTRING_X64
+		if (g_SimdLevel == SimdLevel::Avx2)
+		{
+			return SearchCharAvx2(read, end, findChar, equal);
+		}
+		return SearchCharSse2(read, end, findChar, equal);
+#else
+		return SearchCharScalar(read, end, findChar, equal);
+#endif
+	}
+
+	template <typename T>
+	const T* SearchCharBackward(const T* begin, const T* end, T findChar, nBool equal) noexcept
+	{
+#ifdef NATSTRING_X64
+		if (g_SimdLevel == SimdLevel::Avx2)
+		{
+			return SearchCharBackwardAvx2(begin, end, findChar, equal);
+		}
+		return SearchCharBackwardSse2(begin, end, findChar, equal);
+#else
+		return SearchCharBackwardScalar(begin, end, findChar, equal);
+#endif
+	}
+}
+
+namespace NatsuLib
+{
+	namespace detail_
+	{
+		template <typename CharType>
+		size_t FindChar(const CharType* begin, const CharType* end, CharType findChar) noexcept
+		{
+			const auto result = SearchChar(begin, end, findChar, true);
+			return result == end ? npos : static_cast<size_t>(result - begin);
+		}
+
+		template <typename CharType>
+		size_t FindCharBackward(const CharType* begin, const CharType* end, CharType findChar) noexcept
+		{
+			const auto result = SearchCharBackward(begin, end, findChar, true);
+			return result ? static_cast<size_t>(result - begin) : npos;
+		}
+
+		// ҵfindCharֻrepeatCount - 1ԪأͬԪʱ
+		template <typename CharType>
+		size_t FindCharRepeat(const CharType* begin, const CharType* end, CharType findChar, size_t repeatCount) noexcept
+		{
+			assert(repeatCount != 0);
+
+			auto read = begin;
+			while (static_cast<size_t>(end - read) >= repeatCount)
+			{
+				const auto runBegin = SearchChar(read, end, findChar, true);
+				if (static_cast<size_t>(end - runBegin) < repeatCount)
+				{
+					break;
+				}
+
+				const auto runEnd = runBegin + repeatCount;
+				const auto mismatch = SearchChar(runBegin + 1, runEnd, findChar, false);
+				if (mismatch == runEnd)
+				{
+					return static_cast<size_t>(runBegin - begin);
+				}
+				read = mismatch + 1;
+			}
+
+			return npos;
+		}
+
+		template <typename CharType>
+		size_t FindCharRepeatBackward(const CharType* begin, const CharType* end, CharType findChar, size_t repeatCount) noexcept
+		{
+			assert(repeatCount != 0);
+
+			while (static_cast<size_t>(end - begin) >= repeatCount)
+			{
+				const auto runLast = SearchCharBackward(begin, end, findChar, true);
+				if (!runLast || static_cast<size_t>(runLast - begin) + 1 < repeatCount)
+				{
+					break;
+				}
+
+				const auto runBegin = runLast + 1 - repeatCount;
+				const auto mismatch = SearchCharBackward(runBegin, runLast, findChar, false);
+				if (!mismatch)
+				{
+					return static_cast<size_t>(runBegin - begin);
+				}
+				end = mismatch;
+			}
+
+			return npos;
+		}
+
+		template <typename CharType>
+		size_t FindAnyChar(const CharType* begin, const CharType* end, const CharType* setBegin, const CharType* setEnd) noexcept
+		{
+			if (setBegin == setEnd)
+			{
+				return npos;
+			}
+			if (setEnd - setBegin == 1)
+			{
+				return FindChar(begin, end, *setBegin);
+			}
+
+#ifdef NATSTRING_X64
+			const auto result = SearchAnyCharSse2(begin, end, setBegin, setEnd);
+#else
+			const auto result = SearchAnyCharScalar(begin, end, setBegin, setEnd);
+#endif
+			return result == end ? npos : static_cast<size_t>(result - begin);
+		}
+
+		template <typename CharType>
+		size_t FindString(const CharType* begin, const CharType* end, const CharType* patternBegin, const CharType* patternEnd) noexcept
+		{
+			const auto patternLength = static_cast<size_t>(patternEnd - patternBegin);
+			if (patternLength == 0)
+			{
+				return 0;
+			}
+			if (static_cast<size_t>(end - begin) < patternLength)
+			{
+				return npos;
+			}
+			if (patternLength == 1)
+			{
+				return FindChar(begin, end, *patternBegin);
+			}
+
+#ifdef NATSTRING_X64
+			const auto result = g_SimdLevel == SimdLevel::Avx2 ? SearchStringAvx2(begin, end, patternBegin, patternLength) : SearchStringSse2(begin, end, patternBegin, patternLength);
+#else
+			const auto result = SearchStringKmp(begin, end, patternBegin, patternLength);
+#endif
+			return result ? static_cast<size_t>(result - begin) : npos;
+		}
+
+		template <typename CharType>
+		size_t FindStringBackward(const CharType* begin, const CharType* end, const CharType* patternBegin, const CharType* patternEnd) noexcept
+		{
+			const auto patternLength = static_cast<size_t>(patternEnd - patternBegin);
+			const auto length = static_cast<size_t>(end - begin);
+			if (patternLength == 0)
+			{
+				return length;
+			}
+			if (length < patternLength)
+			{
+				return npos;
+			}
+			if (patternLength == 1)
+			{
+				return FindCharBackward(begin, end, *patternBegin);
+			}
+
+#ifdef NATSTRING_X64
+			const auto result = SearchStringBackwardSse2(begin, end, patternBegin, patternLength);
+#else
+			const auto result = SearchStringBackwardKmp(begin, end, patternBegin, patternLength);
+#endif
+			return result ? static_cast<size_t>(result - begin) : npos;
+		}
+
+#define NATSTRING_INSTANTIATE_SEARCH(CharType) \
+		template size_t FindChar(const CharType*, const CharType*, CharType) noexcept;\
+		template size_t FindCharBackward(const CharType*, const CharType*, CharType) noexcept;\
+		template size_t FindCharRepeat(const CharType*, const CharType*, CharType, size_t) noexcept;\
+		template size_t FindCharRepeatBackward(const CharType*, const CharType*, CharType, size_t) noexcept;\
+		template size_t FindAnyChar(const CharType*, const CharType*, const CharType*, const CharType*) noexcept;\
+		template size_t FindString(const CharType*, const CharType*, const CharType*, const CharType*) noexcept;\
+		template size_t FindStringBackward(const CharType*, const CharType*, const CharType*, const CharType*) noexcept
+
+		NATSTRING_INSTANTIATE_SEARCH(char);
+		NATSTRING_INSTANTIATE_SEARCH(char16_t);
+		NATSTRING_INSTANTIATE_SEARCH(char32_t);
+
+#undef NATSTRING_INSTANTIATE_SEARCH
+	}
+}
+
+namespace NatsuLib
+{
+	namespace detail_
+	{
+		EncodingResult EncodingCodePoint<StringType::Utf8>::Encode(String<StringType::Utf8>& output, nuInt codePoint)
+		{
+			StringEncodingTrait<StringType::Utf8>::CharType buffer[StringEncodingTrait<StringType::Utf8>::MaxCharSize]{};
+			EncodingResult result;
+			const char* end;
+			std::tie(result, end) = EncodeUtf8(std::begin(buffer), std::end(buffer), static_cast<char32_t>(codePoint));
+			if (result == EncodingResult::Accept)
+			{
+				output.Append(StringView<StringType::Utf8>{ std::cbegin(buffer), end });
+			}
+			return result;
+		}
+
+		std::pair<EncodingResult, size_t> EncodingCodePoint<StringType::Utf8>::Decode(StringView<StringType::Utf8> const& input, nuInt& codePoint)
+		{
+			EncodingResult result;
+			char32_t tmpCodePoint;
+			const char* end;
+			std::tie(result, tmpCodePoint, end) = DecodeUtf8(std::cbegin(input), std::cend(input));
+			if (result == EncodingResult::Accept)
+			{
+				codePoint = static_cast<nuInt>(tmpCodePoint);
+			}
+
+			return { result, std::distance(std::cbegin(input), end) };
+		}
+
+		EncodingResult EncodingCodePoint<StringType::Utf16>::Encode(String<StringType::Utf16>& output, nuInt codePoint)
+		{
+			StringEncodingTrait<StringType::Utf16>::CharType buffer[StringEncodingTrait<StringType::Utf16>::MaxCharSize]{};
+			EncodingResult result;
+			const char16_t* end;
+			std::tie(result, end) = EncodeUtf16(std::begin(buffer), std::end(buffer), static_cast<char32_t>(codePoint));
+			if (result == EncodingResult::Accept)
+			{
+				output.Append(StringView<StringType::Utf16>{ std::cbegin(buffer), end });
+			}
+			return result;
+		}
+
+		std::pair<EncodingResult, size_t> EncodingCodePoint<StringType::Utf16>::Decode(StringView<StringType::Utf16> const& input, nuInt& codePoint)
+		{
+			EncodingResult result;
+			char32_t tmpCodePoint;
+			const char16_t* end;
+			std::tie(result, tmpCodePoint, end) = DecodeUtf16(std::cbegin(input), std::cend(input));
+			if (result == EncodingResult::Accept)
+			{
+				codePoint = static_cast<nuInt>(tmpCodePoint);
+			}
+
+			return{ result, std::distance(std::cbegin(input), end) };
+		}
+
+		EncodingResult EncodingCodePoint<StringType::Utf32>::Encode(String<StringType::Utf32>& output, nuInt codePoint)
+		{
+			StringEncodingTrait<StringType::Utf32>::CharType buffer[StringEncodingTrait<StringType::Utf32>::MaxCharSize]{};
+			EncodingResult result;
+			const char32_t* end;
+			std::tie(result, end) = EncodeUtf32(std::begin(buffer), std::end(buffer), static_cast<char32_t>(codePoint));
+			if (result == EncodingResult::Accept)
+			{
+				output.Append(StringView<StringType::Utf32>{ std::cbegin(buffer), end });
+			}
+			return result;
+		}
+
+		std::pair<EncodingResult, size_t> EncodingCodePoint<StringType::Utf32>::Decode(StringView<StringType::Utf32> const& input, nuInt& codePoint)
+		{
+			EncodingResult result;
+			char32_t tmpCodePoint;
+			const char32_t* end;
+			std::tie(result, tmpCodePoint, end) = DecodeUtf32(std::cbegin(input), std::cend(input));
+			if (result == EncodingResult::Accept)
+			{
+				codePoint = static_cast<nuInt>(tmpCodePoint);
+			}
+
+			return{ result, std::distance(std::cbegin(input), end) };
+		}
+
+#ifdef _WIN32
+		EncodingResult EncodingCodePoint<StringType::Ansi>::Encode(String<StringType::Ansi>& output, nuInt codePoint)
+		{
+			try
+			{
+				output.ResizeMore(4);
+				output.Append(StringView<StringType::Utf32>{ codePoint });
+			}
+			catch (...)
+			{
+				output.pop_back(4);
+				return EncodingResult::Reject;	// 쳣
+			}
+
+			return EncodingResult::Accept;
+		}
+
+		std::pair<EncodingResult, size_t> EncodingCodePoint<StringType::Ansi>::Decode(StringView<StringType::Ansi> const& input, nuInt& codePoint)
+		{
+			codePoint = static_cast<nuInt>(*input.begin());	// ޷AnsiַһЧַռõֽ
+			return { EncodingResult::Accept, 1 };
+		}
+
+		EncodingResult EncodingCodePoint<StringType::Wide>::Encode(String<StringType::Wide>& output, nuInt codePoint)
+		{
+			//  Windows ƽ̨µĿַַΪUTF-16
+			return EncodingCodePoint<StringType::Utf16>::Encode(reinterpret_cast<String<StringType::Utf16>&>(output), codePoint);
+		}
+
+		std::pair<EncodingResult, size_t> EncodingCodePoint<StringType::Wide>::Decode(StringView<StringType::Wide> const& input, nuInt& codePoint)
+		{
+			return EncodingCodePoint<StringType::Utf16>::Decode(reinterpret_cast<StringView<StringType::Utf16> const&>(input), codePoint);
+		}
+
+#endif
+	}
+
+	template <>
+	void U8String::TransAppendTo(U16String& dst, View const& src)
+	{
+		if (!TransAppendBulk(dst, src, 1))
+		{
+			nat_Throw(natException, "DecodeUtf8 failed."_nv);
+		}
+	}
+
+	template <>
+	void U8String::TransAppendFrom(U8String& dst, U16StringView const& src)
+	{
+		if (!TransAppendBulk(dst, src, 3))
+		{
+			nat_Throw(natException, "DecodeUtf16 failed."_nv);
+		}
+	}
+
+	template <>
+	void U8String::TransAppendTo(U32String& dst, View const& src)
+	{
+		if (!TransAppendBulk(dst, src, 1))
+		{
+			nat_Throw(natException, "DecodeUtf8 failed."_nv);
+		}
+	}
+
+	template <>
+	void U8String::TransAppendFrom(U8String& dst, U32StringView const& src)
+	{
+		if (!TransAppendBulk(dst, src, 4))
+		{
+			nat_Throw(natException, "DecodeUtf32 failed."_nv);
+		}
+	}
+
+	template <>
+	void U16String::TransAppendTo(U16String& dst, View const& src)
+	{
+		if (!ValidateUtf16(src.cbegin(), src.cend()))
+		{
+			nat_Throw(natException, "DecodeUtf16 failed."_nv);
+		}
+		dst.Append(src);
+	}
+
+	template <>
+	void U16String::TransAppendFrom(U16String& dst, U16StringView const& src)
+	{
+		if (!ValidateUtf16(src.cbegin(), src.cend()))
+		{
+			nat_Throw(natException, "DecodeUtf16 failed."_nv);
+		}
+		dst.Append(src);
+	}
+
+	template <>
+	void U16String::TransAppendTo(U32String& dst, View const& src)
+	{
+		if (!TransAppendBulk(dst, src, 1))
+		{
+			nat_Throw(natException, "DecodeUtf16 failed."_nv);
+		}
+	}
+
+	template <>
+	void U16String::TransAppendFrom(U16String& dst, U32StringView const& src)
+	{
+		if (!TransAppendBulk(dst, src, 2))
+		{
+			nat_Throw(natException, "DecodeUtf32 failed."_nv);
+		}
+	}
+
+	template <>
+	void U32String::TransAppendTo(U16String& dst, View const& src)
+	{
+		if (!TransAppendBulk(dst, src, 2))
+		{
+			nat_Throw(natException, "DecodeUtf32 failed."_nv);
+		}
+	}
+
+	template <>
+	void U32String::TransAppendFrom(U32String& dst, U16StringView const& src)
+	{
+		if (!TransAppendBulk(dst, src, 1))
+		{
+			nat_Throw(natException, "DecodeUtf16 failed."_nv);
+		}
+	}
+
+	template <>
+	void U32String::TransAppendTo(U32String& dst, View const& src)
+	{
+		if (!ValidateUtf32(src.cbegin(), src.cend()))
+		{
+			nat_Throw(natException, "DecodeUtf32 failed."_nv);
+		}
+		dst.Append(src);
+	}
+
+	template <>
+	void U32String::TransAppendFrom(U32String& dst, U32StringView const& src)
+	{
+		if (!ValidateUtf32(src.cbegin(), src.cend()))
 		{
-			dst.Resize(static_cast<size_t>(dstBegin - dst.begin()));
-			throw;
+			nat_Throw(natException, "DecodeUtf32 failed."_nv);
 		}
+		dst.Append(src);
 	}
 
 #ifdef _WIN32
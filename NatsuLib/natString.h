@@ -151,51 +151,35 @@ namespace NatsuLib
 			return end;
 		}
 
-		template <typename Iter, typename CharType>
-		size_t SearchCharRepeat(Iter srcBegin, Iter srcEnd, CharType searchChar, size_t repeatCount) noexcept
-		{
-			assert(repeatCount != 0);
-			assert(static_cast<size_t>(srcEnd - srcBegin) > repeatCount);
-
-			auto current = srcBegin;
-
-			while (true)
-			{
-				while (true)
-				{
-					if (srcEnd - current < static_cast<std::ptrdiff_t>(repeatCount))
-					{
-						return npos;
-					}
-					if (*current == searchChar)
-					{
-						break;
-					}
-					++current;
-				}
-
-				std::ptrdiff_t matchLen = 1;
-				while (true)
-				{
-					if (static_cast<size_t>(matchLen) >= repeatCount)
-					{
-						return static_cast<size_t>(std::distance(srcBegin, current));
-					}
-					if (current[matchLen] != searchChar)
-					{
-						break;
-					}
-					++matchLen;
-				}
-
-				current += matchLen;
-				++current;
-			}
-		}
-
 		template <typename Iter1, typename Iter2>
 		size_t MatchString(Iter1 srcBegin, Iter1 srcEnd, Iter2 patternBegin, Iter2 patternEnd) noexcept;
 
+		///	@brief	ʹõı뵥Ԫ
+		///	@note	뵥ԪĴСѡAnsiWideַͬСı뵥Ԫʵ
+		template <typename CharType>
+		using SearchUnitType = std::conditional_t<sizeof(CharType) == 1, char, std::conditional_t<sizeof(CharType) == 2, char16_t, char32_t>>;
+
+		///	@brief	ĲҺ
+		///	@note	CPUֵָ֧ѡʵ֣CharTypeֻΪcharchar16_tchar32_t
+		///			beginλãδҵʱnposBackward汾[begin, end)һγֵλ
+		///	@{
+		template <typename CharType>
+		size_t FindChar(const CharType* begin, const CharType* end, CharType findChar) noexcept;
+		template <typename CharType>
+		size_t FindCharBackward(const CharType* begin, const CharType* end, CharType findChar) noexcept;
+		template <typename CharType>
+		size_t FindCharRepeat(const CharType* begin, const CharType* end, CharType findChar, size_t repeatCount) noexcept;
+		template <typename CharType>
+		size_t FindCharRepeatBackward(const CharType* begin, const CharType* end, CharType findChar, size_t repeatCount) noexcept;
+		///	@brief	[setBegin, setEnd)ַ״γֵλ
+		template <typename CharType>
+		size_t FindAnyChar(const CharType* begin, const CharType* end, const CharType* setBegin, const CharType* setEnd) noexcept;
+		template <typename CharType>
+		size_t FindString(const CharType* begin, const CharType* end, const CharType* patternBegin, const CharType* patternEnd) noexcept;
+		template <typename CharType>
+		size_t FindStringBackward(const CharType* begin, const CharType* end, const CharType* patternBegin, const CharType* patternEnd) noexcept;
+		///	@}
+
 		template <StringType stringType>
 		std::enable_if_t<StringEncodingTrait<stringType>::MaxCharSize == 1, size_t> GetCharCount(const typename StringEncodingTrait<stringType>::CharType* /*str*/, size_t length)
 		{
@@ -238,6 +222,15 @@ namespace NatsuLib
 	std::pair<EncodingResult, char16_t*> EncodeUtf16(char16_t* strBegin, const char16_t* strEnd, char32_t input) noexcept;
 	std::pair<EncodingResult, char32_t*> EncodeUtf32(char32_t* strBegin, const char32_t* strEnd, char32_t input) noexcept;
 
+	///	@brief	ַǷΪЧı
+	///	@note	ΪЧCPUֵָ֧ʱѡSSE4.1AVX2ʵ
+	nBool ValidateUtf8(const char* strBegin, const char* strEnd) noexcept;
+	nBool ValidateUtf16(const char16_t* strBegin, const char16_t* strEnd) noexcept;
+	nBool ValidateUtf32(const char32_t* strBegin, const char32_t* strEnd) noexcept;
+
+	template <StringType stringType>
+	class StringSplitRange;
+
 	////////////////////////////////////////////////////////////////////////////////
 	///	@brief	ַͼ
 	///	@tparam	stringType	ַı
@@ -485,19 +478,16 @@ namespace NatsuLib
 			size_t pos{};
 			const auto strLen = size();
 
-			for (size_t i = 0; i < strLen; ++i)
+			while (true)
 			{
-				const auto currentchar = m_StrBegin[i];
-				for (auto&& item : pattern)
+				const auto found = detail_::FindAnyChar(AsSearchUnits(m_StrBegin + pos), AsSearchUnits(m_StrEnd), AsSearchUnits(pattern.cbegin()), AsSearchUnits(pattern.cend()));
+				if (found == npos)
 				{
-					if (currentchar == item)
-					{
-						callableObject(StringView{ m_StrBegin + pos, i - pos });
-
-						pos = i + 1;
-						break;
-					}
+					break;
 				}
+
+				callableObject(StringView{ m_StrBegin + pos, found });
+				pos += found + 1;
 			}
 
 			if (pos != strLen)
@@ -506,6 +496,24 @@ namespace NatsuLib
 			}
 		}
 
+		///	@brief	Եַָ
+		///	@param[in]	delimiter	ָΪһָΪʱзָ
+		///	@param[in]	skipEmpty	ǷյƬ
+		///	@note	SplitͬƬʱβĿƬΣַһƬ
+		///			صķΧñַdelimiterڴ
+		StringSplitRange<stringType> LazySplit(StringView const& delimiter, nBool skipEmpty = false) const noexcept
+		{
+			return { *this, delimiter, skipEmpty };
+		}
+
+		///	@brief	Եַָ
+		///	@param[in]	delimiter	ַָ
+		///	@param[in]	skipEmpty	ǷյƬ
+		StringSplitRange<stringType> LazySplit(CharType delimiter, nBool skipEmpty = false) const noexcept
+		{
+			return { *this, delimiter, skipEmpty };
+		}
+
 		void Assign(CharIterator begin, CharIterator end) noexcept
 		{
 			m_StrBegin = begin;
@@ -546,7 +554,7 @@ namespace NatsuLib
 			{
 				return npos;
 			}
-			const auto pos = detail_::MatchString(cbegin() + realBegin, cend(), pattern.cbegin(), pattern.cend());
+			const auto pos = detail_::FindString(AsSearchUnits(cbegin() + realBegin), AsSearchUnits(cend()), AsSearchUnits(pattern.cbegin()), AsSearchUnits(pattern.cend()));
 			if (pos == npos)
 			{
 				return npos;
@@ -563,16 +571,11 @@ namespace NatsuLib
 			{
 				return realEnd;
 			}
-			if (length < patternLength || realEnd < length)
+			if (realEnd < patternLength)
 			{
 				return npos;
 			}
-			const auto pos = detail_::MatchString(const_reverse_iterator{ cbegin() + realEnd }, crend(), pattern.cbegin(), pattern.cend());
-			if (pos == npos)
-			{
-				return npos;
-			}
-			return realEnd - pos - patternLength;
+			return detail_::FindStringBackward(AsSearchUnits(cbegin()), AsSearchUnits(cbegin() + realEnd), AsSearchUnits(pattern.cbegin()), AsSearchUnits(pattern.cend()));
 		}
 
 		size_t FindCharRepeat(CharType findChar, size_t repeatCount, std::ptrdiff_t nBegin = 0) const noexcept
@@ -587,7 +590,7 @@ namespace NatsuLib
 			{
 				return npos;
 			}
-			const auto pos = detail_::SearchCharRepeat(cbegin() + realBegin, cend(), findChar, repeatCount);
+			const auto pos = detail_::FindCharRepeat(AsSearchUnits(cbegin() + realBegin), AsSearchUnits(cend()), static_cast<SearchUnit>(findChar), repeatCount);
 			if (pos == npos)
 			{
 				return npos;
@@ -607,12 +610,7 @@ namespace NatsuLib
 			{
 				return npos;
 			}
-			const auto pos = detail_::SearchCharRepeat(const_reverse_iterator{ cbegin() + realEnd }, crend(), findChar, repeatCount);
-			if (pos == npos)
-			{
-				return npos;
-			}
-			return realEnd - pos - repeatCount;
+			return detail_::FindCharRepeatBackward(AsSearchUnits(cbegin()), AsSearchUnits(cbegin() + realEnd), static_cast<SearchUnit>(findChar), repeatCount);
 		}
 
 		size_t Find(CharType findChar, std::ptrdiff_t nBegin = 0) const noexcept
@@ -632,9 +630,16 @@ namespace NatsuLib
 		}
 
 	private:
+		typedef detail_::SearchUnitType<CharType> SearchUnit;
+
 		CharIterator m_StrBegin;
 		CharIterator m_StrEnd;
 
+		static const SearchUnit* AsSearchUnits(CharIterator iter) noexcept
+		{
+			return reinterpret_cast<const SearchUnit*>(iter);
+		}
+
 		static size_t ApplyOffset(std::ptrdiff_t offset, size_t size) noexcept
 		{
 			auto ret = static_cast<size_t>(offset);
@@ -648,6 +653,149 @@ namespace NatsuLib
 		}
 	};
 
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	ַĶԷָΧ
+	///	@tparam	stringType	ַı
+	///	@note	ʱŲһָȫ״̬˿ڷΧٺʹ
+	///			range-forҲͨfromfrom_valuesLinq
+	////////////////////////////////////////////////////////////////////////////////
+	template <StringType stringType>
+	class StringSplitRange final
+	{
+	public:
+		typedef StringView<stringType> View;
+		typedef typename View::CharType CharType;
+		typedef typename View::CharIterator CharIterator;
+
+		class iterator final
+		{
+			typedef iterator Self_t;
+
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef View value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef View const& reference;
+			typedef const View* pointer;
+
+			///	@brief	
+			constexpr iterator() noexcept
+				: m_Next{}, m_End{}, m_DelimiterChar{}, m_SingleChar{}, m_SkipEmpty{}, m_HasRest{}, m_AtEnd{ true }
+			{
+			}
+
+			iterator(View const& str, View const& delimiter, CharType delimiterChar, nBool singleChar, nBool skipEmpty) noexcept
+				: m_Next{ str.cbegin() }, m_End{ str.cend() }, m_Delimiter{ delimiter }, m_DelimiterChar{ delimiterChar }, m_SingleChar{ singleChar }, m_SkipEmpty{ skipEmpty }, m_HasRest{ true }, m_AtEnd{}
+			{
+				MoveNext();
+			}
+
+			Self_t& operator++() & noexcept
+			{
+				assert(!m_AtEnd && "Cannot increment the end iterator.");
+				MoveNext();
+
+				return *this;
+			}
+
+			reference operator*() const noexcept
+			{
+				assert(!m_AtEnd && "Cannot dereference the end iterator.");
+				return m_Piece;
+			}
+
+			pointer operator->() const noexcept
+			{
+				return &**this;
+			}
+
+			nBool operator==(Self_t const& other) const noexcept
+			{
+				if (m_AtEnd || other.m_AtEnd)
+				{
+					return m_AtEnd == other.m_AtEnd;
+				}
+
+				return m_Piece.cbegin() == other.m_Piece.cbegin() && m_Piece.cend() == other.m_Piece.cend();
+			}
+
+			nBool operator!=(Self_t const& other) const noexcept
+			{
+				return !(*this == other);
+			}
+
+		private:
+			View m_Piece;
+			CharIterator m_Next, m_End;
+			View m_Delimiter;
+			CharType m_DelimiterChar;
+			nBool m_SingleChar, m_SkipEmpty, m_HasRest, m_AtEnd;
+
+			void MoveNext() noexcept
+			{
+				do
+				{
+					if (!m_HasRest)
+					{
+						m_AtEnd = true;
+						return;
+					}
+
+					const View rest{ m_Next, m_End };
+					const auto delimiterLength = m_SingleChar ? size_t{ 1 } : m_Delimiter.size();
+					size_t pos = View::npos;
+					if (m_SingleChar)
+					{
+						pos = rest.Find(m_DelimiterChar);
+					}
+					else if (delimiterLength != 0)
+					{
+						pos = rest.Find(m_Delimiter);
+					}
+
+					if (pos == View::npos)
+					{
+						m_Piece = rest;
+						m_HasRest = false;
+					}
+					else
+					{
+						m_Piece = View{ m_Next, pos };
+						m_Next += pos + delimiterLength;
+					}
+				} while (m_SkipEmpty && m_Piece.empty());
+			}
+		};
+
+		typedef iterator const_iterator;
+
+		StringSplitRange(View const& str, View const& delimiter, nBool skipEmpty) noexcept
+			: m_Str{ str }, m_Delimiter{ delimiter }, m_DelimiterChar{}, m_SingleChar{ false }, m_SkipEmpty{ skipEmpty }
+		{
+		}
+
+		StringSplitRange(View const& str, CharType delimiter, nBool skipEmpty) noexcept
+			: m_Str{ str }, m_DelimiterChar{ delimiter }, m_SingleChar{ true }, m_SkipEmpty{ skipEmpty }
+		{
+		}
+
+		iterator begin() const noexcept
+		{
+			return { m_Str, m_Delimiter, m_DelimiterChar, m_SingleChar, m_SkipEmpty };
+		}
+
+		iterator end() const noexcept
+		{
+			return {};
+		}
+
+	private:
+		View m_Str;
+		View m_Delimiter;
+		CharType m_DelimiterChar;
+		nBool m_SingleChar, m_SkipEmpty;
+	};
+
 	extern template class StringView<StringType::Utf8>;
 	extern template class StringView<StringType::Utf16>;
 	extern template class StringView<StringType::Utf32>;
@@ -1711,6 +1859,10 @@ namespace NatsuLib
 				if (fallback != 0)
 				{
 					current -= fallback;
+					if (std::distance(current, srcEnd) < static_cast<std::ptrdiff_t>(patternSize))
+					{
+						return npos;
+					}
 					matchLen = fallback;
 					goto Fallback;
 				}
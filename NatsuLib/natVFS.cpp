@@ -2,11 +2,134 @@
 #include "natVFS.h"
 #include "natException.h"
 #include "natLocalFileScheme.h"
+#include "natZipArchiveScheme.h"
+#include "natMemoryScheme.h"
+#include <condition_variable>
+#include <mutex>
 
 using namespace NatsuLib;
 
 namespace
 {
+	struct WalkState
+	{
+		natRefPointer<IScheme> Scheme;
+		nString Root;
+		natThreadPool& ThreadPool;
+		std::function<nBool(nStrView, DirectoryEntry const&)>& Callback;
+		nBool WithStat;
+
+		std::mutex Mutex;
+		std::condition_variable Finished;
+		size_t PendingCount;
+		nLen EntryCount;
+		std::exception_ptr FirstException;
+	};
+
+	struct WalkJob
+	{
+		WalkState* State;
+		nString RelativePath;
+	};
+
+	void QueueWalkJob(WalkState& state, nString relativePath);
+
+	void RunWalkJob(WalkJob const& job)
+	{
+		auto& state = *job.State;
+		const auto makeUri = [&](nStrView relativePath)
+		{
+			if (relativePath.empty())
+			{
+				return Uri{ state.Root };
+			}
+			// ʵʾȥĩβ'/'mem:///ȥ󽫲Чuri
+			return Uri{ state.Root.empty() || state.Root[state.Root.size() - 1] == '/' ? state.Root + relativePath : natUtil::FormatString("{0}/{1}", state.Root, relativePath) };
+		};
+
+		try
+		{
+			const auto entries = state.Scheme->EnumerateDirectory(makeUri(job.RelativePath), state.WithStat);
+
+			{
+				std::lock_guard<std::mutex> lock{ state.Mutex };
+				state.EntryCount += entries.size();
+			}
+
+			for (const auto& entry : entries)
+			{
+				auto path = job.RelativePath.empty() ? entry.Name : natUtil::FormatString("{0}/{1}", job.RelativePath, entry.Name);
+				if (!state.Callback(path, entry))
+				{
+					continue;
+				}
+
+				auto type = entry.Stat.Type;
+				if (type == ResourceType::Unknown)
+				{
+					const auto stat = state.Scheme->Stat(makeUri(path));
+					type = stat ? stat->Type : ResourceType::Unknown;
+				}
+
+				if (type == ResourceType::Directory)
+				{
+					QueueWalkJob(state, std::move(path));
+				}
+			}
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock{ state.Mutex };
+			if (!state.FirstException)
+			{
+				state.FirstException = std::current_exception();
+			}
+		}
+
+		std::lock_guard<std::mutex> lock{ state.Mutex };
+		if (!--state.PendingCount)
+		{
+			state.Finished.notify_all();
+		}
+	}
+
+	void QueueWalkJob(WalkState& state, nString relativePath)
+	{
+		{
+			std::lock_guard<std::mutex> lock{ state.Mutex };
+			// ʵʾѾʧʱύµĹȴύĹ
+			if (state.FirstException)
+			{
+				return;
+			}
+			++state.PendingCount;
+		}
+
+		auto job = std::make_unique<WalkJob>(WalkJob{ &state, std::move(relativePath) });
+		try
+		{
+			state.ThreadPool.QueueWork([](void* param) -> nuInt
+			{
+				const std::unique_ptr<WalkJob> job{ static_cast<WalkJob*>(param) };
+				RunWalkJob(*job);
+				return 0;
+			}, job.get());
+			job.release();
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock{ state.Mutex };
+			if (!state.FirstException)
+			{
+				state.FirstException = std::current_exception();
+			}
+			if (!--state.PendingCount)
+			{
+				state.Finished.notify_all();
+			}
+		}
+	}
+
 	// ˭˭
 	// beginendָͬڴһֽ
 	template <typename CharType, typename T>
@@ -34,86 +157,130 @@ namespace
 	}
 }
 
-const nStrView Uri::SchemeDelimiter{ "://" };
-
-Uri::Uri(nString uri)
-	: m_UriInfo{ std::move(uri) }
+UriView::UriView(nStrView uri)
+	: m_UriString{ uri }
 {
 	ParseUri();
 }
 
-Uri::Uri(Uri const& other)
-	: Uri(other.m_UriInfo.UriString)
+UriView::UriView(UriView const& other, nStrView uriString) noexcept
+	: UriView(other)
+{
+	assert(uriString.size() == other.m_UriString.size());
+
+	m_UriString = uriString;
+	const auto oldBase = other.m_UriString.data();
+	const auto newBase = uriString.data();
+	if (oldBase == newBase)
+	{
+		return;
+	}
+
+	for (const auto view : { &m_Scheme, &m_User, &m_Password, &m_Host, &m_Path, &m_Query, &m_Fragment })
+	{
+		if (view->data())
+		{
+			*view = nStrView{ newBase + (view->data() - oldBase), view->size() };
+		}
+	}
+}
+
+nStrView UriView::GetScheme() const noexcept
 {
+	return m_Scheme;
 }
 
-Uri::Uri(Uri&& other) noexcept
-	: Uri(std::move(other.m_UriInfo.UriString))
+nStrView UriView::GetUser() const noexcept
 {
+	return m_User;
 }
 
-Uri& Uri::operator=(Uri const& other)
+nStrView UriView::GetPassword() const noexcept
 {
-	m_UriInfo = { other.m_UriInfo.UriString };
-	ParseUri();
+	return m_Password;
+}
 
-	return *this;
+nStrView UriView::GetHost() const noexcept
+{
+	return m_Host;
 }
 
-Uri& Uri::operator=(Uri&& other) noexcept
+Optional<nuShort> UriView::GetPort() const noexcept
 {
-	m_UriInfo = { std::move(other.m_UriInfo.UriString) };
-	ParseUri();
+	return m_Port;
+}
 
-	return *this;
+nStrView UriView::GetPath() const noexcept
+{
+	return m_Path;
+}
+
+nStrView UriView::GetQuery() const noexcept
+{
+	return m_Query;
+}
+
+nStrView UriView::GetFragment() const noexcept
+{
+	return m_Fragment;
+}
+
+nStrView UriView::GetUnderlyingString() const noexcept
+{
+	return m_UriString;
 }
 
 nStrView Uri::GetScheme() const noexcept
 {
-	return m_UriInfo.Scheme;
+	return m_View.m_Scheme;
 }
 
 nStrView Uri::GetUser() const noexcept
 {
-	return m_UriInfo.User;
+	return m_View.m_User;
 }
 
 nStrView Uri::GetPassword() const noexcept
 {
-	return m_UriInfo.Password;
+	return m_View.m_Password;
 }
 
 nStrView Uri::GetHost() const noexcept
 {
-	return m_UriInfo.Host;
+	return m_View.m_Host;
 }
 
 Optional<nuShort> Uri::GetPort() const noexcept
 {
-	return m_UriInfo.Port;
+	return m_View.m_Port;
 }
 
 nStrView Uri::GetPath() const noexcept
 {
-	return m_UriInfo.Path;
+	return m_View.m_Path;
 }
 
 nStrView Uri::GetQuery() const noexcept
 {
-	return m_UriInfo.Query;
+	return m_View.m_Query;
 }
 
 nStrView Uri::GetFragment() const noexcept
 {
-	return m_UriInfo.Fragment;
+	return m_View.m_Fragment;
 }
 
 nStrView Uri::GetUnderlyingString() const noexcept
 {
-	return m_UriInfo.UriString;
+	return m_UriString;
+}
+
+UriView const& Uri::GetView() const noexcept
+{
+	return m_View;
 }
 
-void Uri::ParseUri()
+void UriView::ParseUri()
 {
 	enum class State
 	{
@@ -132,9 +299,9 @@ void Uri::ParseUri()
 
 	// pRead, pLastBeginpEndRandomAccessIteratorҶָͬһڴǡһֽڴ
 
-	auto pRead = m_UriInfo.UriString.cbegin();
+	auto pRead = m_UriString.cbegin();
 	auto pLastBegin = pRead;
-	const auto pEnd = m_UriInfo.UriString.cend();
+	const auto pEnd = m_UriString.cend();
 
 	nStrView user; // ʱ洢ûΪܲû
 	nuShort port;
@@ -148,7 +315,7 @@ void Uri::ParseUri()
 			{
 				if (pEnd - pRead >= 3 && *(pRead + 1) == '/' && *(pRead + 2) == '/')
 				{
-					m_UriInfo.Scheme = nStrView{ pLastBegin, pRead };
+					m_Scheme = nStrView{ pLastBegin, pRead };
 					pLastBegin = pRead + 3;
 					pRead += 2; // ѭٺһλ
 					state = State::User;
@@ -170,13 +337,13 @@ void Uri::ParseUri()
 				break;
 			case '@':
 				user = nStrView{ pLastBegin, pRead };
-				m_UriInfo.User = user;
+				m_User = user;
 				pLastBegin = pRead + 1;
 				state = State::Host;
 				break;
 			case '/':
 				// ȡHostUser
-				m_UriInfo.Host = nStrView{ pLastBegin, pRead };
+				m_Host = nStrView{ pLastBegin, pRead };
 				pLastBegin = pRead + 1;
 				state = State::Path;
 				break;
@@ -188,22 +355,22 @@ void Uri::ParseUri()
 			switch (*pRead)
 			{
 			case '@':
-				m_UriInfo.User = user;
-				m_UriInfo.Password = nStrView{ pLastBegin, pRead };
+				m_User = user;
+				m_Password = nStrView{ pLastBegin, pRead };
 				pLastBegin = pRead + 1;
 				state = State::Host;
 				break;
 			case '/':
 				// ȡPortPassword֮ǰȡHostUser
 				// **㱻ƭˣ**
-				m_UriInfo.Host = user;
+				m_Host = user;
 				if (!TryParseNumber(pLastBegin, pRead, port))
 				{
 					pRead = pEnd - 1;
 					state = State::Reject;
 					break;
 				}
-				m_UriInfo.Port = port;
+				m_Port = port;
 				pLastBegin = pRead + 1;
 				state = State::Path;
 				break;
@@ -215,12 +382,12 @@ void Uri::ParseUri()
 			switch (*pRead)
 			{
 			case ':':
-				m_UriInfo.Host = nStrView{ pLastBegin, pRead };
+				m_Host = nStrView{ pLastBegin, pRead };
 				pLastBegin = pRead + 1;
 				state = State::Port;
 				break;
 			case '/':
-				m_UriInfo.Host = nStrView{ pLastBegin, pRead };
+				m_Host = nStrView{ pLastBegin, pRead };
 				pLastBegin = pRead + 1;
 				state = State::Path;
 				break;
@@ -238,7 +405,7 @@ void Uri::ParseUri()
 					state = State::Reject;
 					break;
 				}
-				m_UriInfo.Port = port;
+				m_Port = port;
 				pLastBegin = pRead + 1;
 				state = State::Path;
 				break;
@@ -250,12 +417,12 @@ void Uri::ParseUri()
 			switch (*pRead)
 			{
 			case '?':
-				m_UriInfo.Path = nStrView{ pLastBegin, pRead };
+				m_Path = nStrView{ pLastBegin, pRead };
 				pLastBegin = pRead + 1;
 				state = State::Query;
 				break;
 			case '#':
-				m_UriInfo.Path = nStrView{ pLastBegin, pRead };
+				m_Path = nStrView{ pLastBegin, pRead };
 				pLastBegin = pRead + 1;
 				state = State::Fragment;
 				break;
@@ -267,7 +434,7 @@ void Uri::ParseUri()
 			switch (*pRead)
 			{
 			case '#':
-				m_UriInfo.Query = nStrView{ pLastBegin, pRead };
+				m_Query = nStrView{ pLastBegin, pRead };
 				pLastBegin = pRead + 1;
 				state = State::Fragment;
 				break;
@@ -291,43 +458,88 @@ void Uri::ParseUri()
 	switch (state)
 	{
 	case State::Scheme:
-		m_UriInfo.Scheme = nStrView{ pLastBegin, pRead };
+		m_Scheme = nStrView{ pLastBegin, pRead };
 		break;
 	case State::User:
-		m_UriInfo.User = nStrView{ pLastBegin, pRead };
+		m_User = nStrView{ pLastBegin, pRead };
 		break;
 	case State::Password:
-		m_UriInfo.Password = nStrView{ pLastBegin, pRead };
+		m_Password = nStrView{ pLastBegin, pRead };
 		break;
 	case State::Host:
-		m_UriInfo.Host = nStrView{ pLastBegin, pRead };
+		m_Host = nStrView{ pLastBegin, pRead };
 		break;
 	case State::Port:
 		if (!TryParseNumber(pLastBegin, pRead, port))
 		{
-			nat_Throw(natException, "{0} is not a valid uri."_nv, m_UriInfo.UriString);
+			nat_Throw(natException, "{0} is not a valid uri."_nv, m_UriString);
 		}
-		m_UriInfo.Port = port;
+		m_Port = port;
 		break;
 	case State::Path:
-		m_UriInfo.Path = nStrView{ pLastBegin, pRead };
+		m_Path = nStrView{ pLastBegin, pRead };
 		break;
 	case State::Query:
-		m_UriInfo.Query = nStrView{ pLastBegin, pRead };
+		m_Query = nStrView{ pLastBegin, pRead };
 		break;
 	case State::Fragment:
-		m_UriInfo.Fragment = nStrView{ pLastBegin, pRead };
+		m_Fragment = nStrView{ pLastBegin, pRead };
 		break;
 	case State::Accept:
 		return;
 	case State::Reject:
-		nat_Throw(natException, "{0} is not a valid uri."_nv, m_UriInfo.UriString);
+		nat_Throw(natException, "{0} is not a valid uri."_nv, m_UriString);
 	default:
 		assert(!"This should never happen.");
 		break;
 	}
 }
 
+const nStrView Uri::SchemeDelimiter{ "://" };
+
+Uri::Uri(nString uri)
+	: m_UriString{ std::move(uri) }, m_View{ m_UriString }
+{
+}
+
+Uri::Uri(UriView const& view)
+	: m_UriString{ view.GetUnderlyingString() }, m_View{ view, m_UriString }
+{
+}
+
+// ʵʾƼƶʱ½ضλµַ
+Uri::Uri(Uri const& other)
+	: m_UriString{ other.m_UriString }, m_View{ other.m_View, m_UriString }
+{
+}
+
+Uri::Uri(Uri&& other) noexcept
+	: m_UriString{ std::move(other.m_UriString) }, m_View{ other.m_View, m_UriString }
+{
+}
+
+Uri& Uri::operator=(Uri const& other)
+{
+	if (this != &other)
+	{
+		m_UriString = other.m_UriString;
+		m_View = UriView{ other.m_View, m_UriString };
+	}
+
+	return *this;
+}
+
+Uri& Uri::operator=(Uri&& other) noexcept
+{
+	if (this != &other)
+	{
+		m_UriString = std::move(other.m_UriString);
+		m_View = UriView{ other.m_View, m_UriString };
+	}
+
+	return *this;
+}
+
 IRequest::~IRequest()
 {
 }
@@ -348,9 +560,108 @@ IScheme::~IScheme()
 {
 }
 
+nBool IScheme::Exists(Uri const& uri)
+{
+	try
+	{
+		const auto request = CreateRequest(uri);
+		return request && request->GetResponse();
+	}
+	catch (natException&)
+	{
+		return false;
+	}
+}
+
+Optional<ResourceStat> IScheme::Stat(Uri const& uri)
+{
+	if (!Exists(uri))
+	{
+		return {};
+	}
+
+	return ResourceStat{ ResourceType::Unknown, 0, {} };
+}
+
+std::vector<DirectoryEntry> IScheme::EnumerateDirectory(Uri const& /*uri*/, nBool /*withStat*/)
+{
+	nat_Throw(natErrException, NatErr_NotSupport, "Scheme \"{0}\" does not support enumerating directories."_nv, GetSchemeName());
+}
+
+detail_::FlatDirectoryLister::FlatDirectoryLister(nStrView directory)
+	: m_Found{ false }
+{
+	directory = TrimTrailingSlash(directory);
+	if (!directory.empty())
+	{
+		m_Prefix = natUtil::FormatString("{0}/", directory);
+	}
+}
+
+void detail_::FlatDirectoryLister::Add(nStrView path, nLen size)
+{
+	const auto prefixSize = m_Prefix.size();
+	if (path.GetSize() <= prefixSize || nStrView{ path.begin(), path.begin() + prefixSize } != m_Prefix)
+	{
+		// ʵʾʽĿ¼ҲʾĿ¼
+		if (path == m_Prefix)
+		{
+			m_Found = true;
+		}
+		return;
+	}
+
+	m_Found = true;
+
+	const nStrView rest{ path.begin() + prefixSize, path.end() };
+	const auto slashPos = rest.Find('/');
+	if (slashPos == nStrView::npos)
+	{
+		m_Entries.push_back(DirectoryEntry{ rest, ResourceStat{ ResourceType::File, size, {} } });
+		return;
+	}
+
+	nString name{ nStrView{ rest.begin(), rest.begin() + slashPos } };
+	if (m_Directories.emplace(name).second)
+	{
+		m_Entries.push_back(DirectoryEntry{ std::move(name), ResourceStat{ ResourceType::Directory, 0, {} } });
+	}
+}
+
+nBool detail_::FlatDirectoryLister::IsFound() const noexcept
+{
+	return m_Found || m_Prefix.empty();
+}
+
+std::vector<DirectoryEntry> detail_::FlatDirectoryLister::GetEntries()
+{
+	return std::move(m_Entries);
+}
+
+nStrView detail_::TrimTrailingSlash(nStrView path) noexcept
+{
+	auto end = path.end();
+	while (end != path.begin() && *(end - 1) == '/')
+	{
+		--end;
+	}
+	return nStrView{ path.begin(), end };
+}
+
+nString detail_::GetFullPath(Uri const& uri)
+{
+	const auto host = uri.GetHost();
+	return host.empty() ? nString{ uri.GetPath() } : natUtil::FormatString("{0}/{1}", host, uri.GetPath());
+}
+
 natVFS::natVFS()
+	: m_SchemeMap{ nullptr }, m_LocalFileScheme{ make_ref<LocalFileScheme>() }, m_MaxCachedUris{}, m_CacheGeneration{}
 {
-	RegisterScheme(make_ref<LocalFileScheme>());
+	publishSchemeMap(std::make_unique<SchemeMap>());
+
+	RegisterScheme(m_LocalFileScheme);
+	RegisterScheme(make_ref<ZipArchiveScheme>());
+	RegisterScheme(make_ref<MemoryScheme>());
 }
 
 natVFS::~natVFS()
@@ -359,23 +670,47 @@ natVFS::~natVFS()
 
 void natVFS::RegisterScheme(natRefPointer<IScheme> scheme)
 {
-	nBool succeed;
-	tie(std::ignore, succeed) = m_SchemeMap.emplace(scheme->GetSchemeName(), std::move(scheme));
-	if (!succeed)
 	{
-		nat_Throw(natErrException, NatErr_Duplicated, "Register scheme failed: duplicated scheme name."_nv);
+		natRefScopeGuard<natCriticalSection> guard{ m_SchemeSection };
+
+		auto schemeMap = std::make_unique<SchemeMap>(*m_SchemeMap.load(std::memory_order_relaxed));
+		nBool succeed;
+		tie(std::ignore, succeed) = schemeMap->emplace(scheme->GetSchemeName(), std::move(scheme));
+		if (!succeed)
+		{
+			nat_Throw(natErrException, NatErr_Duplicated, "Register scheme failed: duplicated scheme name."_nv);
+		}
+
+		publishSchemeMap(std::move(schemeMap));
 	}
+
+	invalidateUriCache();
 }
 
 void natVFS::UnregisterScheme(nStrView name)
 {
-	m_SchemeMap.erase(name);
+	{
+		natRefScopeGuard<natCriticalSection> guard{ m_SchemeSection };
+
+		const auto current = m_SchemeMap.load(std::memory_order_relaxed);
+		if (current->find(name) == current->end())
+		{
+			return;
+		}
+
+		auto schemeMap = std::make_unique<SchemeMap>(*current);
+		schemeMap->erase(name);
+		publishSchemeMap(std::move(schemeMap));
+	}
+
+	invalidateUriCache();
 }
 
 natRefPointer<IScheme> natVFS::GetScheme(nStrView name)
 {
-	const auto iter = m_SchemeMap.find(name);
-	return iter != m_SchemeMap.end() ? iter->second : nullptr;
+	const auto schemeMap = m_SchemeMap.load(std::memory_order_acquire);
+	const auto iter = schemeMap->find(name);
+	return iter != schemeMap->end() ? iter->second : nullptr;
 }
 
 natRefPointer<IRequest> natVFS::CreateRequest(Uri const& uri)
@@ -386,5 +721,129 @@ natRefPointer<IRequest> natVFS::CreateRequest(Uri const& uri)
 
 natRefPointer<IRequest> natVFS::CreateRequest(nStrView const& uriString)
 {
-	return CreateRequest(Uri{ uriString });
+	std::shared_ptr<const CachedUri> cachedUri;
+	nBool cacheEnabled;
+	size_t generation;
+
+	{
+		natRefScopeGuard<natCriticalSection> guard{ m_CacheSection };
+		cacheEnabled = m_MaxCachedUris != 0;
+		if (cacheEnabled)
+		{
+			const auto iter = m_UriCache.find(uriString);
+			if (iter != m_UriCache.end())
+			{
+				cachedUri = iter->second;
+			}
+		}
+		generation = m_CacheGeneration;
+	}
+
+	if (!cacheEnabled)
+	{
+		return CreateRequest(Uri{ uriString });
+	}
+
+	if (!cachedUri)
+	{
+		// ʵʾڼ仺汻ջؽ򲻲
+		Uri uri{ uriString };
+		auto scheme = GetScheme(uri.GetScheme());
+		cachedUri = std::make_shared<const CachedUri>(CachedUri{ std::move(uri), std::move(scheme) });
+
+		natRefScopeGuard<natCriticalSection> guard{ m_CacheSection };
+		if (generation == m_CacheGeneration)
+		{
+			if (m_UriCache.size() >= m_MaxCachedUris)
+			{
+				m_UriCache.clear();
+			}
+			m_UriCache.emplace(cachedUri->ParsedUri.GetUnderlyingString(), cachedUri);
+		}
+	}
+
+	return cachedUri->Scheme ? cachedUri->Scheme->CreateRequest(cachedUri->ParsedUri) : nullptr;
+}
+
+void natVFS::EnableCache(size_t maxCachedUris, size_t maxOpenHandles)
+{
+	{
+		natRefScopeGuard<natCriticalSection> guard{ m_CacheSection };
+		m_MaxCachedUris = maxCachedUris;
+		m_UriCache.clear();
+		++m_CacheGeneration;
+	}
+
+	static_cast<natRefPointer<LocalFileScheme>>(m_LocalFileScheme)->SetHandleCache(maxOpenHandles ? make_ref<natFileHandleCache>(maxOpenHandles) : nullptr);
+}
+
+void natVFS::DisableCache()
+{
+	{
+		natRefScopeGuard<natCriticalSection> guard{ m_CacheSection };
+		m_MaxCachedUris = 0;
+		m_UriCache.clear();
+		++m_CacheGeneration;
+	}
+
+	static_cast<natRefPointer<LocalFileScheme>>(m_LocalFileScheme)->SetHandleCache(nullptr);
+}
+
+nBool natVFS::IsCacheEnabled() const
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_CacheSection };
+	return m_MaxCachedUris != 0;
+}
+
+nLen natVFS::WalkDirectory(Uri const& root, natThreadPool& threadPool, std::function<nBool(nStrView, DirectoryEntry const&)> callback, nBool withStat)
+{
+	if (!callback)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "callback should be a valid function."_nv);
+	}
+
+	auto scheme = GetScheme(root.GetScheme());
+	if (!scheme)
+	{
+		nat_Throw(natErrException, NatErr_NotFound, "Scheme \"{0}\" is not registered."_nv, root.GetScheme());
+	}
+
+	WalkState state{ std::move(scheme), root.GetUnderlyingString(), threadPool, callback, withStat };
+	state.PendingCount = 0;
+	state.EntryCount = 0;
+
+	QueueWalkJob(state, {});
+
+	// ʵʾȴύĹ뿪Ϊ߳state
+	std::unique_lock<std::mutex> lock{ state.Mutex };
+	state.Finished.wait(lock, [&state]
+	{
+		return !state.PendingCount;
+	});
+
+	if (state.FirstException)
+	{
+		std::rethrow_exception(state.FirstException);
+	}
+
+	return state.EntryCount;
+}
+
+natRefPointer<natFileHandleCache> natVFS::GetFileHandleCache() const
+{
+	return static_cast<natRefPointer<LocalFileScheme>>(m_LocalFileScheme)->GetHandleCache();
+}
+
+// ʵʾm_SchemeSectionʱ
+void natVFS::publishSchemeMap(std::unique_ptr<SchemeMap> schemeMap)
+{
+	m_SchemeMaps.emplace_back(std::move(schemeMap));
+	m_SchemeMap.store(m_SchemeMaps.back().get(), std::memory_order_release);
+}
+
+void natVFS::invalidateUriCache()
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_CacheSection };
+	m_UriCache.clear();
+	++m_CacheGeneration;
 }
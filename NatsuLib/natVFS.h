@@ -4,12 +4,62 @@
 #include "natMisc.h"
 #include "natRefObj.h"
 #include "natStream.h"
+#include "natMultiThread.h"
+#include "natFileHandleCache.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace NatsuLib
 {
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	ͨԴʶͼ
+	///	@note	ַ־ùʱַһαҲڴ
+	///			ʹ豣ַ֤ͼЧ
+	////////////////////////////////////////////////////////////////////////////////
+	class UriView final
+	{
+		friend class Uri;
+
+	public:
+		///	@brief	uri
+		///	@note	uriЧ׳쳣
+		explicit UriView(nStrView uri);
+
+		nStrView GetScheme() const noexcept;
+		nStrView GetUser() const noexcept;
+		nStrView GetPassword() const noexcept;
+		nStrView GetHost() const noexcept;
+		Optional<nuShort> GetPort() const noexcept;
+		nStrView GetPath() const noexcept;
+		nStrView GetQuery() const noexcept;
+		nStrView GetFragment() const noexcept;
+
+		nStrView GetUnderlyingString() const noexcept;
+
+	private:
+		nStrView m_UriString;
+
+		nStrView m_Scheme;
+		nStrView m_User;
+		nStrView m_Password;
+		nStrView m_Host;
+		Optional<nuShort> m_Port;
+		nStrView m_Path;
+		nStrView m_Query;
+		nStrView m_Fragment;
+
+		///	@brief	otherĸضλͬһַ
+		UriView(UriView const& other, nStrView uriString) noexcept;
+
+		void ParseUri();
+	};
+
 	////////////////////////////////////////////////////////////////////////////////
 	///	@brief	ͨԴʶ
+	///	@note	ַUriViewơƶUriViewʱַ½
 	////////////////////////////////////////////////////////////////////////////////
 	class Uri final
 	{
@@ -18,6 +68,7 @@ namespace NatsuLib
 		static const nStrView SchemeDelimiter;
 
 		explicit Uri(nString uri);
+		explicit Uri(UriView const& view);
 
 		Uri(Uri const& other);
 		Uri(Uri&& other) noexcept;
@@ -36,25 +87,49 @@ namespace NatsuLib
 
 		nStrView GetUnderlyingString() const noexcept;
 
+		///	@brief	ôuriͼ
+		///	@note	ͼڴuriδ޸ĻʱЧ
+		UriView const& GetView() const noexcept;
+
 	private:
-		// ΪʲôҪд
-		struct UriInfo
-		{
-			nString UriString;
-
-			nStrView Scheme;
-			nStrView User;
-			nStrView Password;
-			nStrView Host;
-			Optional<nuShort> Port;
-			nStrView Path;
-			nStrView Query;
-			nStrView Fragment;
-		};
+		nString m_UriString;
+		UriView m_View;
+	};
 
-		UriInfo m_UriInfo;
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	Դ
+	////////////////////////////////////////////////////////////////////////////////
+	enum class ResourceType
+	{
+		Unknown,
+		File,
+		Directory,
+		///	@brief	ͣӡ豸
+		Other,
+	};
 
-		void ParseUri();
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	Դ״̬
+	////////////////////////////////////////////////////////////////////////////////
+	struct ResourceStat
+	{
+		ResourceType Type;
+		///	@brief	ԴĴСĿ¼
+		nLen Size;
+		///	@brief	޸ʱ䣬޷ṩʱΪԪʱ
+		std::chrono::system_clock::time_point LastWriteTime;
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	Ŀ¼
+	////////////////////////////////////////////////////////////////////////////////
+	struct DirectoryEntry
+	{
+		///	@brief	ƣĿ¼·
+		nString Name;
+		///	@brief	״̬
+		///	@note	öʱδҪ״̬ʱTypeЧҿΪUnknown
+		ResourceStat Stat;
 	};
 
 	struct IResponse;
@@ -94,14 +169,69 @@ namespace NatsuLib
 		///	@note	õnStrViewSchemeЧַ
 		virtual nStrView GetSchemeName() const noexcept = 0;
 		virtual natRefPointer<IRequest> CreateRequest(Uri const& uri) = 0;
+
+		///	@brief	жuriʾԴǷ
+		///	@note	ĬʵֽԻûظӦṩ۵ʵ
+		virtual nBool Exists(Uri const& uri);
+
+		///	@brief	uriʾԴ״̬
+		///	@return	Դ״̬Դ򷵻ؿֵ
+		///	@note	ĬʵֽExistsжԴǷڣصΪUnknown
+		virtual Optional<ResourceStat> Stat(Uri const& uri);
+		///	@brief	öuriʾĿ¼е
+		///	@param[in]	withStat	Ƿͬʱø״̬
+		///	@note	"."".."˳δָĿ¼ڽ׳쳣
+		///			Ĭʵֽ׳NatErr_NotSupport쳣
+		virtual std::vector<DirectoryEntry> EnumerateDirectory(Uri const& uri, nBool withStat);
 	};
 
+	namespace detail_
+	{
+		////////////////////////////////////////////////////////////////////////////////
+		///	@brief	ɱƽ·гĿ¼е
+		///	@note	·ԴķʹãĿ¼Դ·'/'β·ΪʽĿ¼
+		////////////////////////////////////////////////////////////////////////////////
+		class FlatDirectoryLister final
+		{
+		public:
+			explicit FlatDirectoryLister(nStrView directory);
+
+			///	@brief	һԴ·
+			void Add(nStrView path, nLen size);
+			///	@brief	Ŀ¼ǷڣǷλĿ¼֮µ·
+			nBool IsFound() const noexcept;
+			std::vector<DirectoryEntry> GetEntries();
+
+		private:
+			nString m_Prefix;
+			nBool m_Found;
+			std::unordered_set<nString> m_Directories;
+			std::vector<DirectoryEntry> m_Entries;
+		};
+
+		///	@brief	ȥ·ĩβ'/'
+		nStrView TrimTrailingSlash(nStrView path) noexcept;
+
+		///	@brief	uriʾ·
+		///	@note	ʱΪ·ĵһ֣·λԴķ
+		nString GetFullPath(Uri const& uri);
+	}
+
 	////////////////////////////////////////////////////////////////////////////////
 	///	@brief	ļϵͳ
+	///	@note	зΪ̰߳ȫ
+	///			ҷʱԭӵؼصǰķһβңҪ
+	///			עἰעʱ滻Ӧڳʼʱע
+	///			滻ķõķnatVFSԱ֤ڲҵ߳ܰȫ
 	////////////////////////////////////////////////////////////////////////////////
 	class natVFS final
 	{
 	public:
+		enum : size_t
+		{
+			DefaultMaxCachedUris = 1024,
+		};
+
 		natVFS();
 		~natVFS();
 
@@ -112,7 +242,53 @@ namespace NatsuLib
 		natRefPointer<IRequest> CreateRequest(Uri const& uri);
 		natRefPointer<IRequest> CreateRequest(nStrView const& uriString);
 
+		///	@brief	û
+		///	@param[in]	maxCachedUris	ѽuriʱջ
+		///	@param[in]	maxOpenHandles	fileֻΪ0ʱ
+		///	@note	úַʱѽuriӦķעעʱջ
+		///			ĬעfileֻʽļʱľμnatFileHandleCache
+		///			ٴεýµĲؽ
+		void EnableCache(size_t maxCachedUris = DefaultMaxCachedUris, size_t maxOpenHandles = natFileHandleCache::DefaultMaxOpenHandles);
+		void DisableCache();
+		nBool IsCacheEnabled() const;
+
+		///	@brief	еصݹĿ¼
+		///	@param[in]	root		ҪĿ¼ӦѯƬ
+		///	@param[in]	threadPool	öٸĿ¼̳߳
+		///	@param[in]	callback	ÿһãΪroot·falseʱΪĿ¼򲻽
+		///	@param[in]	withStat	Ƿø״̬
+		///	@note	ÿĿ¼ΪĹύthreadPoolcallbackڹ߳бͬʱãб֤̰߳ȫ
+		///			ָĿ¼һĿ¼öʧʱй׳׸쳣
+		///			ֱɣ˲threadPoolĹ߳е
+		///	@return	
+		nLen WalkDirectory(Uri const& root, natThreadPool& threadPool, std::function<nBool(nStrView, DirectoryEntry const&)> callback, nBool withStat = false);
+
+		///	@brief	fileʹõľ
+		///	@note	δþ򷵻nullptr
+		natRefPointer<natFileHandleCache> GetFileHandleCache() const;
+
 	private:
-		std::unordered_map<nStrView, natRefPointer<IScheme>> m_SchemeMap;
+		struct CachedUri
+		{
+			Uri ParsedUri;
+			natRefPointer<IScheme> Scheme;
+		};
+
+		typedef std::unordered_map<nStrView, natRefPointer<IScheme>> SchemeMap;
+
+		// ʵʾm_SchemeMapָm_SchemeMapsһһ㲻޸
+		std::atomic<const SchemeMap*> m_SchemeMap;
+		natCriticalSection m_SchemeSection;
+		std::vector<std::unique_ptr<const SchemeMap>> m_SchemeMaps;
+		natRefPointer<IScheme> m_LocalFileScheme;
+
+		// ʵʾֵеuriֵַͬʱƳ
+		mutable natCriticalSection m_CacheSection;
+		size_t m_MaxCachedUris;
+		size_t m_CacheGeneration;
+		std::unordered_map<nStrView, std::shared_ptr<const CachedUri>> m_UriCache;
+
+		void publishSchemeMap(std::unique_ptr<SchemeMap> schemeMap);
+		void invalidateUriCache();
 	};
 }
@@ -0,0 +1,258 @@
+#include "stdafx.h"
+#include "natZipArchiveScheme.h"
+#include "natException.h"
+
+using namespace NatsuLib;
+
+struct ZipArchiveScheme::ArchiveInfo
+{
+	natRefPointer<natZipArchive> Archive;
+	nBool IsMounted;
+};
+
+const nStrView ZipArchiveScheme::EntryDelimiter{ "!/" };
+
+namespace
+{
+	void ParseZipUri(Uri const& uri, nString& archivePath, nString& entryPath)
+	{
+		// fileͬʱΪ·ĵһ
+		const auto fullPath = detail_::GetFullPath(uri);
+		const nStrView path = fullPath;
+		const auto delimiterPos = path.Find(ZipArchiveScheme::EntryDelimiter);
+		if (delimiterPos == nStrView::npos)
+		{
+			nat_Throw(natErrException, NatErr_InvalidArg, "{0} is not a valid zip uri: missing \"{1}\"."_nv, uri.GetUnderlyingString(), ZipArchiveScheme::EntryDelimiter);
+		}
+
+		archivePath = nStrView{ path.begin(), path.begin() + delimiterPos };
+
+		auto entryBegin = path.begin() + delimiterPos + ZipArchiveScheme::EntryDelimiter.GetSize();
+		while (entryBegin != path.end() && *entryBegin == '/')
+		{
+			++entryBegin;
+		}
+		entryPath = nStrView{ entryBegin, path.end() };
+	}
+}
+
+ZipArchiveScheme::ZipArchiveScheme(size_t entryCacheCapacity)
+	: m_EntryCacheCapacity{ entryCacheCapacity }
+{
+}
+
+ZipArchiveScheme::~ZipArchiveScheme()
+{
+}
+
+nStrView ZipArchiveScheme::GetSchemeName() const noexcept
+{
+	return "zip";
+}
+
+natRefPointer<IRequest> ZipArchiveScheme::CreateRequest(Uri const& uri)
+{
+	return make_ref<ZipArchiveRequest>(natRefPointer<ZipArchiveScheme>{ this }, uri);
+}
+
+nBool ZipArchiveScheme::Exists(Uri const& uri)
+{
+	try
+	{
+		nString archivePath, entryPath;
+		ParseZipUri(uri, archivePath, entryPath);
+		return GetEntry(archivePath, entryPath);
+	}
+	catch (natException&)
+	{
+		return false;
+	}
+}
+
+Optional<ResourceStat> ZipArchiveScheme::Stat(Uri const& uri)
+{
+	nString archivePath, entryPath;
+	ParseZipUri(uri, archivePath, entryPath);
+	const auto info = getArchiveInfo(archivePath);
+	const auto path = detail_::TrimTrailingSlash(entryPath);
+	if (path.empty())
+	{
+		return ResourceStat{ ResourceType::Directory, 0, {} };
+	}
+
+	const auto entry = info->Archive->GetEntry(entryPath);
+	if (entry)
+	{
+		const auto isDirectory = entry->GetName().GetSize() > path.GetSize();
+		return ResourceStat{ isDirectory ? ResourceType::Directory : ResourceType::File, isDirectory ? 0 : entry->GetLength(), {} };
+	}
+
+	// ʵʾʽĿ¼ڼֻĿ¼ƻӳټ
+	if (info->Archive->HasDirectory(path))
+	{
+		return ResourceStat{ ResourceType::Directory, 0, {} };
+	}
+
+	return {};
+}
+
+std::vector<DirectoryEntry> ZipArchiveScheme::EnumerateDirectory(Uri const& uri, nBool /*withStat*/)
+{
+	nString archivePath, entryPath;
+	ParseZipUri(uri, archivePath, entryPath);
+	const auto info = getArchiveInfo(archivePath);
+	const auto path = detail_::TrimTrailingSlash(entryPath);
+	// ʵʾжĿ¼ǷڣΪڵĿ¼
+	if (!path.empty() && !info->Archive->HasDirectory(path))
+	{
+		nat_Throw(natErrException, NatErr_NotFound, "Directory \"{0}\" is not found in archive \"{1}\"."_nv, entryPath, archivePath);
+	}
+
+	detail_::FlatDirectoryLister lister{ entryPath };
+	for (const auto& entry : info->Archive->GetEntries())
+	{
+		lister.Add(entry->GetName(), entry->GetLength());
+	}
+
+	if (!lister.IsFound())
+	{
+		nat_Throw(natErrException, NatErr_NotFound, "Directory \"{0}\" is not found in archive \"{1}\"."_nv, entryPath, archivePath);
+	}
+
+	return lister.GetEntries();
+}
+
+void ZipArchiveScheme::MountArchive(nStrView archivePath, natRefPointer<natZipArchive> archive)
+{
+	if (!archive)
+	{
+		nat_Throw(natErrException, NatErr_InvalidArg, "archive should be a valid pointer."_nv);
+	}
+
+	auto info = std::make_shared<ArchiveInfo>();
+	info->Archive = std::move(archive);
+	info->IsMounted = true;
+
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	nBool succeed;
+	tie(std::ignore, succeed) = m_ArchiveMap.emplace(archivePath, std::move(info));
+	if (!succeed)
+	{
+		nat_Throw(natErrException, NatErr_Duplicated, "Mount archive failed: \"{0}\" has already been mounted or opened."_nv, archivePath);
+	}
+}
+
+void ZipArchiveScheme::UnmountArchive(nStrView archivePath)
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	m_ArchiveMap.erase(archivePath);
+}
+
+natRefPointer<natZipArchive> ZipArchiveScheme::GetArchive(nStrView archivePath)
+{
+	return getArchiveInfo(archivePath)->Archive;
+}
+
+natRefPointer<natZipArchive::ZipEntry> ZipArchiveScheme::GetEntry(nStrView archivePath, nStrView entryPath)
+{
+	return getArchiveInfo(archivePath)->Archive->GetEntry(entryPath);
+}
+
+size_t ZipArchiveScheme::GetArchiveCount() const
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	return m_ArchiveMap.size();
+}
+
+void ZipArchiveScheme::ClearArchiveCache()
+{
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	for (auto iter = m_ArchiveMap.begin(); iter != m_ArchiveMap.end();)
+	{
+		if (iter->second->IsMounted)
+		{
+			++iter;
+		}
+		else
+		{
+			iter = m_ArchiveMap.erase(iter);
+		}
+	}
+}
+
+std::shared_ptr<ZipArchiveScheme::ArchiveInfo> ZipArchiveScheme::getArchiveInfo(nStrView archivePath)
+{
+	{
+		natRefScopeGuard<natCriticalSection> guard{ m_Section };
+		const auto iter = m_ArchiveMap.find(archivePath);
+		if (iter != m_ArchiveMap.end())
+		{
+			return iter->second;
+		}
+	}
+
+	// ʵʾٽȡĿ¼ͬʱͬһĵʱɵĽ
+	auto info = std::make_shared<ArchiveInfo>();
+#ifdef _WIN32
+	constexpr auto encoding = StringType::Ansi;
+#else
+	constexpr auto encoding = StringType::Utf8;
+#endif
+	info->Archive = make_ref<natZipArchive>(make_ref<natFileStream>(archivePath, true, false), encoding, natZipArchive::ZipArchiveMode::Read, true);
+	info->IsMounted = false;
+	if (m_EntryCacheCapacity)
+	{
+		info->Archive->SetEntryCacheCapacity(m_EntryCacheCapacity);
+	}
+
+	natRefScopeGuard<natCriticalSection> guard{ m_Section };
+	return m_ArchiveMap.emplace(archivePath, std::move(info)).first->second;
+}
+
+ZipArchiveRequest::ZipArchiveRequest(natRefPointer<ZipArchiveScheme> scheme, Uri const& uri)
+	: m_Scheme{ std::move(scheme) }, m_Uri{ uri }
+{
+	ParseZipUri(m_Uri, m_ArchivePath, m_EntryPath);
+}
+
+natRefPointer<IResponse> ZipArchiveRequest::GetResponse()
+{
+	const auto info = m_Scheme->getArchiveInfo(m_ArchivePath);
+	auto entry = info->Archive->GetEntry(m_EntryPath);
+	if (!entry)
+	{
+		nat_Throw(natErrException, NatErr_NotFound, "Entry \"{0}\" is not found in archive \"{1}\"."_nv, m_EntryPath, m_ArchivePath);
+	}
+
+	return make_ref<ZipArchiveResponse>(info->Archive, std::move(entry));
+}
+
+nStrView ZipArchiveRequest::GetArchivePath() const noexcept
+{
+	return m_ArchivePath;
+}
+
+nStrView ZipArchiveRequest::GetEntryPath() const noexcept
+{
+	return m_EntryPath;
+}
+
+ZipArchiveResponse::ZipArchiveResponse(natRefPointer<natZipArchive> archive, natRefPointer<natZipArchive::ZipEntry> entry)
+	: m_Archive{ std::move(archive) }, m_Entry{ std::move(entry) }, m_Stream{ m_Entry->Open() }
+{
+}
+
+natRefPointer<natStream> ZipArchiveResponse::GetResponseStream()
+{
+	return m_Stream;
+}
+
+natRefPointer<natZipArchive> ZipArchiveResponse::GetArchive() const noexcept
+{
+	return m_Archive;
+}
+
+natRefPointer<natZipArchive::ZipEntry> ZipArchiveResponse::GetEntry() const noexcept
+{
+	return m_Entry;
+}
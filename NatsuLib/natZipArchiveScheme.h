@@ -0,0 +1,102 @@
+#pragma once
+#include "natVFS.h"
+#include "natCompression.h"
+#include "natMultiThread.h"
+
+namespace NatsuLib
+{
+	////////////////////////////////////////////////////////////////////////////////
+	///	@brief	Zipĵ
+	///	@note	zip://ĵ·!/·ʽZipĵеڣĵ·Ľͷʽfileͬ
+	///			򿪵ĵĵ·Ϊ棬֮󽫸ѶȡĿ¼ĵӳټڵķʽ
+	///			ҲͨMountArchiveѴ򿪵ĵصָ·ϣзΪ̰߳ȫ
+	////////////////////////////////////////////////////////////////////////////////
+	class ZipArchiveScheme final
+		: public natRefObjImpl<IScheme>
+	{
+		friend class ZipArchiveRequest;
+
+	public:
+		static const nStrView EntryDelimiter;
+
+		///	@brief	췽
+		///	@param[in]	entryCacheCapacity	ɴ˷򿪵ĵĽѹݻΪ0ʱû
+		explicit ZipArchiveScheme(size_t entryCacheCapacity = 0);
+		~ZipArchiveScheme();
+
+		nStrView GetSchemeName() const noexcept override;
+		natRefPointer<IRequest> CreateRequest(Uri const& uri) override;
+		nBool Exists(Uri const& uri) override;
+		///	@brief	ڻĿ¼״̬
+		///	@note	Ŀ¼ʽĿ¼ڣҲڵ·ṩ޸ʱ
+		Optional<ResourceStat> Stat(Uri const& uri) override;
+		///	@brief	öĵеĿ¼
+		///	@note	Ŀ¼егȡκڵݣzip://ĵ·!/ʽöĵĸĿ¼
+		std::vector<DirectoryEntry> EnumerateDirectory(Uri const& uri, nBool withStat) override;
+
+		///	@brief	Ѵ򿪵ĵصָ·
+		///	@note	ĵӦԶȡģʽ򿪣·ĵ׳쳣
+		void MountArchive(nStrView archivePath, natRefPointer<natZipArchive> archive);
+		///	@brief	ж·ϵĵصļĵ
+		///	@note	ѷصĻظԳĵͷǰĵᱻر
+		void UnmountArchive(nStrView archivePath);
+
+		///	@brief	·ϵĵδ򿪲
+		natRefPointer<natZipArchive> GetArchive(nStrView archivePath);
+		///	@brief	·ϵĵв
+		///	@return	ҵڣδҵ򷵻nullptr
+		natRefPointer<natZipArchive::ZipEntry> GetEntry(nStrView archivePath, nStrView entryPath);
+
+		///	@brief	ѻ漰صĵ
+		size_t GetArchiveCount() const;
+		///	@brief	ͷɴ˷򿪵ĵصĵӰ
+		void ClearArchiveCache();
+
+	private:
+		struct ArchiveInfo;
+
+		const size_t m_EntryCacheCapacity;
+		mutable natCriticalSection m_Section;
+		std::unordered_map<nString, std::shared_ptr<ArchiveInfo>> m_ArchiveMap;
+
+		std::shared_ptr<ArchiveInfo> getArchiveInfo(nStrView archivePath);
+	};
+
+	class ZipArchiveRequest final
+		: public natRefObjImpl<IRequest>
+	{
+	public:
+		ZipArchiveRequest(natRefPointer<ZipArchiveScheme> scheme, Uri const& uri);
+
+		natRefPointer<IResponse> GetResponse() override;
+
+		///	@brief	Zipĵ·
+		nStrView GetArchivePath() const noexcept;
+		///	@brief	ĵе·
+		nStrView GetEntryPath() const noexcept;
+
+	private:
+		natRefPointer<ZipArchiveScheme> m_Scheme;
+		Uri m_Uri;
+		nString m_ArchivePath;
+		nString m_EntryPath;
+	};
+
+	class ZipArchiveResponse final
+		: public natRefObjImpl<IResponse>
+	{
+	public:
+		ZipArchiveResponse(natRefPointer<natZipArchive> archive, natRefPointer<natZipArchive::ZipEntry> entry);
+
+		natRefPointer<natStream> GetResponseStream() override;
+
+		natRefPointer<natZipArchive> GetArchive() const noexcept;
+		natRefPointer<natZipArchive::ZipEntry> GetEntry() const noexcept;
+
+	private:
+		// ʵʾڽĵָ룬Ҫͬʱĵ
+		natRefPointer<natZipArchive> m_Archive;
+		natRefPointer<natZipArchive::ZipEntry> m_Entry;
+		natRefPointer<natStream> m_Stream;
+	};
+}